@@ -0,0 +1,461 @@
+/*
+**  delaunay_bench.c : time the 2D delaunay builds on standard point sets.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+* every (distribution, size) run happens in its own process, so its peak RSS
+* is its own. The runs are written to stdout as a JSON array
+*
+* usage: delaunay_bench [-n max points] [-m min points] [-t threads]
+*	[-p predicates] [-o ordering] [-d distribution]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "../delaunay.h"
+
+#define BENCH_PI		3.14159265358979323846
+
+/* a run repeats the builds until it has this many points, or this many seconds */
+#define BENCH_MIN_POINTS	2000000
+#define BENCH_MIN_SECONDS	0.25
+
+typedef struct {
+	const char*		name;
+	unsigned int		(*generate)(del_point2d_t *points, unsigned int num_points);
+} bench_distribution_t;
+
+/*
+* allocations of the process, counted on top of the glibc allocator
+*/
+static unsigned long	bench_num_allocs	= 0;
+static unsigned long	bench_alloc_bytes	= 0;
+
+#ifdef __GLIBC__
+extern void*	__libc_malloc(size_t size);
+extern void*	__libc_calloc(size_t count, size_t size);
+extern void*	__libc_realloc(void *ptr, size_t size);
+extern void	__libc_free(void *ptr);
+
+void* malloc(size_t size) {
+	bench_num_allocs++;
+	bench_alloc_bytes	+= size;
+	return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+	bench_num_allocs++;
+	bench_alloc_bytes	+= count * size;
+	return __libc_calloc(count, size);
+}
+
+void* realloc(void *ptr, size_t size) {
+	bench_num_allocs++;
+	bench_alloc_bytes	+= size;
+	return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+	__libc_free(ptr);
+}
+#endif
+
+/*
+* xorshift, so every run sees the same points
+*/
+static unsigned long long	bench_seed	= 88172645463325252ull;
+
+static double bench_random(void)
+{
+	bench_seed	^= bench_seed << 13;
+	bench_seed	^= bench_seed >> 7;
+	bench_seed	^= bench_seed << 17;
+
+	return (double)(bench_seed >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double bench_gaussian(void)
+{
+	double		u	= bench_random();
+	double		v	= bench_random();
+
+	return sqrt(-2.0 * log(u + 1e-300)) * cos(2.0 * BENCH_PI * v);
+}
+
+static double bench_clock(void)
+{
+	struct timespec		ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+* the distributions of the Qt example, scaled to any point count
+*/
+static unsigned int bench_uniform( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	i;
+
+	for( i = 0; i < num_points; i++ )
+	{
+		points[i].x	= bench_random() * 1000.0;
+		points[i].y	= bench_random() * 1000.0;
+	}
+
+	return num_points;
+}
+
+static unsigned int bench_grid( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	side	= (unsigned int)sqrt((double)num_points);
+	unsigned int	i;
+
+	for( i = 0; i < side * side; i++ )
+	{
+		points[i].x	= (i % side) * 20 + 5;
+		points[i].y	= (i / side) * 20 + 5;
+	}
+
+	return side * side;
+}
+
+static unsigned int bench_circles( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	per_circle	= 13;		/* 2 pi / 0.5 */
+	unsigned int	side		= (unsigned int)sqrt((double)(num_points / per_circle));
+	unsigned int	x, y, j, k	= 0;
+	double		radius;
+
+	for( y = 0; y < side; y++ )
+	{
+		for( x = 0; x < side; x++ )
+		{
+			radius	= 10 + bench_random() * 63;
+			for( j = 0; j < per_circle; j++ )
+			{
+				points[k].x	= 100 + x * 150 + cos(j * 0.5) * radius;
+				points[k].y	= 100 + y * 150 + sin(j * 0.5) * radius;
+				k++;
+			}
+		}
+	}
+
+	return k;
+}
+
+static unsigned int bench_vertical( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	i;
+
+	for( i = 0; i < num_points; i++ )
+	{
+		points[i].x	= 232 * 2;
+		points[i].y	= 100 + i * 32.0;
+	}
+
+	return num_points;
+}
+
+static unsigned int bench_horizontal( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	i;
+
+	for( i = 0; i < num_points; i++ )
+	{
+		points[i].x	= 116 + i * 32.0;
+		points[i].y	= 100;
+	}
+
+	return num_points;
+}
+
+static unsigned int bench_vertical_horizontal( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	half	= num_points / 2;
+	unsigned int	i;
+
+	for( i = 0; i < half; i++ )
+	{
+		points[i].x		= 100;
+		points[i].y		= 100 + i * 32.0;
+		points[half + i].x	= 132 + i * 32.0;
+		points[half + i].y	= 100 + 8 * 32;
+	}
+
+	return 2 * half;
+}
+
+static unsigned int bench_gaussian_points( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	i;
+
+	for( i = 0; i < num_points; i++ )
+	{
+		points[i].x	= 500.0 + bench_gaussian() * 100.0;
+		points[i].y	= 500.0 + bench_gaussian() * 100.0;
+	}
+
+	return num_points;
+}
+
+static unsigned int bench_clustered( del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	num_clusters	= 1 + num_points / 1000;
+	unsigned int	i, c;
+	double		cx, cy;
+
+	for( i = 0; i < num_points; i++ )
+	{
+		/* the clusters are drawn from the same sequence, so they are stable */
+		c	= (unsigned int)(bench_random() * num_clusters);
+		cx	= 1000.0 * ((c * 0.6180339887498949) - floor(c * 0.6180339887498949));
+		cy	= 1000.0 * ((c * 0.7548776662466927) - floor(c * 0.7548776662466927));
+
+		points[i].x	= cx + bench_gaussian() * 2.0;
+		points[i].y	= cy + bench_gaussian() * 2.0;
+	}
+
+	return num_points;
+}
+
+static const bench_distribution_t	bench_distributions[]	= {
+	{ "uniform",			bench_uniform },
+	{ "grid",			bench_grid },
+	{ "circles",			bench_circles },
+	{ "vertical",			bench_vertical },
+	{ "horizontal",			bench_horizontal },
+	{ "vertical_horizontal",	bench_vertical_horizontal },
+	{ "gaussian",			bench_gaussian_points },
+	{ "clustered",			bench_clustered },
+};
+
+#define BENCH_NUM_DISTRIBUTIONS	(sizeof(bench_distributions) / sizeof(bench_distributions[0]))
+
+/*
+* snap the points to an integer grid of 2^28 steps over their extent, the
+* range of the integer predicates
+*/
+static void bench_quantize( del_point2d_t *points, unsigned int num_points )
+{
+	double		min_x, min_y, extent, scale;
+	unsigned int	i;
+
+	if( num_points == 0 )
+		return;
+
+	min_x	= points[0].x;
+	min_y	= points[0].y;
+	extent	= 0.0;
+	for( i = 1; i < num_points; i++ )
+	{
+		min_x	= (points[i].x < min_x) ? points[i].x : min_x;
+		min_y	= (points[i].y < min_y) ? points[i].y : min_y;
+	}
+
+	for( i = 0; i < num_points; i++ )
+	{
+		extent	= (points[i].x - min_x > extent) ? points[i].x - min_x : extent;
+		extent	= (points[i].y - min_y > extent) ? points[i].y - min_y : extent;
+	}
+
+	scale	= (extent > 0.0) ? (double)(1 << 28) / extent : 1.0;
+	for( i = 0; i < num_points; i++ )
+	{
+		points[i].x	= floor((points[i].x - min_x) * scale + 0.5);
+		points[i].y	= floor((points[i].y - min_y) * scale + 0.5);
+	}
+}
+
+/*
+* total area of the triangles, the work of a consumer streaming over them
+*/
+static double bench_area( const tri_delaunay2d_t *tdel )
+{
+	const unsigned int	*t	= tdel->tris;
+	const del_point2d_t	*p	= tdel->points;
+	double			area	= 0.0;
+	unsigned int		i;
+
+	for( i = 0; i < tdel->num_triangles; i++, t += 3 )
+		area	+= (p[t[1]].x - p[t[0]].x) * (p[t[2]].y - p[t[0]].y) - (p[t[1]].y - p[t[0]].y) * (p[t[2]].x - p[t[0]].x);
+
+	return area * 0.5;
+}
+
+/*
+* time the phases of a distribution at a given size, and print its JSON record
+*/
+static void bench_run( const bench_distribution_t *dist, unsigned int size )
+{
+	del_point2d_t*		points;
+	delaunay2d_context_t*	ctx;
+	delaunay2d_t*		del;
+	tri_delaunay2d_t*	tdel;
+	del_stats_t		stats;
+	struct rusage		usage;
+	double			copy = 0, sort = 0, dc = 0, faces = 0, tri = 0, stream = 0, total = 0, start;
+	double			area = 0;
+	unsigned long		num_allocs, alloc_bytes, warm_allocs;
+	unsigned int		num_points, num_runs, num_faces = 0, num_triangles = 0;
+
+	points	= (del_point2d_t*)malloc(sizeof(del_point2d_t) * size);
+	if( points == NULL ) {
+		fprintf(stderr, "not enough memory for %u points\n", size);
+		exit(1);
+	}
+
+	num_points	= dist->generate(points, size);
+	if( delaunay2d_predicates() == DEL_PREDICATES_INTEGER )
+		bench_quantize(points, num_points);
+
+	/* allocations of a build with the one shot API */
+	num_allocs	= bench_num_allocs;
+	alloc_bytes	= bench_alloc_bytes;
+
+	del	= delaunay2d_from(points, num_points);
+	tdel	= tri_delaunay2d_from(del);
+
+	num_allocs	= bench_num_allocs - num_allocs;
+	alloc_bytes	= bench_alloc_bytes - alloc_bytes;
+
+	tri_delaunay2d_release(tdel);
+	delaunay2d_release(del);
+
+	/* phases, with a warm context */
+	ctx	= delaunay2d_context_create();
+	tri_delaunay2d_context_from(ctx, delaunay2d_context_from(ctx, points, num_points));
+
+	warm_allocs	= bench_num_allocs;
+	num_runs	= 0;
+	start		= bench_clock();
+
+	do {
+		double		t0;
+
+		del	= delaunay2d_context_from(ctx, points, num_points);
+		delaunay2d_context_stats(ctx, &stats);
+
+		t0	= bench_clock();
+		tdel	= tri_delaunay2d_context_from(ctx, del);
+		tri	+= bench_clock() - t0;
+
+		/* a consumer streaming over the triangles and their points */
+		t0	= bench_clock();
+		area	+= bench_area(tdel);
+		stream	+= bench_clock() - t0;
+
+		copy	+= stats.copy;
+		sort	+= stats.sort;
+		dc	+= stats.divide_and_conquer;
+		faces	+= stats.faces;
+
+		num_faces	= del->num_faces;
+		num_triangles	= tdel->num_triangles;
+		num_runs++;
+
+		total	= bench_clock() - start;
+	} while( (double)num_runs * num_points < BENCH_MIN_POINTS || total < BENCH_MIN_SECONDS );
+
+	warm_allocs	= (bench_num_allocs - warm_allocs) / num_runs;
+
+	delaunay2d_context_release(ctx);
+	free(points);
+
+	getrusage(RUSAGE_SELF, &usage);
+
+#define BENCH_NS_PER_POINT(t)	((t) * 1e9 / ((double)num_runs * num_points))
+
+	printf("  {\"distribution\": \"%s\", \"points\": %u, \"threads\": %u, \"predicates\": %u, \"ordering\": %u, \"runs\": %u, "
+	       "\"faces\": %u, \"triangles\": %u, \"area\": %g, "
+	       "\"ns_per_point\": {\"copy\": %.3f, \"sort\": %.3f, \"divide_and_conquer\": %.3f, \"faces\": %.3f, \"tri\": %.3f, \"stream\": %.3f, \"total\": %.3f}, "
+	       "\"allocations\": %lu, \"allocated_bytes\": %lu, \"warm_allocations\": %lu, \"peak_rss_kb\": %ld}",
+	       dist->name, num_points, delaunay2d_num_threads(), (unsigned int)delaunay2d_predicates(), (unsigned int)delaunay2d_ordering(), num_runs,
+	       num_faces, num_triangles, area / num_runs,
+	       BENCH_NS_PER_POINT(copy), BENCH_NS_PER_POINT(sort), BENCH_NS_PER_POINT(dc), BENCH_NS_PER_POINT(faces), BENCH_NS_PER_POINT(tri), BENCH_NS_PER_POINT(stream),
+	       BENCH_NS_PER_POINT(copy + sort + dc + faces + tri),
+	       num_allocs, alloc_bytes, warm_allocs, usage.ru_maxrss);
+
+#undef BENCH_NS_PER_POINT
+
+	fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int	min_points	= 1000;
+	unsigned int	max_points	= 1000000;
+	const char*	only		= NULL;
+	unsigned int	d, size, first	= 1;
+	int		opt, status;
+	pid_t		pid;
+
+	while( (opt = getopt(argc, argv, "n:m:t:p:o:d:")) != -1 )
+	{
+		switch( opt ) {
+		case 'n':	max_points	= (unsigned int)atof(optarg);				break;
+		case 'm':	min_points	= (unsigned int)atof(optarg);				break;
+		case 't':	delaunay2d_set_num_threads((unsigned int)atoi(optarg));			break;
+		case 'p':	delaunay2d_set_predicates((del_predicates_t)atoi(optarg));		break;
+		case 'o':	delaunay2d_set_ordering((del_ordering_t)atoi(optarg));			break;
+		case 'd':	only		= optarg;						break;
+		default:
+			fprintf(stderr, "usage: %s [-n max points] [-m min points] [-t threads] [-p predicates] [-o ordering] [-d distribution]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	printf("[\n");
+
+	for( d = 0; d < BENCH_NUM_DISTRIBUTIONS; d++ )
+	{
+		if( only != NULL && strcmp(only, bench_distributions[d].name) != 0 )
+			continue;
+
+		for( size = min_points; size <= max_points; size = (size > 0xFFFFFFFFu / 10) ? max_points + 1 : size * 10 )
+		{
+			if( !first )
+				printf(",\n");
+			first	= 0;
+			fflush(stdout);
+
+			pid	= fork();
+			if( pid == 0 ) {
+				bench_run(&bench_distributions[d], size);
+				_exit(0);
+			}
+
+			if( pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) {
+				fprintf(stderr, "%s: %u points failed\n", bench_distributions[d].name, size);
+				printf("  {\"distribution\": \"%s\", \"points\": %u, \"failed\": true}", bench_distributions[d].name, size);
+			}
+		}
+	}
+
+	printf("\n]\n");
+
+	return 0;
+}
@@ -0,0 +1,550 @@
+/*
+**  delaunay_cli.c : triangulate a point file from the command line.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+* the input is read as csv (x,y per line), whitespace separated text (x y per
+* line), raw binary (x, y doubles in the host order) or a .del point file. The
+* format follows the extension unless -i gives it. The faces, triangles or
+* edges go to the output path (stdout without one, or with -) as text, one per
+* line, with the input point indices. Triangles written to a .del path are a
+* triangulation file. The phase timings go to stderr
+*
+* usage: delaunay_cli [-i csv|text|bin|del] [-w faces|triangles|edges|none]
+*	[-t threads] [-p predicates] [-o ordering] input [output]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../delaunay.h"
+
+/* size of the output buffer */
+#define CLI_BUFFER_SIZE		(1 << 16)
+
+/* significant digits a parsed number keeps, as many as an unsigned long long holds */
+#define CLI_MAX_DIGITS		19
+
+typedef enum {
+	CLI_INPUT_NONE,
+	CLI_INPUT_CSV,
+	CLI_INPUT_TEXT,
+	CLI_INPUT_BIN,
+	CLI_INPUT_DEL
+} cli_input_t;
+
+typedef enum {
+	CLI_WRITE_FACES,
+	CLI_WRITE_TRIANGLES,
+	CLI_WRITE_EDGES,
+	CLI_WRITE_NONE
+} cli_write_t;
+
+typedef struct {
+	FILE*		file;
+	size_t		size;
+	char		buffer[CLI_BUFFER_SIZE];
+} cli_writer_t;
+
+/* the powers of ten a double, and an 80 bits long double, hold exactly */
+static const double	cli_pow10[]	= {
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const long double	cli_pow10l[]	= {
+	1e0L,  1e1L,  1e2L,  1e3L,  1e4L,  1e5L,  1e6L,  1e7L,  1e8L,  1e9L,  1e10L, 1e11L, 1e12L, 1e13L,
+	1e14L, 1e15L, 1e16L, 1e17L, 1e18L, 1e19L, 1e20L, 1e21L, 1e22L, 1e23L, 1e24L, 1e25L, 1e26L, 1e27L
+};
+
+static double cli_clock(void)
+{
+	struct timespec		ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+* parse a decimal number, with the '.' decimal point whatever the locale
+* (strtod and fscanf read the point of the locale, and are several times
+* slower). The first CLI_MAX_DIGITS significant digits are kept: the value is
+* correctly rounded when they fit a double mantissa and the power of ten is
+* exact, the others are computed in long double and rounded once more
+*
+* @return: the end of the number, NULL when there is no number at s
+*/
+static const char* cli_parse_real( const char *s, double *value )
+{
+	unsigned long long	mantissa	= 0;
+	int			exponent	= 0, digits = 0, any = 0, negative = 0;
+	int			e		= 0, e_negative = 0;
+	double			v;
+
+	if( *s == '-' || *s == '+' )
+		negative	= (*s++ == '-');
+
+	for( ; *s >= '0' && *s <= '9'; s++, any = 1 )
+	{
+		if( digits < CLI_MAX_DIGITS ) {
+			mantissa	= mantissa * 10 + (unsigned int)(*s - '0');
+			digits		+= (mantissa != 0);
+		} else
+			exponent++;
+	}
+
+	if( *s == '.' ) {
+		for( s++; *s >= '0' && *s <= '9'; s++, any = 1 )
+		{
+			if( digits < CLI_MAX_DIGITS ) {
+				mantissa	= mantissa * 10 + (unsigned int)(*s - '0');
+				digits		+= (mantissa != 0);
+				exponent--;
+			}
+		}
+	}
+
+	if( !any )
+		return NULL;
+
+	if( (*s == 'e' || *s == 'E') &&
+	    ((s[1] >= '0' && s[1] <= '9') || ((s[1] == '-' || s[1] == '+') && s[2] >= '0' && s[2] <= '9')) ) {
+		s++;
+		if( *s == '-' || *s == '+' )
+			e_negative	= (*s++ == '-');
+
+		for( ; *s >= '0' && *s <= '9'; s++ )
+			e	= (e < 10000) ? e * 10 + (*s - '0') : e;
+
+		exponent	+= e_negative ? -e : e;
+	}
+
+	if( mantissa < (1ull << 53) && exponent >= -22 && exponent <= 22 )
+		/* exact operands, a single rounding */
+		v	= (exponent < 0) ? (double)mantissa / cli_pow10[-exponent] : (double)mantissa * cli_pow10[exponent];
+	else {
+		/* the 19 digits and the powers up to 10^27 are exact in 80 bits */
+		long double	lv	= (long double)mantissa;
+
+		for( ; mantissa != 0 && exponent > 27; exponent -= 27 )
+			lv	*= 1e27L;
+		for( ; mantissa != 0 && exponent < -27; exponent += 27 )
+			lv	/= 1e27L;
+
+		v	= (double)((exponent < 0) ? lv / cli_pow10l[-exponent] : lv * cli_pow10l[exponent]);
+	}
+
+	*value	= negative ? -v : v;
+	return s;
+}
+
+/*
+* parse the x, y lines of a text file. The fields are separated by a comma
+* (csv) or by blanks (text), the columns after y are ignored. Blank lines and
+* lines starting with # are skipped, so is a first line that isn't a point (a
+* header)
+*
+* @return: the point count, (unsigned int)-1 when a line isn't a point
+*/
+static unsigned int cli_parse_points( const char *text, const char *end, int csv, del_point2d_t *points )
+{
+	const char*	s		= text;
+	unsigned int	num_points	= 0, line = 1;
+	const char*	next;
+
+	for( ; s < end; s++, line++ )
+	{
+		while( *s == ' ' || *s == '\t' || *s == '\r' )
+			s++;
+
+		if( *s == '\n' || *s == '#' || s == end )
+			goto skip_line;
+
+		next	= cli_parse_real(s, &points[num_points].x);
+		if( next != NULL ) {
+			s	= next;
+			while( *s == ' ' || *s == '\t' )
+				s++;
+
+			if( csv && *s == ',' ) {
+				for( s++; *s == ' ' || *s == '\t'; s++ )
+					;
+			} else if( csv || s == next )
+				next	= NULL;
+		}
+
+		if( next != NULL )
+			next	= cli_parse_real(s, &points[num_points].y);
+
+		if( next == NULL ) {
+			if( line == 1 )
+				goto skip_line;
+
+			fprintf(stderr, "line %u: expected x%sy\n", line, csv ? "," : " ");
+			return (unsigned int)-1;
+		}
+
+		s	= next;
+		num_points++;
+
+skip_line:
+		while( s < end && *s != '\n' )
+			s++;
+	}
+
+	return num_points;
+}
+
+/*
+* read a whole file, with a terminating 0 so the parsers can read past its
+* end without checking it
+*/
+static char* cli_read_file( const char *path, size_t *size )
+{
+	FILE*		file	= fopen(path, "rb");
+	char*		data;
+	long		length;
+
+	if( file == NULL )
+		return NULL;
+
+	if( fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0 ) {
+		fclose(file);
+		return NULL;
+	}
+
+	data	= (char*)malloc((size_t)length + 1);
+	assert( NULL != data );
+
+	*size	= fread(data, 1, (size_t)length, file);
+	data[*size]	= 0;
+	fclose(file);
+
+	return data;
+}
+
+static int cli_has_extension( const char *path, const char *ext )
+{
+	size_t		len	= strlen(path);
+	size_t		ext_len	= strlen(ext);
+
+	return len >= ext_len && strcmp(path + len - ext_len, ext) == 0;
+}
+
+static cli_input_t cli_input_from_name( const char *name )
+{
+	if( strcmp(name, "csv") == 0 )	return CLI_INPUT_CSV;
+	if( strcmp(name, "text") == 0 )	return CLI_INPUT_TEXT;
+	if( strcmp(name, "bin") == 0 )	return CLI_INPUT_BIN;
+	if( strcmp(name, "del") == 0 )	return CLI_INPUT_DEL;
+	return CLI_INPUT_NONE;
+}
+
+static cli_input_t cli_input_from_path( const char *path )
+{
+	if( cli_has_extension(path, ".csv") )	return CLI_INPUT_CSV;
+	if( cli_has_extension(path, ".bin") )	return CLI_INPUT_BIN;
+	if( cli_has_extension(path, ".del") )	return CLI_INPUT_DEL;
+	return CLI_INPUT_TEXT;
+}
+
+/*
+* buffered text output: the numbers are formatted by hand, printf would take
+* longer than the build
+*/
+static void cli_flush( cli_writer_t *w )
+{
+	fwrite(w->buffer, 1, w->size, w->file);
+	w->size	= 0;
+}
+
+static void cli_put_uint( cli_writer_t *w, unsigned int v, char sep )
+{
+	char		digits[12];
+	int		n	= 0;
+
+	if( w->size + sizeof(digits) > CLI_BUFFER_SIZE )
+		cli_flush(w);
+
+	do {
+		digits[n++]	= (char)('0' + v % 10);
+		v		/= 10;
+	} while( v != 0 );
+
+	while( n > 0 )
+		w->buffer[w->size++]	= digits[--n];
+
+	w->buffer[w->size++]	= sep;
+}
+
+/*
+* input index of a face vertex, the vertices are renumbered by the curve orderings
+*/
+#define CLI_INDEX(del, v)	((del)->indices ? (del)->indices[v] : (v))
+
+/*
+* write the faces, triangles or edges as text
+*
+* @return: the count of written faces, triangles or edges
+*/
+static unsigned int cli_write_text( FILE *file, cli_write_t what, const delaunay2d_t *del, const tri_delaunay2d_t *tdel )
+{
+	cli_writer_t*		w;
+	const unsigned int	*f	= del ? del->faces : NULL;
+	unsigned int		i, j, n, count = 0;
+
+	w	= (cli_writer_t*)malloc(sizeof(cli_writer_t));
+	assert( NULL != w );
+
+	w->file	= file;
+	w->size	= 0;
+
+	switch( what ) {
+	case CLI_WRITE_FACES:
+		/* num verts, then the vertices */
+		for( i = 0; i < del->num_faces; i++, f += n + 1 )
+		{
+			n	= f[0];
+			cli_put_uint(w, n, ' ');
+			for( j = 1; j <= n; j++ )
+				cli_put_uint(w, CLI_INDEX(del, f[j]), (j == n) ? '\n' : ' ');
+		}
+
+		count	= del->num_faces;
+		break;
+
+	case CLI_WRITE_TRIANGLES:
+		/* built straight from the points, with their indices */
+		for( i = 0; i < 3 * tdel->num_triangles; i += 3 )
+		{
+			cli_put_uint(w, tdel->tris[i], ' ');
+			cli_put_uint(w, tdel->tris[i + 1], ' ');
+			cli_put_uint(w, tdel->tris[i + 2], '\n');
+		}
+
+		count	= tdel->num_triangles;
+		break;
+
+	case CLI_WRITE_EDGES:
+		/* the faces hold every edge once each way, the external face included */
+		for( i = 0; i < del->num_faces; i++, f += n + 1 )
+		{
+			n	= f[0];
+			for( j = 1; j <= n; j++ )
+			{
+				unsigned int	a	= CLI_INDEX(del, f[j]);
+				unsigned int	b	= CLI_INDEX(del, f[(j == n) ? 1 : j + 1]);
+
+				if( a < b ) {
+					cli_put_uint(w, a, ' ');
+					cli_put_uint(w, b, '\n');
+					count++;
+				}
+			}
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	cli_flush(w);
+	free(w);
+
+	return count;
+}
+
+static void cli_usage( const char *name )
+{
+	fprintf(stderr, "usage: %s [-i csv|text|bin|del] [-w faces|triangles|edges|none] [-t threads] [-p predicates] [-o ordering] input [output]\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	cli_input_t		input		= CLI_INPUT_NONE;
+	cli_write_t		what		= CLI_WRITE_TRIANGLES;
+	const char*		in_path;
+	const char*		out_path	= NULL;
+	del_file_t*		del_file	= NULL;
+	char*			data		= NULL;
+	const del_point2d_t*	points		= NULL;
+	del_point2d_t*		parsed		= NULL;
+	delaunay2d_context_t*	ctx;
+	delaunay2d_t*		del		= NULL;
+	tri_delaunay2d_t*	tdel		= NULL;
+	del_stats_t		stats;
+	FILE*			out;
+	size_t			size		= 0;
+	unsigned int		num_points	= 0, num_lines, num_duplicates, count = 0;
+	double			start, read_time, write_time, build_time;
+	const char*		p;
+	int			opt;
+
+	while( (opt = getopt(argc, argv, "i:w:t:p:o:")) != -1 )
+	{
+		switch( opt ) {
+		case 'i':
+			input	= cli_input_from_name(optarg);
+			if( input == CLI_INPUT_NONE ) {
+				cli_usage(argv[0]);
+				return 1;
+			}
+			break;
+
+		case 'w':
+			if( strcmp(optarg, "faces") == 0 )		what	= CLI_WRITE_FACES;
+			else if( strcmp(optarg, "triangles") == 0 )	what	= CLI_WRITE_TRIANGLES;
+			else if( strcmp(optarg, "edges") == 0 )		what	= CLI_WRITE_EDGES;
+			else if( strcmp(optarg, "none") == 0 )		what	= CLI_WRITE_NONE;
+			else {
+				cli_usage(argv[0]);
+				return 1;
+			}
+			break;
+
+		case 't':	delaunay2d_set_num_threads((unsigned int)atoi(optarg));			break;
+		case 'p':	delaunay2d_set_predicates((del_predicates_t)atoi(optarg));		break;
+		case 'o':	delaunay2d_set_ordering((del_ordering_t)atoi(optarg));			break;
+		default:
+			cli_usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if( optind >= argc || argc - optind > 2 ) {
+		cli_usage(argv[0]);
+		return 1;
+	}
+
+	in_path		= argv[optind];
+	if( argc - optind == 2 && strcmp(argv[optind + 1], "-") != 0 )
+		out_path	= argv[optind + 1];
+
+	if( input == CLI_INPUT_NONE )
+		input	= cli_input_from_path(in_path);
+
+	/* read */
+	start	= cli_clock();
+	if( input == CLI_INPUT_DEL ) {
+		del_file	= del_file_open(in_path);
+		if( del_file != NULL ) {
+			points		= del_file_triangles(del_file)->points;
+			num_points	= del_file_triangles(del_file)->num_points;
+		}
+	} else {
+		data	= cli_read_file(in_path, &size);
+		if( data != NULL && input == CLI_INPUT_BIN ) {
+			if( size % sizeof(del_point2d_t) != 0 ) {
+				fprintf(stderr, "%s: %lu bytes is not a whole number of points\n", in_path, (unsigned long)size);
+				return 1;
+			}
+
+			points		= (const del_point2d_t*)data;
+			num_points	= (unsigned int)(size / sizeof(del_point2d_t));
+		} else if( data != NULL ) {
+			/* a point per line at most */
+			num_lines	= 1;
+			for( p = data; (p = (const char*)memchr(p, '\n', size - (size_t)(p - data))) != NULL; p++ )
+				num_lines++;
+
+			parsed	= (del_point2d_t*)malloc(sizeof(del_point2d_t) * num_lines);
+			assert( NULL != parsed );
+
+			num_points	= cli_parse_points(data, data + size, input == CLI_INPUT_CSV, parsed);
+			if( num_points == (unsigned int)-1 ) {
+				fprintf(stderr, "%s: not a %s point file\n", in_path, input == CLI_INPUT_CSV ? "csv" : "text");
+				return 1;
+			}
+
+			points	= parsed;
+		}
+	}
+
+	if( del_file == NULL && data == NULL ) {
+		fprintf(stderr, "%s: can't read the file\n", in_path);
+		return 1;
+	}
+	read_time	= cli_clock() - start;
+
+	/* build, the points are only read. The triangles skip the faces */
+	ctx	= delaunay2d_context_create();
+	if( what == CLI_WRITE_TRIANGLES )
+		tdel	= tri_delaunay2d_context_points(ctx, points, num_points);
+	else
+		del	= delaunay2d_context_from(ctx, (del_point2d_t*)points, num_points);
+
+	delaunay2d_context_representatives(ctx, &num_duplicates);
+	delaunay2d_context_stats(ctx, &stats);
+
+	/* write */
+	start	= cli_clock();
+	if( what == CLI_WRITE_TRIANGLES && out_path != NULL && cli_has_extension(out_path, ".del") ) {
+		/* the triangulation file keeps the input points */
+		if( !tri_delaunay2d_write_file(tdel, 0, out_path) ) {
+			fprintf(stderr, "%s: can't write the file\n", out_path);
+			return 1;
+		}
+
+		count	= tdel->num_triangles;
+	} else if( what != CLI_WRITE_NONE ) {
+		out	= (out_path != NULL) ? fopen(out_path, "wb") : stdout;
+		if( out == NULL ) {
+			fprintf(stderr, "%s: can't write the file\n", out_path);
+			return 1;
+		}
+
+		count	= cli_write_text(out, what, del, tdel);
+		if( out != stdout )
+			fclose(out);
+		else
+			fflush(out);
+	}
+	write_time	= cli_clock() - start;
+
+	build_time	= stats.copy + stats.sort + stats.divide_and_conquer + stats.faces;
+
+	fprintf(stderr, "points       %u (%u duplicates)\n", num_points, num_duplicates);
+	if( del != NULL )
+		fprintf(stderr, "faces        %u\n", del->num_faces);
+	else
+		fprintf(stderr, "triangles    %u\n", tdel->num_triangles);
+	if( what == CLI_WRITE_EDGES )
+		fprintf(stderr, "edges        %u\n", count);
+
+	fprintf(stderr, "read         %10.6f s\n", read_time);
+	fprintf(stderr, "copy         %10.6f s\n", stats.copy);
+	fprintf(stderr, "sort         %10.6f s\n", stats.sort);
+	fprintf(stderr, "dc           %10.6f s\n", stats.divide_and_conquer);
+	fprintf(stderr, "%s    %10.6f s\n", (del != NULL) ? "faces    " : "triangles", stats.faces);
+	fprintf(stderr, "write        %10.6f s\n", write_time);
+	fprintf(stderr, "build        %10.6f s  %.0f points/s\n", build_time, build_time > 0 ? num_points / build_time : 0.0);
+	fprintf(stderr, "total        %10.6f s  %.0f points/s\n", read_time + build_time + write_time,
+		read_time + build_time + write_time > 0 ? num_points / (read_time + build_time + write_time) : 0.0);
+
+	delaunay2d_context_release(ctx);
+	if( del_file != NULL )
+		del_file_close(del_file);
+	free(parsed);
+	free(data);
+
+	return 0;
+}
@@ -20,8 +20,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
+#include <float.h>
 #include <string.h>
 #include <assert.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef DEL_STATS
+#include <time.h>
+#endif
 
 #include "delaunay.h"
 
@@ -33,6 +43,102 @@
 #define	ON_CIRCLE	0
 #define INSIDE		1
 
+/* below this point count, a divide and conquer half is not worth a thread */
+#ifndef DEL_PARALLEL_CUTOFF
+#define DEL_PARALLEL_CUTOFF	(1 << 14)
+#endif
+
+/* the filtered predicates need strict double arithmetic (no x87 intermediates) */
+#if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD != 0)
+#define DEL_HAVE_FILTERED_PREDICATES	0
+#else
+#define DEL_HAVE_FILTERED_PREDICATES	1
+#endif
+
+/* the integer predicates evaluate incircle with 128 bits integers */
+#ifdef __SIZEOF_INT128__
+#define DEL_HAVE_INTEGER_PREDICATES	1
+#else
+#define DEL_HAVE_INTEGER_PREDICATES	0
+#endif
+
+#if defined(DEL_FILTERED_PREDICATES) && DEL_HAVE_FILTERED_PREDICATES
+#define DEL_DEFAULT_PREDICATES		DEL_PREDICATES_FILTERED
+#else
+#define DEL_DEFAULT_PREDICATES		DEL_PREDICATES_LONG_DOUBLE
+#endif
+
+/* the query points are any reals, whatever the predicates of the build */
+#if DEL_HAVE_FILTERED_PREDICATES
+#define DEL_QUERY_PREDICATES		DEL_PREDICATES_FILTERED
+#else
+#define DEL_QUERY_PREDICATES		DEL_PREDICATES_LONG_DOUBLE
+#endif
+
+/* largest coordinate of the integer predicates */
+#define DEL_INTEGER_MAX		((real)(1 << 29))
+
+/* double precision constants of the filtered predicates (Shewchuk) */
+#define DEL_EPSILON		1.1102230246251565e-16	/* 2^-53 */
+#define DEL_SPLITTER		134217729.0		/* 2^27 + 1 */
+#define DEL_CCW_ERRBOUND	((3.0 + 16.0 * DEL_EPSILON) * DEL_EPSILON)
+#define DEL_ICC_ERRBOUND	((10.0 + 96.0 * DEL_EPSILON) * DEL_EPSILON)
+
+/* upper bound on the threads working on a single build */
+#define DEL_MAX_THREADS		256
+
+/* the point sort is a LSD radix sort over 11 bits digits of 64 bits keys */
+#define DEL_RADIX_BITS		11
+#define DEL_RADIX_SIZE		(1 << DEL_RADIX_BITS)
+#define DEL_RADIX_DIGITS	6
+#define DEL_RADIX_PASSES	(2 * DEL_RADIX_DIGITS)
+
+#define DEL_SIGN_BIT		0x8000000000000000ull
+
+/* phase timings of the context builds */
+#ifdef DEL_STATS
+#define DEL_STATS_START(ctx)		del_stats_start(ctx)
+#define DEL_STATS_PHASE(ctx, phase)	del_stats_phase(ctx, &((ctx)->stats.phase))
+#else
+#define DEL_STATS_START(ctx)
+#define DEL_STATS_PHASE(ctx, phase)
+#endif
+
+/* scratch of a point: its 2 sort keys during the sort, then its 2 * 3 halfedges */
+#define DEL_SCRATCH_SIZE	(2 * sizeof(sort_key_t) > 2 * 3 * sizeof(halfedge_t) ? 2 * sizeof(sort_key_t) : 2 * 3 * sizeof(halfedge_t))
+
+/* null halfedge index */
+#define DEL_NIL			0xFFFFFFFFu
+
+/* bytes per point of a streaming build: the build buffers, the points and
+   their front copy, and the halfedge and face states */
+#define DEL_STREAM_POINT_SIZE	(sizeof(point2d_t) + DEL_SCRATCH_SIZE + 6 * (sizeof(unsigned int) + sizeof(unsigned char)) + \
+				 2 * (sizeof(face_t) + sizeof(unsigned char) + sizeof(unsigned int)) + 8 * sizeof(unsigned int) + \
+				 2 * (sizeof(del_point2d_t) + sizeof(unsigned int)) + 2 * sizeof(unsigned int) + 6 * sizeof(unsigned int))
+
+/* smallest point count of a streaming build */
+#define DEL_STREAM_MIN_POINTS	1024
+
+/* largest point count of a stream: the point ids are unsigned int, and DEL_NIL
+   reports an error */
+#define DEL_STREAM_MAX_POINTS	(DEL_NIL - 1)
+
+/* point and triangulation files */
+#define DEL_FILE_MAGIC		"DELF"
+#define DEL_FILE_VERSION	1
+#define DEL_FILE_NEIGHBORS	1		/* the triangles neighbours follow the triangles */
+
+/* face states of a streaming build */
+#define DEL_FACE_OPEN		0		/* may still change */
+#define DEL_FACE_DONE		1		/* written by a previous build */
+#define DEL_FACE_FINAL		2		/* written by this build */
+
+/* halfedge navigation */
+#define HE(ws, e)		((ws)->edges[(e)])
+#define HE_PAIR(e)		((e) ^ 1)
+#define HE_VERTEX(ws, e)	(&((ws)->points[HE(ws, e).vertex]))
+#define HE_FACE_NEXT(ws, e)	(HE(ws, HE_PAIR(e)).prev)	/* next halfedge on the face on the left of e */
+
 struct	point2d_s;
 struct	face_s;
 struct	halfedge_s;
@@ -50,33 +156,38 @@ typedef struct face_s		face_t;
 typedef struct halfedge_s	halfedge_t;
 typedef struct delaunay_s	delaunay_t;
 typedef struct working_set_s	working_set_t;
+typedef struct sort_key_s	sort_key_t;
+typedef struct del_sort_task_s	del_sort_task_t;
+typedef struct del_curve_key_s	del_curve_key_t;
 
 typedef long double lreal;
 typedef lreal mat3_t[3][3];
 
+/*
+* halfedges live in the working set array and are addressed by their index,
+* the 2 halfedges of an edge are allocated together so the pair of e is e ^ 1
+*/
 struct point2d_s {
 	real			x, y;			/* point coordinates */
-	halfedge_t*		he;			/* point halfedge */
+	unsigned int		he;			/* point halfedge */
 	unsigned int		idx;			/* point index in input buffer */
 };
 
 struct face_s {
-	halfedge_t*		he;			/* a pointing half edge */
+	unsigned int		he;			/* a pointing half edge */
 	unsigned int		num_verts;		/* number of vertices on this face */
 };
 
 struct halfedge_s {
-	point2d_t*		vertex;			/* vertex */
-	halfedge_t*		pair;			/* pair */
-	halfedge_t*		next;			/* next */
-	halfedge_t*		prev;			/* next^-1 */
-	face_t*			face;			/* halfedge face */
+	unsigned int		vertex;			/* vertex */
+	unsigned int		next;			/* next */
+	unsigned int		prev;			/* next^-1 */
 };
 
 struct delaunay_s {
-	halfedge_t*		rightmost_he;		/* right most halfedge */
-	halfedge_t*		leftmost_he;		/* left most halfedge */
-	point2d_t*		points;			/* pointer to points */
+	unsigned int		rightmost_he;		/* right most halfedge */
+	unsigned int		leftmost_he;		/* left most halfedge */
+	working_set_t*		ws;			/* where the points and halfedges are */
 	face_t*			faces;			/* faces of delaunay */
 	unsigned int		num_faces;		/* face count */
 	unsigned int		start_point;		/* start point index */
@@ -84,17 +195,102 @@ struct delaunay_s {
 };
 
 struct working_set_s {
+	point2d_t*		points;			/* the sorted points */
 	halfedge_t*		edges;			/* all the edges (allocated in one shot) */
 	face_t*			faces;			/* all the faces (allocated in one shot) */
+	unsigned int*		he_face;		/* face of each halfedge, only allocated to build the faces */
 
 	unsigned int		max_edge;		/* maximum edge count: 2 * 3 * n where n is point count */
-	unsigned int		max_face;		/* maximum face count: 2 * n where n is point count */
+	unsigned int		max_face;		/* maximum face count, known once the faces are counted */
 
 	unsigned int		num_edges;		/* number of allocated edges */
 	unsigned int		num_faces;		/* number of allocated faces */
+	unsigned int		used_edges;		/* number of edges in use */
+
+	unsigned int		free_edge;		/* first free edge */
+	unsigned int		free_face;		/* first free face */
+
+	del_predicates_t	predicates;		/* predicates of the build */
+	del_ordering_t		ordering;		/* vertex order of the build */
+};
+
+struct sort_key_s {
+	uint64_t		kx, ky;			/* order preserving keys of the coordinates */
+	unsigned int		idx;			/* point index in input buffer */
+};
+
+struct del_curve_key_s {
+	unsigned int		key;			/* position on a space filling curve */
+	unsigned int		idx;			/* point index */
+};
+
+struct del_sort_task_s {
+	const del_point2d_t*	input;			/* input points */
+	point2d_t*		points;			/* sorted points */
+	sort_key_t*		src;			/* keys to sort */
+	sort_key_t*		dst;			/* sorted keys of the current pass */
+	unsigned int		start;			/* first key of the task */
+	unsigned int		end;			/* last key of the task + 1 */
+	unsigned int		pass;			/* current pass */
+	unsigned int		num_duplicates;		/* keys sharing the coordinates of the previous one */
+	unsigned int		count[DEL_RADIX_PASSES][DEL_RADIX_SIZE];	/* digit histograms (offsets when scattering) */
+};
 
-	halfedge_t*		free_edge;		/* pointer to the first free edge */
-	face_t*			free_face;		/* pointer to the first free face */
+/*
+* the buffers of the builds, kept and grown from one build to the next
+*/
+struct delaunay2d_context_s {
+	del_predicates_t	predicates;		/* predicates of the builds */
+	del_ordering_t		ordering;		/* vertex and face order of the builds */
+	unsigned int		num_threads;		/* thread count of the builds, 0 for all the online processors */
+
+	point2d_t*		points;			/* the sorted points */
+	void*			scratch;		/* the sort keys, then the halfedges */
+	del_sort_task_t*	tasks;			/* sort tasks */
+	face_t*			faces;			/* faces */
+	unsigned int*		he_face;		/* face of each halfedge */
+
+	unsigned int		max_points;		/* capacity of points */
+	unsigned int		max_scratch;		/* capacity of scratch in points */
+	unsigned int		max_tasks;		/* capacity of tasks */
+	unsigned int		max_faces;		/* capacity of faces */
+	unsigned int		max_he_face;		/* capacity of he_face */
+
+	del_curve_key_t*	curve_keys;		/* curve keys of the points, and their sort buffer */
+	point2d_t*		curve_points;		/* the points along the curve */
+	halfedge_t*		curve_edges;		/* the halfedges along the curve */
+	unsigned int		max_curve_keys;		/* capacity of curve_keys */
+	unsigned int		max_curve_points;	/* capacity of curve_points */
+	unsigned int		max_curve_edges;	/* capacity of curve_edges */
+
+	working_set_t		ws;			/* halfedges of the last build, in the buffers above */
+
+	delaunay2d_t		del;			/* result of the last build */
+	unsigned int		max_del_points;		/* capacity of del.points */
+	unsigned int		max_del_faces;		/* capacity of del.faces */
+	unsigned int*		indices;		/* input index of the renumbered points, del.indices when they are */
+	unsigned int		max_indices;		/* capacity of indices */
+	unsigned int*		representatives;	/* representative of each input point, del.representatives when there are duplicates */
+	unsigned int		max_representatives;	/* capacity of representatives */
+
+	tri_delaunay2d_t	tdel;			/* result of the last triangles build */
+	unsigned int		max_tdel_points;	/* capacity of tdel.points */
+	unsigned int		max_tdel_tris;		/* capacity of tdel.tris */
+
+	delaunay2d_voronoi_t	vor;			/* result of the last Voronoi build */
+	unsigned int		max_vor_vertices;	/* capacity of vor.vertices */
+	unsigned int		max_vor_offsets;	/* capacity of vor.offsets */
+	unsigned int		max_vor_cells;		/* capacity of vor.cells */
+	unsigned int		max_vor_rays;		/* capacity of vor.rays */
+
+	delaunay2d_adjacency_t	adj;			/* result of the last adjacency build */
+	unsigned int		max_adj_offsets;	/* capacity of adj.offsets */
+	unsigned int		max_adj_neighbors;	/* capacity of adj.neighbors */
+
+#ifdef DEL_STATS
+	del_stats_t		stats;			/* phases of the last build */
+	double			stats_clock;		/* end of the last phase */
+#endif
 };
 
 /*
@@ -110,849 +306,5025 @@ static lreal det3(mat3_t m)
 }
 
 /*
-* allocate a halfedge
+* allocate an edge from the working set, reusing freed ones first. The
+* returned halfedge is even, its pair is the next one
 */
-static halfedge_t* halfedge_alloc()
+static unsigned int halfedge_alloc( working_set_t *ws )
 {
-	halfedge_t*		d;
+	unsigned int		e;
+
+	if( ws->free_edge != DEL_NIL )
+	{
+		e		= ws->free_edge;
+		ws->free_edge	= HE(ws, e).next;
+	} else {
+		assert( ws->num_edges + 2 <= ws->max_edge );
+		e		= ws->num_edges;
+		ws->num_edges	+= 2;
+	}
+
+	ws->used_edges	+= 2;
 
-	d	= (halfedge_t*)malloc(sizeof(halfedge_t));
-	assert( NULL != d );
-	memset(d, 0, sizeof(halfedge_t));
+	HE(ws, e).vertex		= HE(ws, HE_PAIR(e)).vertex	= DEL_NIL;
+	HE(ws, e).next			= HE(ws, HE_PAIR(e)).next	= DEL_NIL;
+	HE(ws, e).prev			= HE(ws, HE_PAIR(e)).prev	= DEL_NIL;
+
+	return e;
+}
+
+/*
+* give an edge (both halfedges) back to the working set free list
+*/
+static void halfedge_free( working_set_t *ws, unsigned int e )
+{
+	e	&= ~1u;
 
-	return d;
+	HE(ws, e).vertex		= HE(ws, HE_PAIR(e)).vertex	= DEL_NIL;
+	HE(ws, HE_PAIR(e)).next		= HE(ws, e).prev		= HE(ws, HE_PAIR(e)).prev	= DEL_NIL;
+	HE(ws, e).next			= ws->free_edge;
+	ws->free_edge			= e;
 }
 
 /*
-* free a halfedge
+* test if the integer predicates are exact for a point: integer coordinates
+* within +/- 2^29 (NaN is not)
 */
-static void halfedge_free( halfedge_t* d )
+static int del_integer_point( real x, real y )
 {
-	assert( d != NULL );
-	memset(d, 0, sizeof(halfedge_t));
-	free(d);
+	return x >= -DEL_INTEGER_MAX && x <= DEL_INTEGER_MAX && x == floor(x) &&
+	       y >= -DEL_INTEGER_MAX && y <= DEL_INTEGER_MAX && y == floor(y);
 }
 
+static del_predicates_t del_supported_predicates( del_predicates_t predicates );
+
 /*
-* free all delaunay halfedges
+* setup the working set of a context build for a given point count, the
+* scratch holds 2 * 3 * n halfedges. The integer predicates are checked
+* against the (sorted) points once, the build falls back to the filtered
+* ones when a point doesn't suit them
 */
-void del_free_halfedges( delaunay_t *del )
+static void del_init_working_set( working_set_t *ws, delaunay2d_context_t *ctx, unsigned int num_points )
 {
 	unsigned int		i;
-	halfedge_t		*d, *sig;
 
-	/* if there is nothing to do */
-	if( del->points == NULL )
-		return;
+	memset(ws, 0, sizeof(working_set_t));
 
-	for( i = 0; i <= (del->end_point - del->start_point); i++ )
-	{
-		/* free all the halfedges around the point */
-		d	= del->points[i].he;
-		if( d != NULL )
-		{
-			do {
-				sig	= d->next;
-				halfedge_free( d );
-				d	= sig;
-			} while( d != del->points[i].he );
-			del->points[i].he	= NULL;
-		}
+	ws->points	= ctx->points;
+	ws->edges	= (halfedge_t*)ctx->scratch;
+	ws->predicates	= ctx->predicates;
+	ws->ordering	= ctx->ordering;
+
+	if( ws->predicates == DEL_PREDICATES_INTEGER ) {
+		for( i = 0; i < num_points; i++ )
+			if( !del_integer_point(ctx->points[i].x, ctx->points[i].y) )
+				break;
+
+		if( i < num_points )
+			ws->predicates	= del_supported_predicates(DEL_PREDICATES_FILTERED);
 	}
+	ws->max_edge	= 2 * 3 * num_points;
+	ws->max_face	= 2 * num_points;
+	ws->free_edge	= DEL_NIL;
+	ws->free_face	= DEL_NIL;
 }
 
-/*
-* compare 2 points when sorting
-*/
-static int cmp_points( const void *_pt0, const void *_pt1 )
+#ifdef DEL_STATS
+static double del_stats_clock(void)
 {
-	point2d_t		*pt0, *pt1;
+	struct timespec		ts;
 
-	pt0	= (point2d_t*)(_pt0);
-	pt1	= (point2d_t*)(_pt1);
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
 
-	if( pt0->x < pt1->x )
-		return -1;
-	else if( pt0->x > pt1->x )
-		return 1;
-	else if( pt0->y < pt1->y )
-		return -1;
-	else if( pt0->y > pt1->y )
-		return 1;
-	assert(0 && "2 or more points share the same exact coordinate");
-	return 0; /* Should not be given! */
+static void del_stats_start( delaunay2d_context_t *ctx )
+{
+	memset(&ctx->stats, 0, sizeof(del_stats_t));
+	ctx->stats_clock	= del_stats_clock();
 }
 
+static void del_stats_phase( delaunay2d_context_t *ctx, double *phase )
+{
+	double			now	= del_stats_clock();
+
+	*phase			+= now - ctx->stats_clock;
+	ctx->stats_clock	= now;
+}
+#endif
+
 /*
-* classify a point relative to a segment
+* make sure a context buffer holds count items, its content is not kept
 */
-static int classify_point_seg( point2d_t *s, point2d_t *e, point2d_t *pt )
+static void* del_reserve( void *buff, unsigned int *capacity, unsigned int count, size_t size )
 {
-	lreal		se_x, se_y, spt_x, spt_y;
-	lreal		res;
-
-	se_x	= e->x - s->x;
-	se_y	= e->y - s->y;
+	if( buff != NULL && count <= *capacity )
+		return buff;
 
-	spt_x	= pt->x - s->x;
-	spt_y	= pt->y - s->y;
+	free(buff);
 
-	res	= (( se_x * spt_y ) - ( se_y * spt_x ));
-	if( res < REAL_ZERO )
-		return ON_RIGHT;
-	else if( res > REAL_ZERO )
-		return ON_LEFT;
+	*capacity	= count > 0 ? count : 1;
+	buff		= malloc(*capacity * size);
+	assert( NULL != buff );
 
-	return ON_SEG;
+	return buff;
 }
 
 /*
-* classify a point relative to a halfedge, -1 is left, 0 is on, 1 is right
+* make sure a buffer holds count items, keeping its content. It grows by half
+* its capacity at least, so that appending one item at a time stays cheap
 */
-static int del_classify_point( halfedge_t *d, point2d_t *pt )
+static void* del_grow( void *buff, unsigned int *capacity, unsigned int count, size_t size )
 {
-	point2d_t		*s, *e;
+	if( buff != NULL && count <= *capacity )
+		return buff;
 
-	s		= d->vertex;
-	e		= d->pair->vertex;
+	if( count < *capacity + *capacity / 2 )
+		count	= *capacity + *capacity / 2;
 
-	return classify_point_seg(s, e, pt);
+	*capacity	= count > 0 ? count : 1;
+	buff		= realloc(buff, *capacity * size);
+	assert( NULL != buff );
+
+	return buff;
 }
 
 /*
-* test if a point is inside a circle given by 3 points, 1 if inside, 0 if outside
+* run independent tasks concurrently, one thread per task (the calling
+* thread takes the first one, and any task that can't get a thread)
 */
-static int in_circle( point2d_t *pt0, point2d_t *pt1, point2d_t *pt2, point2d_t *p )
+static void del_run_tasks( void *tasks, size_t task_size, unsigned int num_tasks, void* (*run)(void*) )
 {
-	// reduce the computational complexity by substracting the last row of the matrix
-	// ref: https://www.cs.cmu.edu/~quake/robust.html
-	lreal	p0p_x, p0p_y, p1p_x, p1p_y, p2p_x, p2p_y, p0p, p1p, p2p, res;
-	mat3_t	m;
+	pthread_t		threads[DEL_MAX_THREADS];
+	int			started[DEL_MAX_THREADS];
+	unsigned int		i;
 
-	p0p_x	= pt0->x - p->x;
-	p0p_y	= pt0->y - p->y;
+	assert( num_tasks <= DEL_MAX_THREADS );
 
-	p1p_x	= pt1->x - p->x;
-	p1p_y	= pt1->y - p->y;
+	for( i = 1; i < num_tasks; i++ )
+		started[i]	= pthread_create(&threads[i], NULL, run, (char*)tasks + i * task_size) == 0;
 
-	p2p_x	= pt2->x - p->x;
-	p2p_y	= pt2->y - p->y;
+	run( tasks );
 
-	p0p	= p0p_x * p0p_x + p0p_y * p0p_y;
-	p1p	= p1p_x * p1p_x + p1p_y * p1p_y;
-	p2p	= p2p_x * p2p_x + p2p_y * p2p_y;
+	for( i = 1; i < num_tasks; i++ )
+	{
+		if( started[i] )
+			pthread_join( threads[i], NULL );
+		else
+			run( (char*)tasks + i * task_size );
+	}
+}
 
-	m[0][0]	= p0p_x;
-	m[0][1]	= p0p_y;
-	m[0][2] = p0p;
+/*
+* map a coordinate to an unsigned key with the same order
+*/
+static uint64_t del_real_key( real v )
+{
+	union { real r; uint64_t u; }	k;
 
-	m[1][0]	= p1p_x;
-	m[1][1]	= p1p_y;
-	m[1][2] = p1p;
+	k.r	= v + 0.0;			/* -0 and +0 share the same key */
+	return (k.u & DEL_SIGN_BIT) ? ~k.u : (k.u | DEL_SIGN_BIT);
+}
 
-	m[2][0]	= p2p_x;
-	m[2][1]	= p2p_y;
-	m[2][2] = p2p;
+/*
+* map a key back to its coordinate
+*/
+static real del_key_real( uint64_t key )
+{
+	union { real r; uint64_t u; }	k;
 
-	res	= -det3(m);
+	k.u	= (key & DEL_SIGN_BIT) ? (key & ~DEL_SIGN_BIT) : ~key;
+	return k.r;
+}
 
-	if( res < REAL_ZERO )
-		return INSIDE;
-	else if( res > REAL_ZERO )
-		return OUTSIDE;
+/*
+* radix digit of a sort key: the first passes sort on y, the last ones on x
+*/
+static unsigned int sort_key_digit( const sort_key_t *k, unsigned int pass )
+{
+	uint64_t		key	= (pass < DEL_RADIX_DIGITS) ? k->ky : k->kx;
 
-	return ON_CIRCLE;
+	return (unsigned int)(key >> ((pass % DEL_RADIX_DIGITS) * DEL_RADIX_BITS)) & (DEL_RADIX_SIZE - 1);
 }
 
 /*
-* initialize delaunay segment
+* compute the keys of a range of points, and the digit histograms of all the passes
 */
-static int del_init_seg( delaunay_t *del, int start )
+static void* del_sort_keys_task( void *arg )
 {
-	halfedge_t		*d0, *d1;
-	point2d_t		*pt0, *pt1;
+	del_sort_task_t		*task	= (del_sort_task_t*)arg;
+	sort_key_t		*k;
+	unsigned int		i, p;
 
-	/* init delaunay */
-	del->start_point	= start;
-	del->end_point		= start + 1;
+	memset(task->count, 0, sizeof(task->count));
 
-	/* setup pt0 and pt1 */
-	pt0			= &(del->points[start]);
-	pt1			= &(del->points[start + 1]);
+	for( i = task->start; i < task->end; i++ )
+	{
+		k	= &(task->src[i]);
+		k->kx	= del_real_key(task->input[i].x);
+		k->ky	= del_real_key(task->input[i].y);
+		k->idx	= i;
 
-	/* allocate the halfedges and setup them */
-	d0	= halfedge_alloc();
-	d1	= halfedge_alloc();
+		for( p = 0; p < DEL_RADIX_PASSES; p++ )
+			(task->count[p][sort_key_digit(k, p)])++;
+	}
 
-	d0->vertex	= pt0;
-	d1->vertex	= pt1;
+	return NULL;
+}
 
-	d0->next	= d0->prev	= d0;
-	d1->next	= d1->prev	= d1;
+/*
+* histogram of the current pass digit over a range of keys
+*/
+static void* del_sort_count_task( void *arg )
+{
+	del_sort_task_t		*task	= (del_sort_task_t*)arg;
+	unsigned int		*count	= task->count[task->pass];
+	unsigned int		i;
 
-	d0->pair	= d1;
-	d1->pair	= d0;
+	memset(count, 0, DEL_RADIX_SIZE * sizeof(unsigned int));
 
-	pt0->he	= d0;
-	pt1->he	= d1;
+	for( i = task->start; i < task->end; i++ )
+		(count[sort_key_digit(&(task->src[i]), task->pass)])++;
 
-	del->rightmost_he	= d1;
-	del->leftmost_he	= d0;
+	return NULL;
+}
+
+/*
+* stable scatter of a range of keys, the pass histogram holds the range offsets
+*/
+static void* del_sort_scatter_task( void *arg )
+{
+	del_sort_task_t		*task	= (del_sort_task_t*)arg;
+	unsigned int		*offset	= task->count[task->pass];
+	unsigned int		i;
 
+	for( i = task->start; i < task->end; i++ )
+		task->dst[(offset[sort_key_digit(&(task->src[i]), task->pass)])++]	= task->src[i];
 
-	return 0;
+	return NULL;
 }
 
 /*
-* initialize delaunay triangle
+* copy a range of sorted keys to the points, counting the duplicates on the way
 */
-static int del_init_tri( delaunay_t *del, int start )
+static void* del_sort_gather_task( void *arg )
 {
-	halfedge_t		*d0, *d1, *d2, *d3, *d4, *d5;
-	point2d_t		*pt0, *pt1, *pt2;
+	del_sort_task_t		*task	= (del_sort_task_t*)arg;
+	sort_key_t		*k;
+	unsigned int		i;
 
-	/* initiate delaunay */
-	del->start_point	= start;
-	del->end_point		= start + 2;
+	task->num_duplicates	= 0;
 
-	/* setup the points */
-	pt0					= &(del->points[start]);
-	pt1					= &(del->points[start + 1]);
-	pt2					= &(del->points[start + 2]);
+	for( i = task->start; i < task->end; i++ )
+	{
+		k	= &(task->src[i]);
 
-	/* allocate the 6 halfedges */
-	d0	= halfedge_alloc();
-	d1	= halfedge_alloc();
-	d2	= halfedge_alloc();
-	d3	= halfedge_alloc();
-	d4	= halfedge_alloc();
-	d5	= halfedge_alloc();
+		if( i > 0 && k->kx == k[-1].kx && k->ky == k[-1].ky )
+			task->num_duplicates++;
 
-	if( classify_point_seg(pt0, pt2, pt1) == ON_LEFT )	/* first case */
-	{
-		/* set halfedges points */
-		d0->vertex	= pt0;
-		d1->vertex	= pt2;
-		d2->vertex	= pt1;
+		task->points[i].x	= del_key_real(k->kx);
+		task->points[i].y	= del_key_real(k->ky);
+		task->points[i].idx	= k->idx;
+		task->points[i].he	= DEL_NIL;
+	}
 
-		d3->vertex	= pt2;
-		d4->vertex	= pt1;
-		d5->vertex	= pt0;
+	return NULL;
+}
 
-		/* set points halfedges */
-		pt0->he	= d0;
-		pt1->he	= d2;
-		pt2->he	= d1;
+/*
+* keep the first point of each run of equal keys, the stable sort leaves the
+* lowest input index first. It becomes the representative of the run
+*/
+static unsigned int del_sort_unique( delaunay2d_context_t *ctx, const sort_key_t *keys, unsigned int num_points )
+{
+	point2d_t		*points	= ctx->points;
+	unsigned int		*reps;
+	unsigned int		i, j, rep;
 
-		/* next and next -1 setup */
-		d0->next	= d5;
-		d0->prev	= d5;
+	reps	= ctx->representatives	= (unsigned int*)del_reserve(ctx->representatives, &ctx->max_representatives, num_points, sizeof(unsigned int));
 
-		d1->next	= d3;
-		d1->prev	= d3;
+	rep	= DEL_NIL;
+	for( i = 0, j = 0; i < num_points; i++ )
+	{
+		if( i == 0 || keys[i].kx != keys[i - 1].kx || keys[i].ky != keys[i - 1].ky ) {
+			rep		= keys[i].idx;
+			points[j++]	= points[i];
+		}
 
-		d2->next	= d4;
-		d2->prev	= d4;
+		reps[keys[i].idx]	= rep;
+	}
 
-		d3->next	= d1;
-		d3->prev	= d1;
+	return j;
+}
 
-		d4->next	= d2;
-		d4->prev	= d2;
+/*
+* sort the points by x then y with a LSD radix sort on the coordinate keys,
+* passes where all the keys share the same digit are skipped. The duplicates
+* are left out, del.representatives maps them to the kept point (NULL when
+* there are none). Returns the number of kept points
+*/
+static unsigned int del_sort_points( delaunay2d_context_t *ctx, const del_point2d_t *input, unsigned int num_points, unsigned int num_threads )
+{
+	del_sort_task_t		*tasks;
+	point2d_t		*points;
+	sort_key_t		*src, *dst, *tmp;
+	unsigned int		num_tasks, chunk, offset, i, t, b, p, first, num_duplicates;
+
+	num_tasks	= (num_points < DEL_PARALLEL_CUTOFF) ? 1 : num_threads;
+	if( num_tasks > DEL_MAX_THREADS )
+		num_tasks	= DEL_MAX_THREADS;
+	chunk		= (num_points + num_tasks - 1) / num_tasks;
+
+	/* the keys go to the context scratch, the halfedges only need it later */
+	points	= ctx->points	= (point2d_t*)del_reserve(ctx->points, &ctx->max_points, num_points, sizeof(point2d_t));
+	tasks	= ctx->tasks	= (del_sort_task_t*)del_reserve(ctx->tasks, &ctx->max_tasks, num_tasks, sizeof(del_sort_task_t));
+	src	= (sort_key_t*)ctx->scratch;
+	dst	= src + num_points;
+
+	for( t = 0; t < num_tasks; t++ )
+	{
+		tasks[t].input	= input;
+		tasks[t].points	= points;
+		tasks[t].src	= src;
+		tasks[t].start	= (t * chunk < num_points) ? t * chunk : num_points;
+		tasks[t].end	= (tasks[t].start + chunk < num_points) ? tasks[t].start + chunk : num_points;
+	}
 
-		d5->next	= d0;
-		d5->prev	= d0;
+	del_run_tasks( tasks, sizeof(del_sort_task_t), num_tasks, del_sort_keys_task );
 
-		/* set halfedges pair */
-		d0->pair	= d3;
-		d3->pair	= d0;
+	first	= 1;
+	for( p = 0; p < DEL_RADIX_PASSES; p++ )
+	{
+		/* skip the pass if a single bucket holds all the keys */
+		for( b = 0; b < DEL_RADIX_SIZE; b++ )
+		{
+			for( i = 0, t = 0; t < num_tasks; t++ )
+				i	+= tasks[t].count[p][b];
+			if( i != 0 )
+				break;
+		}
+		if( i == num_points )
+			continue;
 
-		d1->pair	= d4;
-		d4->pair	= d1;
+		for( t = 0; t < num_tasks; t++ )
+		{
+			tasks[t].src	= src;
+			tasks[t].dst	= dst;
+			tasks[t].pass	= p;
+		}
 
-		d2->pair	= d5;
-		d5->pair	= d2;
+		/* the histograms of the first pass were computed with the keys */
+		if( !first && num_tasks > 1 )
+			del_run_tasks( tasks, sizeof(del_sort_task_t), num_tasks, del_sort_count_task );
+		first	= 0;
 
-		del->rightmost_he	= d1;
-		del->leftmost_he		= d0;
+		/* turn the histograms into offsets, bucket major so the sort is stable */
+		offset	= 0;
+		for( b = 0; b < DEL_RADIX_SIZE; b++ )
+		{
+			for( t = 0; t < num_tasks; t++ )
+			{
+				i			= tasks[t].count[p][b];
+				tasks[t].count[p][b]	= offset;
+				offset			+= i;
+			}
+		}
 
-	} else /* 2nd case */
-	{
-		/* set halfedges points */
-		d0->vertex	= pt0;
-		d1->vertex	= pt1;
-		d2->vertex	= pt2;
+		del_run_tasks( tasks, sizeof(del_sort_task_t), num_tasks, del_sort_scatter_task );
 
-		d3->vertex	= pt1;
-		d4->vertex	= pt2;
-		d5->vertex	= pt0;
+		tmp	= src;
+		src	= dst;
+		dst	= tmp;
+	}
 
-		/* set points halfedges */
-		pt0->he	= d0;
-		pt1->he	= d1;
-		pt2->he	= d2;
+	for( t = 0; t < num_tasks; t++ )
+		tasks[t].src	= src;
 
-		/* next and next -1 setup */
-		d0->next	= d5;
-		d0->prev	= d5;
+	del_run_tasks( tasks, sizeof(del_sort_task_t), num_tasks, del_sort_gather_task );
 
-		d1->next	= d3;
-		d1->prev	= d3;
+	num_duplicates	= 0;
+	for( t = 0; t < num_tasks; t++ )
+		num_duplicates	+= tasks[t].num_duplicates;
 
-		d2->next	= d4;
-		d2->prev	= d4;
+	ctx->del.num_duplicates		= num_duplicates;
+	ctx->del.representatives	= NULL;
+	if( num_duplicates == 0 )
+		return num_points;
 
-		d3->next	= d1;
-		d3->prev	= d1;
+	num_points			= del_sort_unique( ctx, src, num_points );
+	ctx->del.representatives	= ctx->representatives;
 
-		d4->next	= d2;
-		d4->prev	= d2;
+	return num_points;
+}
 
-		d5->next	= d0;
-		d5->prev	= d0;
+/*
+* position of a point on the Hilbert curve of a 2^16 x 2^16 grid
+*/
+static unsigned int del_hilbert_key( unsigned int x, unsigned int y )
+{
+	unsigned int		key	= 0;
+	unsigned int		s, rx, ry, t;
 
-		/* set halfedges pair */
-		d0->pair	= d3;
-		d3->pair	= d0;
+	for( s = 1u << 15; s > 0; s >>= 1 )
+	{
+		rx	= (x & s) != 0;
+		ry	= (y & s) != 0;
+		key	+= s * s * ((3 * rx) ^ ry);
+
+		/* rotate the quadrant so the curve is continuous */
+		if( ry == 0 ) {
+			if( rx == 1 ) {
+				x	= 0xFFFF - x;
+				y	= 0xFFFF - y;
+			}
+			t	= x;
+			x	= y;
+			y	= t;
+		}
+	}
 
-		d1->pair	= d4;
-		d4->pair	= d1;
+	return key;
+}
 
-		d2->pair	= d5;
-		d5->pair	= d2;
+/*
+* position of a point on the Morton (Z order) curve of a 2^16 x 2^16 grid
+*/
+static unsigned int del_morton_key( unsigned int x, unsigned int y )
+{
+	unsigned int		key	= 0;
+	unsigned int		b;
 
-		del->rightmost_he	= d2;
-		del->leftmost_he		= d0;
-	}
+	for( b = 0; b < 16; b++ )
+		key	|= (((x >> b) & 1) << (2 * b)) | (((y >> b) & 1) << (2 * b + 1));
 
-	return 0;
+	return key;
 }
 
 /*
-* remove an edge given a halfedge
+* sort curve keys (in 3 radix passes), with a buffer of the same size
 */
-static void del_remove_edge( halfedge_t *d )
+static void del_sort_curve_keys( del_curve_key_t *keys, del_curve_key_t *tmp, unsigned int num_keys )
 {
-	halfedge_t	*next, *prev, *pair, *orig_pair;
+	unsigned int		count[DEL_RADIX_SIZE];
+	del_curve_key_t		*src	= keys;
+	del_curve_key_t		*dst	= tmp;
+	del_curve_key_t		*t;
+	unsigned int		i, p, b, offset, n;
 
-	orig_pair	= d->pair;
+	for( p = 0; p < 32; p += DEL_RADIX_BITS )
+	{
+		memset(count, 0, sizeof(count));
+		for( i = 0; i < num_keys; i++ )
+			count[(src[i].key >> p) & (DEL_RADIX_SIZE - 1)]++;
 
-	next	= d->next;
-	prev	= d->prev;
-	pair	= d->pair;
+		offset	= 0;
+		for( b = 0; b < DEL_RADIX_SIZE; b++ )
+		{
+			n		= count[b];
+			count[b]	= offset;
+			offset		+= n;
+		}
 
-	assert(next != NULL);
-	assert(prev != NULL);
+		for( i = 0; i < num_keys; i++ )
+			dst[count[(src[i].key >> p) & (DEL_RADIX_SIZE - 1)]++]	= src[i];
 
-	next->prev	= prev;
-	prev->next	= next;
+		t	= src;
+		src	= dst;
+		dst	= t;
+	}
 
+	/* an odd pass count leaves the keys in the buffer */
+	if( src != keys )
+		memcpy(keys, src, num_keys * sizeof(del_curve_key_t));
+}
 
-	/* check to see if we have already removed pair */
-	if( pair )
-		pair->pair	= NULL;
+/*
+* predicates of the contexts (and batches, meshes, one shot builds) created
+* from now on
+*/
+static del_predicates_t	del_predicates	= DEL_DEFAULT_PREDICATES;
 
-	/* check to see if the vertex points to this halfedge */
-	if( d->vertex->he == d )
-		d->vertex->he	= next;
+/*
+* vertex and face order of the contexts created from now on
+*/
+static del_ordering_t	del_ordering	= DEL_ORDERING_SORTED;
 
-	d->vertex	= NULL;
-	d->next		= NULL;
-	d->prev		= NULL;
-	d->pair		= NULL;
+/*
+* the predicates this build can evaluate, closest to the given ones
+*/
+static del_predicates_t del_supported_predicates( del_predicates_t predicates )
+{
+#if !DEL_HAVE_INTEGER_PREDICATES
+	/* no 128 bits integers, the filtered predicates are exact too */
+	if( predicates == DEL_PREDICATES_INTEGER )
+		predicates	= DEL_PREDICATES_FILTERED;
+#endif
+
+#if DEL_HAVE_FILTERED_PREDICATES
+	return predicates;
+#else
+	/* extended precision intermediates break the expansion arithmetic */
+	return (predicates == DEL_PREDICATES_INTEGER) ? predicates : DEL_PREDICATES_LONG_DOUBLE;
+#endif
+}
 
-	next	= orig_pair->next;
-	prev	= orig_pair->prev;
-	pair	= orig_pair->pair;
+void delaunay2d_set_predicates(del_predicates_t predicates) {
+	del_predicates	= del_supported_predicates(predicates);
+}
 
-	assert(next != NULL);
-	assert(prev != NULL);
+del_predicates_t delaunay2d_predicates(void) {
+	return del_predicates;
+}
 
-	next->prev	= prev;
-	prev->next	= next;
+/*
+* exact sum of 2 doubles: a + b = x + y
+*/
+static void two_sum( real a, real b, real *x, real *y )
+{
+	real		bvirt, avirt;
 
+	*x	= a + b;
+	bvirt	= *x - a;
+	avirt	= *x - bvirt;
+	*y	= (a - avirt) + (b - bvirt);
+}
 
-	/* check to see if we have already removed pair */
-	if( pair )
-		pair->pair	= NULL;
+/*
+* exact product of 2 doubles: a * b = x + y
+*/
+static void two_product( real a, real b, real *x, real *y )
+{
+	real		c, ahi, alo, bhi, blo, err1, err2, err3;
 
-	/* check to see if the vertex points to this halfedge */
-	if( orig_pair->vertex->he == orig_pair )
-		orig_pair->vertex->he	= next;
+	*x	= a * b;
 
-	orig_pair->vertex	= NULL;
-	orig_pair->next		= NULL;
-	orig_pair->prev		= NULL;
-	orig_pair->pair		= NULL;
+	c	= DEL_SPLITTER * a;
+	ahi	= c - (c - a);
+	alo	= a - ahi;
 
+	c	= DEL_SPLITTER * b;
+	bhi	= c - (c - b);
+	blo	= b - bhi;
 
-	/* finally free the halfedges */
-	halfedge_free(d);
-	halfedge_free(orig_pair);
+	err1	= *x - (ahi * bhi);
+	err2	= err1 - (alo * bhi);
+	err3	= err2 - (ahi * blo);
+	*y	= (alo * blo) - err3;
 }
 
 /*
-* pass through all the halfedges on the left side and validate them
+* sum of 2 expansions, eliminating zero components (h can't be e or f)
 */
-static halfedge_t* del_valid_left( halfedge_t* b )
+static int expansion_sum( int elen, const real *e, int flen, const real *f, real *h )
 {
-	point2d_t		*g, *d, *u, *v;
-	halfedge_t		*c, *du, *dg;
+	real		q, qnew, hh, enow, fnow;
+	int		eindex, findex, hindex;
 
-	g	= b->vertex;				/* base halfedge point */
-	dg	= b;
+	eindex	= findex = hindex = 0;
+	enow	= e[0];
+	fnow	= f[0];
 
-	d	= b->pair->vertex;			/* pair(halfedge) point */
-	b	= b->next;
+	/* merge the components by increasing magnitude */
+	if( (fnow > enow) == (fnow > -enow) ) {
+		q	= enow;
+		eindex++;
+	} else {
+		q	= fnow;
+		findex++;
+	}
 
-	u	= b->pair->vertex;			/* next(pair(halfedge)) point */
-	du	= b->pair;
+	while( (eindex < elen) || (findex < flen) ) {
+		if( findex >= flen || ((eindex < elen) && ((f[findex] > e[eindex]) == (f[findex] > -e[eindex]))) ) {
+			two_sum(q, e[eindex], &qnew, &hh);
+			eindex++;
+		} else {
+			two_sum(q, f[findex], &qnew, &hh);
+			findex++;
+		}
+		q	= qnew;
+		if( hh != 0.0 )
+			h[hindex++]	= hh;
+	}
 
-	v	= b->next->pair->vertex;	/* pair(next(next(halfedge)) point */
+	if( (q != 0.0) || (hindex == 0) )
+		h[hindex++]	= q;
 
-	if( classify_point_seg(g, d, u) == ON_LEFT )
-	{
-		/* 3 points aren't colinear */
-		/* as long as the 4 points belong to the same circle, do the cleaning */
-		assert( v != u && "1: floating point precision error");
-		while( v != d && v != g && in_circle(g, d, u, v) == INSIDE )
-		{
-			c	= b->next;
-			du	= b->next->pair;
-			del_remove_edge(b);
-			b	= c;
-			u	= du->vertex;
-			v	= b->next->pair->vertex;
-		}
+	return hindex;
+}
 
-		assert( v != u && "2: floating point precision error");
-		if( v != d && v != g && in_circle(g, d, u, v) == ON_CIRCLE )
-		{
-			du	= du->prev;
-			del_remove_edge(b);
-		}
-	} else	/* treat the case where the 3 points are colinear */
-		du		= dg;
+/*
+* product of an expansion by a double, eliminating zero components
+*/
+static int scale_expansion( int elen, const real *e, real b, real *h )
+{
+	real		q, sum, hh, product1, product0;
+	int		eindex, hindex;
+
+	two_product(e[0], b, &q, &hh);
+	hindex	= 0;
+	if( hh != 0.0 )
+		h[hindex++]	= hh;
+
+	for( eindex = 1; eindex < elen; eindex++ ) {
+		two_product(e[eindex], b, &product1, &product0);
+		two_sum(q, product0, &sum, &hh);
+		if( hh != 0.0 )
+			h[hindex++]	= hh;
+		two_sum(product1, sum, &q, &hh);
+		if( hh != 0.0 )
+			h[hindex++]	= hh;
+	}
 
-	assert(du->pair);
-	return du;
+	if( (q != 0.0) || (hindex == 0) )
+		h[hindex++]	= q;
+
+	return hindex;
 }
 
 /*
-* pass through all the halfedges on the right side and validate them
+* exact a * b - c * d as an expansion of at most 4 components
 */
-static halfedge_t* del_valid_right( halfedge_t *b )
+static int two_two_diff( real a, real b, real c, real d, real *h )
 {
-	point2d_t		*rv, *lv, *u, *v;
-	halfedge_t		*c, *dd, *du;
+	real		ab[2], cd[2];
 
-	b	= b->pair;
-	rv	= b->vertex;
-	dd	= b;
-	lv	= b->pair->vertex;
-	b	= b->prev;
-	u	= b->pair->vertex;
-	du	= b->pair;
+	two_product(a, b, &ab[1], &ab[0]);
+	two_product(c, d, &cd[1], &cd[0]);
+	cd[0]	= -cd[0];
+	cd[1]	= -cd[1];
 
-	v	= b->prev->pair->vertex;
+	return expansion_sum(2, ab, 2, cd, h);
+}
 
-	if( classify_point_seg(lv, rv, u) == ON_LEFT )
-	{
+/*
+* exact orientation of (a, b, c)
+*/
+static real orient2d_exact( real ax, real ay, real bx, real by, real cx, real cy )
+{
+	real		aterms[4], bterms[4], cterms[4], v[8], w[12];
+	int		alen, blen, clen, vlen, wlen;
+
+	alen	= two_two_diff(ax, by, ax, cy, aterms);
+	blen	= two_two_diff(bx, cy, bx, ay, bterms);
+	clen	= two_two_diff(cx, ay, cx, by, cterms);
+
+	vlen	= expansion_sum(alen, aterms, blen, bterms, v);
+	wlen	= expansion_sum(vlen, v, clen, cterms, w);
+
+	return w[wlen - 1];
+}
+
+/*
+* orientation of (a, b, c): positive if counterclockwise, negative if
+* clockwise, zero if colinear. The double evaluation is only trusted when
+* it is away from its error bound, otherwise the exact value is computed.
+*/
+static real orient2d_filtered( real ax, real ay, real bx, real by, real cx, real cy )
+{
+	real		detleft, detright, det, detsum, errbound;
+
+	detleft		= (ax - cx) * (by - cy);
+	detright	= (ay - cy) * (bx - cx);
+	det		= detleft - detright;
+
+	if( detleft > 0.0 ) {
+		if( detright <= 0.0 )
+			return det;
+		detsum	= detleft + detright;
+	} else if( detleft < 0.0 ) {
+		if( detright >= 0.0 )
+			return det;
+		detsum	= -detleft - detright;
+	} else
+		return det;
+
+	errbound	= DEL_CCW_ERRBOUND * detsum;
+	if( (det >= errbound) || (-det >= errbound) )
+		return det;
+
+	return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+
+/*
+* lift an expansion to the paraboloid: e * (x^2 + y^2), sign gives its side
+*/
+static int lift_expansion( int elen, const real *e, real x, real y, real sign, real *h )
+{
+	real		t24x[24], t48x[48], t24y[24], t48y[48];
+	int		xlen, ylen;
+
+	xlen	= scale_expansion(elen, e, x, t24x);
+	xlen	= scale_expansion(xlen, t24x, sign * x, t48x);
+	ylen	= scale_expansion(elen, e, y, t24y);
+	ylen	= scale_expansion(ylen, t24y, sign * y, t48y);
+
+	return expansion_sum(xlen, t48x, ylen, t48y, h);
+}
+
+/*
+* exact incircle of (a, b, c, d)
+*/
+static real in_circle_exact( real ax, real ay, real bx, real by, real cx, real cy, real dx, real dy )
+{
+	real		ab[4], bc[4], cd[4], da[4], ac[4], bd[4];
+	real		temp8[8], abc[12], bcd[12], cda[12], dab[12];
+	real		adet[96], bdet[96], cdet[96], ddet[96], abdet[192], cddet[192], deter[384];
+	int		ablen, bclen, cdlen, dalen, aclen, bdlen, templen;
+	int		abclen, bcdlen, cdalen, dablen, alen, blen, clen, dlen, i;
+
+	ablen	= two_two_diff(ax, by, bx, ay, ab);
+	bclen	= two_two_diff(bx, cy, cx, by, bc);
+	cdlen	= two_two_diff(cx, dy, dx, cy, cd);
+	dalen	= two_two_diff(dx, ay, ax, dy, da);
+	aclen	= two_two_diff(ax, cy, cx, ay, ac);
+	bdlen	= two_two_diff(bx, dy, dx, by, bd);
+
+	templen	= expansion_sum(cdlen, cd, dalen, da, temp8);
+	cdalen	= expansion_sum(templen, temp8, aclen, ac, cda);
+	templen	= expansion_sum(dalen, da, ablen, ab, temp8);
+	dablen	= expansion_sum(templen, temp8, bdlen, bd, dab);
+
+	for( i = 0; i < bdlen; i++ )
+		bd[i]	= -bd[i];
+	for( i = 0; i < aclen; i++ )
+		ac[i]	= -ac[i];
+
+	templen	= expansion_sum(ablen, ab, bclen, bc, temp8);
+	abclen	= expansion_sum(templen, temp8, aclen, ac, abc);
+	templen	= expansion_sum(bclen, bc, cdlen, cd, temp8);
+	bcdlen	= expansion_sum(templen, temp8, bdlen, bd, bcd);
+
+	alen	= lift_expansion(bcdlen, bcd, ax, ay, 1.0, adet);
+	blen	= lift_expansion(cdalen, cda, bx, by, -1.0, bdet);
+	clen	= lift_expansion(dablen, dab, cx, cy, 1.0, cdet);
+	dlen	= lift_expansion(abclen, abc, dx, dy, -1.0, ddet);
+
+	ablen	= expansion_sum(alen, adet, blen, bdet, abdet);
+	cdlen	= expansion_sum(clen, cdet, dlen, ddet, cddet);
+	i	= expansion_sum(ablen, abdet, cdlen, cddet, deter);
+
+	return deter[i - 1];
+}
+
+/*
+* incircle of (a, b, c, d): positive if d is inside the circle going through
+* the counterclockwise a, b and c, negative if outside, zero if cocircular.
+* Like orient2d_filtered, the exact value is only computed near zero.
+*/
+static real in_circle_filtered( real ax, real ay, real bx, real by, real cx, real cy, real dx, real dy )
+{
+	real		adx, ady, bdx, bdy, cdx, cdy;
+	real		bdxcdy, cdxbdy, cdxady, adxcdy, adxbdy, bdxady;
+	real		alift, blift, clift, det, permanent, errbound;
+
+	adx	= ax - dx;
+	bdx	= bx - dx;
+	cdx	= cx - dx;
+	ady	= ay - dy;
+	bdy	= by - dy;
+	cdy	= cy - dy;
+
+	bdxcdy	= bdx * cdy;
+	cdxbdy	= cdx * bdy;
+	alift	= adx * adx + ady * ady;
+
+	cdxady	= cdx * ady;
+	adxcdy	= adx * cdy;
+	blift	= bdx * bdx + bdy * bdy;
+
+	adxbdy	= adx * bdy;
+	bdxady	= bdx * ady;
+	clift	= cdx * cdx + cdy * cdy;
+
+	det	= alift * (bdxcdy - cdxbdy)
+		+ blift * (cdxady - adxcdy)
+		+ clift * (adxbdy - bdxady);
+
+	permanent	= (fabs(bdxcdy) + fabs(cdxbdy)) * alift
+			+ (fabs(cdxady) + fabs(adxcdy)) * blift
+			+ (fabs(adxbdy) + fabs(bdxady)) * clift;
+
+	errbound	= DEL_ICC_ERRBOUND * permanent;
+	if( (det > errbound) || (-det > errbound) )
+		return det;
+
+	return in_circle_exact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+#if DEL_HAVE_INTEGER_PREDICATES
+__extension__ typedef __int128	del_int128_t;
+
+/*
+* orientation sign of (a, b, c) for integer coordinates, exact while they are
+* within +/- 2^30 (the products stay below 2^62)
+*/
+static int orient2d_integer( real ax, real ay, real bx, real by, real cx, real cy )
+{
+	int64_t		acx	= (int64_t)ax - (int64_t)cx;
+	int64_t		acy	= (int64_t)ay - (int64_t)cy;
+	int64_t		bcx	= (int64_t)bx - (int64_t)cx;
+	int64_t		bcy	= (int64_t)by - (int64_t)cy;
+	int64_t		det	= acx * bcy - acy * bcx;
+
+	return (det > 0) - (det < 0);
+}
+
+/*
+* incircle sign of (a, b, c, d) for integer coordinates, exact while they are
+* within +/- 2^29: the differences stay below 2^30, the lifts and the minors
+* below 2^61 and the determinant below 2^124
+*/
+static int in_circle_integer( real ax, real ay, real bx, real by, real cx, real cy, real dx, real dy )
+{
+	int64_t		adx	= (int64_t)ax - (int64_t)dx;
+	int64_t		ady	= (int64_t)ay - (int64_t)dy;
+	int64_t		bdx	= (int64_t)bx - (int64_t)dx;
+	int64_t		bdy	= (int64_t)by - (int64_t)dy;
+	int64_t		cdx	= (int64_t)cx - (int64_t)dx;
+	int64_t		cdy	= (int64_t)cy - (int64_t)dy;
+	int64_t		alift	= adx * adx + ady * ady;
+	int64_t		blift	= bdx * bdx + bdy * bdy;
+	int64_t		clift	= cdx * cdx + cdy * cdy;
+	del_int128_t	det;
+
+	det	= (del_int128_t)alift * (bdx * cdy - cdx * bdy)
+		+ (del_int128_t)blift * (cdx * ady - adx * cdy)
+		+ (del_int128_t)clift * (adx * bdy - bdx * ady);
+
+	return (det > 0) - (det < 0);
+}
+#endif
+
+/*
+* classify a point relative to a segment, given by their coordinates
+*/
+static int classify_coords( del_predicates_t predicates, real sx, real sy, real ex, real ey, real px, real py )
+{
+	lreal		se_x, se_y, spt_x, spt_y;
+	lreal		res;
+
+	if( predicates == DEL_PREDICATES_FILTERED ) {
+		res	= orient2d_filtered(sx, sy, ex, ey, px, py);
+		return (res < 0.0) ? ON_RIGHT : ((res > 0.0) ? ON_LEFT : ON_SEG);
+	}
+
+#if DEL_HAVE_INTEGER_PREDICATES
+	if( predicates == DEL_PREDICATES_INTEGER )
+		return -orient2d_integer(sx, sy, ex, ey, px, py);
+#endif
+
+	se_x	= ex - sx;
+	se_y	= ey - sy;
+
+	spt_x	= px - sx;
+	spt_y	= py - sy;
+
+	res	= (( se_x * spt_y ) - ( se_y * spt_x ));
+	if( res < REAL_ZERO )
+		return ON_RIGHT;
+	else if( res > REAL_ZERO )
+		return ON_LEFT;
+
+	return ON_SEG;
+}
+
+/*
+* classify a point relative to a segment
+*/
+static int classify_point_seg( working_set_t *ws, point2d_t *s, point2d_t *e, point2d_t *pt )
+{
+	return classify_coords(ws->predicates, s->x, s->y, e->x, e->y, pt->x, pt->y);
+}
+
+/*
+* classify a point relative to a halfedge, -1 is left, 0 is on, 1 is right
+*/
+static int del_classify_point( working_set_t *ws, unsigned int d, point2d_t *pt )
+{
+	point2d_t		*s, *e;
+
+	s		= HE_VERTEX(ws, d);
+	e		= HE_VERTEX(ws, HE_PAIR(d));
+
+	return classify_point_seg(ws, s, e, pt);
+}
+
+/*
+* test if a point is inside a circle given by 3 points, 1 if inside, 0 if outside
+*/
+static int in_circle( working_set_t *ws, point2d_t *pt0, point2d_t *pt1, point2d_t *pt2, point2d_t *p )
+{
+	// reduce the computational complexity by substracting the last row of the matrix
+	// ref: https://www.cs.cmu.edu/~quake/robust.html
+	lreal	p0p_x, p0p_y, p1p_x, p1p_y, p2p_x, p2p_y, p0p, p1p, p2p, res;
+	mat3_t	m;
+
+	if( ws->predicates == DEL_PREDICATES_FILTERED ) {
+		res	= in_circle_filtered(pt0->x, pt0->y, pt1->x, pt1->y, pt2->x, pt2->y, p->x, p->y);
+		return (res > 0.0) ? INSIDE : ((res < 0.0) ? OUTSIDE : ON_CIRCLE);
+	}
+
+#if DEL_HAVE_INTEGER_PREDICATES
+	if( ws->predicates == DEL_PREDICATES_INTEGER )
+		return in_circle_integer(pt0->x, pt0->y, pt1->x, pt1->y, pt2->x, pt2->y, p->x, p->y);
+#endif
+
+	p0p_x	= pt0->x - p->x;
+	p0p_y	= pt0->y - p->y;
+
+	p1p_x	= pt1->x - p->x;
+	p1p_y	= pt1->y - p->y;
+
+	p2p_x	= pt2->x - p->x;
+	p2p_y	= pt2->y - p->y;
+
+	p0p	= p0p_x * p0p_x + p0p_y * p0p_y;
+	p1p	= p1p_x * p1p_x + p1p_y * p1p_y;
+	p2p	= p2p_x * p2p_x + p2p_y * p2p_y;
+
+	m[0][0]	= p0p_x;
+	m[0][1]	= p0p_y;
+	m[0][2] = p0p;
+
+	m[1][0]	= p1p_x;
+	m[1][1]	= p1p_y;
+	m[1][2] = p1p;
+
+	m[2][0]	= p2p_x;
+	m[2][1]	= p2p_y;
+	m[2][2] = p2p;
+
+	res	= -det3(m);
+
+	if( res < REAL_ZERO )
+		return INSIDE;
+	else if( res > REAL_ZERO )
+		return OUTSIDE;
+
+	return ON_CIRCLE;
+}
+
+/*
+* initialize delaunay segment
+*/
+static int del_init_seg( delaunay_t *del, int start )
+{
+	working_set_t		*ws	= del->ws;
+	unsigned int		d0, d1;
+	point2d_t		*pt0, *pt1;
+
+	/* init delaunay */
+	del->start_point	= start;
+	del->end_point		= start + 1;
+
+	/* setup pt0 and pt1 */
+	pt0			= &(ws->points[start]);
+	pt1			= &(ws->points[start + 1]);
+
+	/* allocate the halfedges and setup them */
+	d0	= halfedge_alloc(ws);
+	d1	= HE_PAIR(d0);
+
+	HE(ws, d0).vertex	= start;
+	HE(ws, d1).vertex	= start + 1;
+
+	HE(ws, d0).next	= HE(ws, d0).prev	= d0;
+	HE(ws, d1).next	= HE(ws, d1).prev	= d1;
+
+	pt0->he	= d0;
+	pt1->he	= d1;
+
+	del->rightmost_he	= d1;
+	del->leftmost_he	= d0;
+
+
+	return 0;
+}
+
+/*
+* initialize delaunay triangle
+*/
+static int del_init_tri( delaunay_t *del, int start )
+{
+	working_set_t		*ws	= del->ws;
+	unsigned int		d0, d1, d2, d3, d4, d5;
+	point2d_t		*pt0, *pt1, *pt2;
+
+	/* initiate delaunay */
+	del->start_point	= start;
+	del->end_point		= start + 2;
+
+	/* setup the points */
+	pt0					= &(ws->points[start]);
+	pt1					= &(ws->points[start + 1]);
+	pt2					= &(ws->points[start + 2]);
+
+	/* collinear points (pt1 in the middle, they are sorted): a chain of 2
+	   edges as linking a segment and a point gives, not a flat triangle */
+	if( classify_point_seg(ws, pt0, pt2, pt1) == ON_SEG )
+	{
+		d0	= halfedge_alloc(ws);
+		d1	= halfedge_alloc(ws);
+		d3	= HE_PAIR(d0);
+		d4	= HE_PAIR(d1);
+
+		HE(ws, d0).vertex	= start;
+		HE(ws, d3).vertex	= start + 1;
+		HE(ws, d1).vertex	= start + 1;
+		HE(ws, d4).vertex	= start + 2;
+
+		HE(ws, d0).next	= HE(ws, d0).prev	= d0;
+		HE(ws, d4).next	= HE(ws, d4).prev	= d4;
+
+		HE(ws, d1).next	= HE(ws, d1).prev	= d3;
+		HE(ws, d3).next	= HE(ws, d3).prev	= d1;
+
+		pt0->he	= d0;
+		pt1->he	= d1;
+		pt2->he	= d4;
+
+		del->rightmost_he	= d4;
+		del->leftmost_he	= d0;
+
+		return 0;
+	}
+
+	/* allocate the 3 edges: (d0, d3), (d1, d4) and (d2, d5) are pairs */
+	d0	= halfedge_alloc(ws);
+	d1	= halfedge_alloc(ws);
+	d2	= halfedge_alloc(ws);
+	d3	= HE_PAIR(d0);
+	d4	= HE_PAIR(d1);
+	d5	= HE_PAIR(d2);
+
+	if( classify_point_seg(ws, pt0, pt2, pt1) == ON_LEFT )	/* first case */
+	{
+		/* set halfedges points */
+		HE(ws, d0).vertex	= start;
+		HE(ws, d1).vertex	= start + 2;
+		HE(ws, d2).vertex	= start + 1;
+
+		HE(ws, d3).vertex	= start + 2;
+		HE(ws, d4).vertex	= start + 1;
+		HE(ws, d5).vertex	= start;
+
+		/* set points halfedges */
+		pt0->he	= d0;
+		pt1->he	= d2;
+		pt2->he	= d1;
+
+		del->rightmost_he	= d1;
+		del->leftmost_he		= d0;
+
+	} else /* 2nd case */
+	{
+		/* set halfedges points */
+		HE(ws, d0).vertex	= start;
+		HE(ws, d1).vertex	= start + 1;
+		HE(ws, d2).vertex	= start + 2;
+
+		HE(ws, d3).vertex	= start + 1;
+		HE(ws, d4).vertex	= start + 2;
+		HE(ws, d5).vertex	= start;
+
+		/* set points halfedges */
+		pt0->he	= d0;
+		pt1->he	= d1;
+		pt2->he	= d2;
+
+		del->rightmost_he	= d2;
+		del->leftmost_he		= d0;
+	}
+
+	/* next and next -1 setup, the same in both cases */
+	HE(ws, d0).next	= d5;
+	HE(ws, d0).prev	= d5;
+
+	HE(ws, d1).next	= d3;
+	HE(ws, d1).prev	= d3;
+
+	HE(ws, d2).next	= d4;
+	HE(ws, d2).prev	= d4;
+
+	HE(ws, d3).next	= d1;
+	HE(ws, d3).prev	= d1;
+
+	HE(ws, d4).next	= d2;
+	HE(ws, d4).prev	= d2;
+
+	HE(ws, d5).next	= d0;
+	HE(ws, d5).prev	= d0;
+
+	return 0;
+}
+
+/*
+* unlink a halfedge from the ring of its vertex
+*/
+static void del_unlink_halfedge( working_set_t *ws, unsigned int d )
+{
+	unsigned int	next, prev;
+	point2d_t	*pt;
+
+	next	= HE(ws, d).next;
+	prev	= HE(ws, d).prev;
+
+	assert(next != DEL_NIL);
+	assert(prev != DEL_NIL);
+
+	HE(ws, next).prev	= prev;
+	HE(ws, prev).next	= next;
+
+	/* check to see if the vertex points to this halfedge */
+	pt	= HE_VERTEX(ws, d);
+	if( pt->he == d )
+		pt->he	= next;
+}
+
+/*
+* remove an edge given a halfedge
+*/
+static void del_remove_edge( working_set_t *ws, unsigned int d )
+{
+	del_unlink_halfedge(ws, d);
+	del_unlink_halfedge(ws, HE_PAIR(d));
+
+	/* finally free the halfedges */
+	halfedge_free(ws, d);
+	ws->used_edges	-= 2;
+}
+
+/*
+* pass through all the halfedges on the left side and validate them
+*/
+static unsigned int del_valid_left( working_set_t *ws, unsigned int b )
+{
+	point2d_t		*g, *d, *u, *v;
+	unsigned int		c, du, dg;
+
+	g	= HE_VERTEX(ws, b);			/* base halfedge point */
+	dg	= b;
+
+	d	= HE_VERTEX(ws, HE_PAIR(b));		/* pair(halfedge) point */
+	b	= HE(ws, b).next;
+
+	u	= HE_VERTEX(ws, HE_PAIR(b));		/* next(pair(halfedge)) point */
+	du	= HE_PAIR(b);
+
+	v	= HE_VERTEX(ws, HE_PAIR(HE(ws, b).next));	/* pair(next(next(halfedge)) point */
+
+	if( classify_point_seg(ws, g, d, u) == ON_LEFT )
+	{
+		/* 3 points aren't colinear */
+		/* as long as the 4 points belong to the same circle, do the cleaning */
 		assert( v != u && "1: floating point precision error");
-		while( v != lv && v != rv && in_circle(lv, rv, u, v) == INSIDE )
+		while( v != d && v != g && in_circle(ws, g, d, u, v) == INSIDE )
 		{
-			c	= b->prev;
-			du	= c->pair;
-			del_remove_edge(b);
+			c	= HE(ws, b).next;
+			du	= HE_PAIR(c);
+			del_remove_edge(ws, b);
 			b	= c;
-			u	= du->vertex;
-			v	= b->prev->pair->vertex;
+			u	= HE_VERTEX(ws, du);
+			v	= HE_VERTEX(ws, HE_PAIR(HE(ws, b).next));
+		}
+
+		assert( v != u && "2: floating point precision error");
+		if( v != d && v != g && in_circle(ws, g, d, u, v) == ON_CIRCLE )
+		{
+			du	= HE(ws, du).prev;
+			del_remove_edge(ws, b);
+		}
+	} else	/* treat the case where the 3 points are colinear */
+		du		= dg;
+
+	return du;
+}
+
+/*
+* pass through all the halfedges on the right side and validate them
+*/
+static unsigned int del_valid_right( working_set_t *ws, unsigned int b )
+{
+	point2d_t		*rv, *lv, *u, *v;
+	unsigned int		c, dd, du;
+
+	b	= HE_PAIR(b);
+	rv	= HE_VERTEX(ws, b);
+	dd	= b;
+	lv	= HE_VERTEX(ws, HE_PAIR(b));
+	b	= HE(ws, b).prev;
+	u	= HE_VERTEX(ws, HE_PAIR(b));
+	du	= HE_PAIR(b);
+
+	v	= HE_VERTEX(ws, HE_PAIR(HE(ws, b).prev));
+
+	if( classify_point_seg(ws, lv, rv, u) == ON_LEFT )
+	{
+		assert( v != u && "1: floating point precision error");
+		while( v != lv && v != rv && in_circle(ws, lv, rv, u, v) == INSIDE )
+		{
+			c	= HE(ws, b).prev;
+			du	= HE_PAIR(c);
+			del_remove_edge(ws, b);
+			b	= c;
+			u	= HE_VERTEX(ws, du);
+			v	= HE_VERTEX(ws, HE_PAIR(HE(ws, b).prev));
+		}
+
+		assert( v != u && "1: floating point precision error");
+		if( v != lv && v != rv && in_circle(ws, lv, rv, u, v) == ON_CIRCLE )
+		{
+			du	= HE(ws, du).next;
+			del_remove_edge(ws, b);
+		}
+	} else
+		du	= dd;
+
+	return du;
+}
+
+
+/*
+* validate a link
+*/
+static unsigned int del_valid_link( working_set_t *ws, unsigned int b )
+{
+	point2d_t	*g, *g_p, *d, *d_p;
+	unsigned int	gd, dd, new_gd, new_dd;
+	int		a;
+
+	g	= HE_VERTEX(ws, b);
+	gd	= del_valid_left(ws, b);
+	g_p	= HE_VERTEX(ws, gd);
+
+	d	= HE_VERTEX(ws, HE_PAIR(b));
+	dd	= del_valid_right(ws, b);
+	d_p	= HE_VERTEX(ws, dd);
+
+	if( g != g_p && d != d_p ) {
+		a	= in_circle(ws, g, d, g_p, d_p);
+
+		if( a != ON_CIRCLE ) {
+			if( a == INSIDE ) {
+				g_p	= g;
+				gd	= b;
+			} else {
+				d_p = d;
+				dd	= HE_PAIR(b);
+			}
+		}
+	}
+
+	/* create the 2 halfedges */
+	new_gd	= halfedge_alloc(ws);
+	new_dd	= HE_PAIR(new_gd);
+
+	/* setup new_gd and new_dd */
+
+	HE(ws, new_gd).vertex	= HE(ws, gd).vertex;
+	HE(ws, new_gd).prev	= gd;
+	HE(ws, new_gd).next	= HE(ws, gd).next;
+	HE(ws, HE(ws, gd).next).prev	= new_gd;
+	HE(ws, gd).next		= new_gd;
+
+	HE(ws, new_dd).vertex	= HE(ws, dd).vertex;
+	HE(ws, new_dd).prev	= HE(ws, dd).prev;
+	HE(ws, HE(ws, dd).prev).next	= new_dd;
+	HE(ws, new_dd).next	= dd;
+	HE(ws, dd).prev		= new_dd;
+
+	return new_gd;
+}
+
+/*
+* find the lower tangent between the two delaunay, going from left to right (returns the left half edge)
+*/
+static unsigned int del_get_lower_tangent( delaunay_t *left, delaunay_t *right )
+{
+	working_set_t	*ws	= left->ws;
+	point2d_t	*pl, *pr;
+	unsigned int	right_d, left_d, new_ld, new_rd;
+	int		sl, sr;
+
+	left_d	= left->rightmost_he;
+	right_d	= right->leftmost_he;
+
+	do {
+		pl		= HE_VERTEX(ws, HE_PAIR(HE(ws, left_d).prev));
+		pr		= HE_VERTEX(ws, HE_PAIR(right_d));
+
+		if( (sl = classify_point_seg(ws, HE_VERTEX(ws, left_d), HE_VERTEX(ws, right_d), pl)) == ON_RIGHT ) {
+			left_d	= HE_PAIR(HE(ws, left_d).prev);
+		}
+
+		if( (sr = classify_point_seg(ws, HE_VERTEX(ws, left_d), HE_VERTEX(ws, right_d), pr)) == ON_RIGHT ) {
+			right_d	= HE(ws, HE_PAIR(right_d)).next;
+		}
+
+	} while( sl == ON_RIGHT || sr == ON_RIGHT );
+
+	/* create the 2 halfedges */
+	new_ld	= halfedge_alloc(ws);
+	new_rd	= HE_PAIR(new_ld);
+
+	/* setup new_gd and new_dd */
+	HE(ws, new_ld).vertex	= HE(ws, left_d).vertex;
+	HE(ws, new_ld).prev	= HE(ws, left_d).prev;
+	HE(ws, HE(ws, left_d).prev).next	= new_ld;
+	HE(ws, new_ld).next	= left_d;
+	HE(ws, left_d).prev	= new_ld;
+
+	HE(ws, new_rd).vertex	= HE(ws, right_d).vertex;
+	HE(ws, new_rd).prev	= HE(ws, right_d).prev;
+	HE(ws, HE(ws, right_d).prev).next	= new_rd;
+	HE(ws, new_rd).next	= right_d;
+	HE(ws, right_d).prev	= new_rd;
+
+	return new_ld;
+}
+
+/*
+* link the 2 delaunay together
+*/
+static void del_link( delaunay_t *result, delaunay_t *left, delaunay_t *right )
+{
+	working_set_t		*ws	= left->ws;
+	point2d_t		*u, *v, *ml, *mr;
+	unsigned int		base;
+
+	assert( left->ws == right->ws );
+
+	/* save the most right point and the most left point */
+	ml		= HE_VERTEX(ws, left->leftmost_he);
+	mr		= HE_VERTEX(ws, right->rightmost_he);
+
+	base		= del_get_lower_tangent(left, right);
+
+	u		= HE_VERTEX(ws, HE_PAIR(HE(ws, base).next));
+	v		= HE_VERTEX(ws, HE_PAIR(HE(ws, HE_PAIR(base)).prev));
+
+	while( del_classify_point(ws, base, u) == ON_LEFT ||
+	       del_classify_point(ws, base, v) == ON_LEFT )
+	{
+		base	= del_valid_link(ws, base);
+		u	= HE_VERTEX(ws, HE_PAIR(HE(ws, base).next));
+		v	= HE_VERTEX(ws, HE_PAIR(HE(ws, HE_PAIR(base)).prev));
+	}
+
+	right->rightmost_he	= mr->he;
+	left->leftmost_he	= ml->he;
+
+	/* TODO: this part is not needed, and can be optimized */
+	while( del_classify_point( ws, right->rightmost_he, HE_VERTEX(ws, HE_PAIR(HE(ws, right->rightmost_he).prev)) ) == ON_RIGHT )
+	       right->rightmost_he	= HE(ws, right->rightmost_he).prev;
+
+	while( del_classify_point( ws, left->leftmost_he, HE_VERTEX(ws, HE_PAIR(HE(ws, left->leftmost_he).prev)) ) == ON_RIGHT )
+	       left->leftmost_he	= HE(ws, left->leftmost_he).prev;
+
+	result->leftmost_he		= left->leftmost_he;
+	result->rightmost_he		= right->rightmost_he;
+	result->ws			= left->ws;
+	result->start_point		= left->start_point;
+	result->end_point		= right->end_point;
+}
+
+/*
+* divide and conquer delaunay
+*/
+void del_divide_and_conquer( delaunay_t *del, int start, int end )
+{
+	delaunay_t	left, right;
+	int			i, n;
+
+	n		= (end - start + 1);
+
+	if( n > 3 ) {
+		i		= (n / 2) + (n & 1);
+		left.ws			= del->ws;
+		right.ws		= del->ws;
+		del_divide_and_conquer( &left, start, start + i - 1 );
+		del_divide_and_conquer( &right, start + i, end );
+		del_link( del, &left, &right );
+	} else {
+		if( n == 3 ) {
+			del_init_tri( del, start );
+		} else {
+			if( n == 2 ) {
+				del_init_seg( del, start );
+			}
+		}
+	}
+}
+
+/*
+* a half of the divide and conquer built on its own thread
+*/
+typedef struct {
+	delaunay_t		*del;
+	int			start;
+	int			end;
+	unsigned int		num_threads;
+} del_task_t;
+
+static void del_parallel_divide_and_conquer( delaunay_t *del, int start, int end, unsigned int num_threads );
+
+static void* del_task_run( void *arg )
+{
+	del_task_t		*task	= (del_task_t*)arg;
+
+	del_parallel_divide_and_conquer( task->del, task->start, task->end, task->num_threads );
+	return NULL;
+}
+
+/*
+* give each half its own slice of the parent working set: a triangulation
+* of k points never holds more than 6k halfedges at a time, so the 2 halves
+* can allocate concurrently without ever touching each other slice
+*/
+static void del_split_working_set( working_set_t *ws, working_set_t *left, working_set_t *right, unsigned int num_left )
+{
+	assert( ws->free_edge == DEL_NIL );
+
+	*left		= *ws;
+	*right		= *ws;
+
+	left->max_edge		= ws->num_edges + 2 * 3 * num_left;
+	right->num_edges	= left->max_edge;
+}
+
+/*
+* hand the 2 slices back to the parent working set once both halves are built
+*/
+static void del_join_working_sets( working_set_t *ws, working_set_t *left, working_set_t *right )
+{
+	unsigned int		e, sig;
+
+	/* the parent goes on allocating from the end of the right slice */
+	ws->num_edges	= right->num_edges;
+	ws->free_edge	= right->free_edge;
+	ws->used_edges	= left->used_edges + right->used_edges;
+
+	/* the unused end of the left slice and its free list are recycled */
+	for( e = left->num_edges; e < left->max_edge; e += 2 )
+		halfedge_free(ws, e);
+
+	e	= left->free_edge;
+	while( e != DEL_NIL )
+	{
+		sig	= HE(ws, e).next;
+		halfedge_free(ws, e);
+		e	= sig;
+	}
+}
+
+/*
+* divide and conquer delaunay, building the 2 halves concurrently while
+* they are big enough and threads are left
+*/
+static void del_parallel_divide_and_conquer( delaunay_t *del, int start, int end, unsigned int num_threads )
+{
+	delaunay_t	left, right;
+	working_set_t	lws, rws;
+	del_task_t	task;
+	pthread_t	thread;
+	int		i, n;
+
+	n		= (end - start + 1);
+
+	if( num_threads < 2 || n < DEL_PARALLEL_CUTOFF ) {
+		del_divide_and_conquer( del, start, end );
+		return;
+	}
+
+	i		= (n / 2) + (n & 1);
+
+	del_split_working_set( del->ws, &lws, &rws, i );
+	left.ws		= &lws;
+	right.ws	= &rws;
+
+	task.del		= &left;
+	task.start		= start;
+	task.end		= start + i - 1;
+	task.num_threads	= num_threads / 2;
+
+	if( pthread_create(&thread, NULL, del_task_run, &task) != 0 ) {
+		/* no more threads: build the left half here */
+		del_task_run( &task );
+		del_parallel_divide_and_conquer( &right, start + i, end, num_threads - num_threads / 2 );
+	} else {
+		del_parallel_divide_and_conquer( &right, start + i, end, num_threads - num_threads / 2 );
+		pthread_join( thread, NULL );
+	}
+
+	del_join_working_sets( del->ws, &lws, &rws );
+	left.ws		= del->ws;
+	right.ws	= del->ws;
+
+	del_link( del, &left, &right );
+}
+
+/*
+* the faces of a range of vertices, built on their own thread
+*/
+typedef struct {
+	delaunay_t		*del;
+	unsigned int		*out;			/* flat faces buffer, NULL to only count */
+	unsigned int		start;			/* first vertex */
+	unsigned int		end;			/* last vertex + 1 */
+	unsigned int		first_face;		/* index of the first face of the range */
+	unsigned int		offset;			/* offset of the first face of the range in out */
+	unsigned int		num_faces;		/* face count of the range */
+	unsigned int		size;			/* flat size of the range faces */
+} del_faces_task_t;
+
+/*
+* walk the face of a halfedge, recording it as face f in out and in the faces
+* (when given). he_face is left to del_label_faces_task_run()
+*/
+static unsigned int build_halfedge_face( working_set_t *ws, unsigned int d, unsigned int f, unsigned int *out )
+{
+	unsigned int	curr, num_verts;
+
+	curr		= d;
+	num_verts	= 0;
+	do {
+		if( out != NULL )
+			out[num_verts + 1]	= HE_VERTEX(ws, curr)->idx;
+		num_verts++;
+		curr	= HE(ws, HE_PAIR(curr)).prev;
+	} while( curr != d );
+
+	if( out != NULL ) {
+		out[0]			= num_verts;
+		ws->faces[f].he		= d;
+		ws->faces[f].num_verts	= num_verts;
+	}
+
+	return num_verts;
+}
+
+/*
+* test if a vertex halfedge is the one building its face: inner faces are
+* built from their lowest vertex. When the points are sorted, inner faces
+* being convex, it is the only one whose 2 neighbours on the face are higher,
+* the other vertices of larger faces are only checked for the other orders.
+* This needs no visited flags, so vertex ranges can build their faces
+* concurrently: he_face only holds the external face marks, and stays read
+* only until the faces are built
+*/
+static int del_owns_face( working_set_t *ws, unsigned int d, unsigned int v )
+{
+	unsigned int	last	= HE_PAIR(HE(ws, d).next);	/* arriving at v on the face */
+	unsigned int	curr;
+
+	if( HE(ws, HE_PAIR(d)).vertex < v || HE(ws, last).vertex < v ||
+	    ws->he_face[d] != DEL_NIL )	/* external face */
+		return 0;
+
+	if( ws->ordering != DEL_ORDERING_SORTED ) {
+		for( curr = HE_FACE_NEXT(ws, HE_FACE_NEXT(ws, d)); curr != last; curr = HE_FACE_NEXT(ws, curr) )
+			if( HE(ws, curr).vertex < v )
+				return 0;
+	}
+
+	return 1;
+}
+
+static void* del_faces_task_run( void *arg )
+{
+	del_faces_task_t	*task	= (del_faces_task_t*)arg;
+	working_set_t		*ws	= task->del->ws;
+	unsigned int		v, curr, f, j;
+
+	f	= task->first_face;
+	j	= task->offset;
+
+	for( v = task->start; v < task->end; v++ )
+	{
+		/* removed mesh points have no halfedge */
+		curr	= ws->points[v].he;
+		if( curr == DEL_NIL )
+			continue;
+
+		do {
+			if( del_owns_face(ws, curr, v) ) {
+				j	+= build_halfedge_face(ws, curr, f, task->out ? task->out + j : NULL) + 1;
+				f++;
+			}
+			curr	= HE(ws, curr).next;
+		} while( curr != ws->points[v].he );
+	}
+
+	task->num_faces	= f - task->first_face;
+	task->size	= j - task->offset;
+
+	return NULL;
+}
+
+/*
+* record the face of each halfedge of a range of faces. This is a pass of its
+* own: del_owns_face() reads he_face while the faces are built, so no thread
+* writes it then
+*/
+static void* del_label_faces_task_run( void *arg )
+{
+	del_faces_task_t	*task	= (del_faces_task_t*)arg;
+	working_set_t		*ws	= task->del->ws;
+	unsigned int		f, curr;
+
+	for( f = task->first_face; f < task->first_face + task->num_faces; f++ )
+	{
+		curr	= ws->faces[f].he;
+		do {
+			ws->he_face[curr]	= f;
+			curr	= HE_FACE_NEXT(ws, curr);
+		} while( curr != ws->faces[f].he );
+	}
+
+	return NULL;
+}
+
+/*
+* mark the halfedges of the external face as face 0, the others DEL_NIL.
+* Returns the length of the external face
+*/
+static unsigned int del_mark_external( delaunay_t *del )
+{
+	working_set_t		*ws	= del->ws;
+	unsigned int		curr, n;
+
+	memset(ws->he_face, 0xFF, ws->num_edges * sizeof(unsigned int));
+
+	curr	= HE_PAIR(del->rightmost_he);
+	n	= 0;
+	do {
+		ws->he_face[curr]	= 0;
+		n++;
+		curr	= HE_FACE_NEXT(ws, curr);
+	} while( curr != HE_PAIR(del->rightmost_he) );
+
+	return n;
+}
+
+/*
+* mark the external face, then count the faces of each vertex range to know
+* where they go. The count can't come from Euler's formula: when the long
+* double predicates fail, the mesh may be split in several components, and
+* each extra component has its own external face. Returns the flat size
+*/
+static unsigned int del_count_faces( delaunay_t *del, del_faces_task_t *tasks, unsigned int *num_tasks, unsigned int num_threads )
+{
+	unsigned int		num_verts, chunk, f, j, t;
+
+	num_verts	= del->end_point - del->start_point + 1;
+
+	/* the external face is face 0 */
+	j	= del_mark_external( del ) + 1;
+
+	num_threads	= (num_verts < DEL_PARALLEL_CUTOFF) ? 1 : num_threads;
+	if( num_threads > DEL_MAX_THREADS )
+		num_threads	= DEL_MAX_THREADS;
+	chunk		= (num_verts + num_threads - 1) / num_threads;
+
+	for( t = 0; t < num_threads; t++ )
+	{
+		tasks[t].del		= del;
+		tasks[t].out		= NULL;
+		tasks[t].start		= del->start_point + ((t * chunk < num_verts) ? t * chunk : num_verts);
+		tasks[t].end		= del->start_point + (((t + 1) * chunk < num_verts) ? (t + 1) * chunk : num_verts);
+		tasks[t].first_face	= 0;
+		tasks[t].offset		= 0;
+	}
+
+	del_run_tasks( tasks, sizeof(del_faces_task_t), num_threads, del_faces_task_run );
+
+	f	= 1;
+	for( t = 0; t < num_threads; t++ )
+	{
+		tasks[t].first_face	= f;
+		tasks[t].offset		= j;
+		f	+= tasks[t].num_faces;
+		j	+= tasks[t].size;
+	}
+
+	*num_tasks	= num_threads;
+	del->num_faces	= f;
+
+	return j;
+}
+
+/*
+* build the faces counted by del_count_faces(), and write them to the flat
+* faces buffer on the way. The working set faces must hold del->num_faces
+* faces
+*/
+static void del_build_faces( delaunay_t *del, del_faces_task_t *tasks, unsigned int num_tasks, unsigned int *out )
+{
+	working_set_t		*ws	= del->ws;
+	unsigned int		t;
+
+	build_halfedge_face(ws, HE_PAIR(del->rightmost_he), 0, out);
+
+	for( t = 0; t < num_tasks; t++ )
+		tasks[t].out	= out;
+
+	del_run_tasks( tasks, sizeof(del_faces_task_t), num_tasks, del_faces_task_run );
+	del_run_tasks( tasks, sizeof(del_faces_task_t), num_tasks, del_label_faces_task_run );
+
+	del->faces	= ws->faces;
+}
+
+/*
+* thread count of the contexts created from now on, 0 means all the online
+* processors
+*/
+static unsigned int	del_num_threads	= 1;
+
+/*
+* thread count of a setting
+*/
+static unsigned int del_threads( unsigned int num_threads )
+{
+	long		n;
+
+	if( num_threads != 0 )
+		return num_threads;
+
+	n	= sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (unsigned int)n : 1;
+}
+
+void delaunay2d_set_num_threads(unsigned int num_threads) {
+	del_num_threads	= num_threads;
+}
+
+unsigned int delaunay2d_num_threads(void) {
+	return del_threads(del_num_threads);
+}
+
+/*
+* setup an empty context, with the process wide settings
+*/
+static void del_context_init( delaunay2d_context_t *ctx )
+{
+	memset(ctx, 0, sizeof(delaunay2d_context_t));
+
+	ctx->predicates		= del_predicates;
+	ctx->ordering		= del_ordering;
+	ctx->num_threads	= del_num_threads;
+}
+
+delaunay2d_context_t* delaunay2d_context_create(void) {
+	delaunay2d_context_t*	ctx	= (delaunay2d_context_t*)malloc(sizeof(delaunay2d_context_t));
+	assert( NULL != ctx );
+
+	del_context_init( ctx );
+	return ctx;
+}
+
+void delaunay2d_context_set_num_threads(delaunay2d_context_t* ctx, unsigned int num_threads) {
+	ctx->num_threads	= num_threads;
+}
+
+void delaunay2d_context_set_predicates(delaunay2d_context_t* ctx, del_predicates_t predicates) {
+	ctx->predicates	= del_supported_predicates(predicates);
+}
+
+void delaunay2d_context_set_ordering(delaunay2d_context_t* ctx, del_ordering_t ordering) {
+	ctx->ordering	= ordering;
+}
+
+/*
+* free the context buffers, but not the context itself
+*/
+static void del_context_free( delaunay2d_context_t *ctx )
+{
+	free(ctx->points);
+	free(ctx->scratch);
+	free(ctx->tasks);
+	free(ctx->faces);
+	free(ctx->he_face);
+	free(ctx->curve_keys);
+	free(ctx->curve_points);
+	free(ctx->curve_edges);
+	free(ctx->del.points);
+	free(ctx->del.faces);
+	free(ctx->indices);
+	free(ctx->representatives);
+	free(ctx->tdel.points);
+	free(ctx->tdel.tris);
+	free(ctx->vor.vertices);
+	free(ctx->vor.offsets);
+	free(ctx->vor.cells);
+	free(ctx->vor.rays);
+	free(ctx->adj.offsets);
+	free(ctx->adj.neighbors);
+}
+
+void delaunay2d_context_release(delaunay2d_context_t* ctx) {
+	del_context_free( ctx );
+	free(ctx);
+}
+
+#ifdef DEL_STATS
+void delaunay2d_context_stats(delaunay2d_context_t* ctx, del_stats_t* stats) {
+	*stats	= ctx->stats;
+}
+#endif
+
+/*
+* order of the vertices, and of the faces, of the builds
+*/
+void delaunay2d_set_ordering(del_ordering_t ordering) {
+	del_ordering	= ordering;
+}
+
+del_ordering_t delaunay2d_ordering(void) {
+	return del_ordering;
+}
+
+/*
+* renumber the vertices of a mesh along the selected curve, and lay its edges
+* out vertex after vertex in that order, each one with its lowest vertex. The
+* faces are then built, and written, along the curve. When indices is given,
+* the faces take the curve index of the vertices and indices the input index
+* of each one. The edge map goes to he_face, the faces build rewrites it
+*/
+static void del_curve_layout( delaunay2d_context_t *ctx, delaunay_t *del, working_set_t *ws, unsigned int *indices )
+{
+	unsigned int		n	= del->end_point - del->start_point + 1;
+	const point2d_t		*pts	= ws->points;
+	del_curve_key_t		*keys, *rank;
+	unsigned int		*map;
+	real			min_y, max_y, sx, sy;
+	unsigned int		i, v, h, e, x, y, num_edges;
+
+	ctx->curve_keys	= (del_curve_key_t*)del_reserve(ctx->curve_keys, &ctx->max_curve_keys, 2 * n, sizeof(del_curve_key_t));
+	keys		= ctx->curve_keys;
+	rank		= ctx->curve_keys + n;
+
+	/* the points are sorted on x */
+	min_y	= max_y	= pts[0].y;
+	for( i = 1; i < n; i++ )
+	{
+		min_y	= pts[i].y < min_y ? pts[i].y : min_y;
+		max_y	= pts[i].y > max_y ? pts[i].y : max_y;
+	}
+
+	sx	= (pts[n - 1].x > pts[0].x) ? 65535.0 / (pts[n - 1].x - pts[0].x) : 0.0;
+	sy	= (max_y > min_y) ? 65535.0 / (max_y - min_y) : 0.0;
+
+	for( i = 0; i < n; i++ )
+	{
+		x		= (unsigned int)((pts[i].x - pts[0].x) * sx);
+		y		= (unsigned int)((pts[i].y - min_y) * sy);
+		keys[i].key	= (ctx->ordering == DEL_ORDERING_MORTON) ? del_morton_key(x, y) : del_hilbert_key(x, y);
+		keys[i].idx	= i;
+	}
+
+	del_sort_curve_keys( keys, rank, n );
+
+	/* the sort buffer keeps the new index of each vertex */
+	for( i = 0; i < n; i++ )
+		rank[keys[i].idx].idx	= i;
+
+	map	= ws->he_face	= ctx->he_face	= (unsigned int*)del_reserve(ctx->he_face, &ctx->max_he_face, ws->num_edges, sizeof(unsigned int));
+	memset(map, 0xFF, ws->num_edges * sizeof(unsigned int));
+
+	num_edges	= 0;
+	for( i = 0; i < n; i++ )
+	{
+		v	= keys[i].idx;
+		h	= pts[v].he;
+		do {
+			if( rank[HE(ws, HE_PAIR(h)).vertex].idx > i ) {
+				map[h]		= num_edges;
+				map[HE_PAIR(h)]	= num_edges + 1;
+				num_edges	+= 2;
+			}
+			h	= HE(ws, h).next;
+		} while( h != pts[v].he );
+	}
+
+	/* the new mesh goes to the curve buffers, the freed halfedges are left behind */
+	ctx->curve_edges	= (halfedge_t*)del_reserve(ctx->curve_edges, &ctx->max_curve_edges, num_edges, sizeof(halfedge_t));
+	for( h = 0; h < ws->num_edges; h++ )
+	{
+		e	= map[h];
+		if( e == DEL_NIL )
+			continue;
+
+		ctx->curve_edges[e].vertex	= rank[HE(ws, h).vertex].idx;
+		ctx->curve_edges[e].next	= map[HE(ws, h).next];
+		ctx->curve_edges[e].prev	= map[HE(ws, h).prev];
+	}
+
+	ctx->curve_points	= (point2d_t*)del_reserve(ctx->curve_points, &ctx->max_curve_points, n, sizeof(point2d_t));
+	for( i = 0; i < n; i++ )
+	{
+		ctx->curve_points[i]	= pts[keys[i].idx];
+		ctx->curve_points[i].he	= map[ctx->curve_points[i].he];
+	}
+
+	/* renumbered output: the faces take the curve index, indices keeps the input one */
+	if( indices ) {
+		for( i = 0; i < n; i++ )
+		{
+			indices[i]			= ctx->curve_points[i].idx;
+			ctx->curve_points[i].idx	= i;
+		}
+	}
+
+	del->rightmost_he	= map[del->rightmost_he];
+	del->leftmost_he	= map[del->leftmost_he];
+
+	ws->points		= ctx->curve_points;
+	ws->edges		= ctx->curve_edges;
+	ws->max_edge		= num_edges;
+	ws->num_edges		= num_edges;
+	ws->used_edges		= num_edges;
+	ws->free_edge		= DEL_NIL;
+}
+
+/*
+* sort the points and build their halfedge mesh with the context buffers, the
+* scratch holds the 2 sort key buffers, then the halfedges arena. Returns the
+* number of vertices, the duplicates are left out
+*/
+static unsigned int del_context_mesh( delaunay2d_context_t *ctx, const del_point2d_t *points, unsigned int num_points, unsigned int num_threads, delaunay_t *del, working_set_t *ws )
+{
+	ctx->scratch	= del_reserve(ctx->scratch, &ctx->max_scratch, num_points, DEL_SCRATCH_SIZE);
+
+	num_points	= del_sort_points( ctx, points, num_points, num_threads );
+	DEL_STATS_PHASE(ctx, sort);
+
+	if( num_points >= 3 ) {
+		/* all the halfedges are taken from a single pre-sized arena */
+		del_init_working_set( ws, ctx, num_points );
+		del->ws	= ws;
+
+		del_parallel_divide_and_conquer( del, 0, num_points - 1, num_threads );
+		DEL_STATS_PHASE(ctx, divide_and_conquer);
+	}
+
+	return num_points;
+}
+
+/*
+* build the faces of a point set with the context buffers, into out when given
+* (of delaunay2d_faces_size()) or the context faces otherwise. With renumber,
+* a curve ordering renumbers the face vertices, del.indices maps them back to
+* the input points (NULL when the faces keep the input indices). The halfedges
+* stay in ctx->ws until the next build. Returns the flat size of the faces,
+* DEL_NIL (and no face) when they don't fit in out
+*/
+static unsigned int del_context_build( delaunay2d_context_t *ctx, const del_point2d_t *points, unsigned int num_points, unsigned int num_threads, unsigned int *out, int renumber )
+{
+	delaunay_t		del;
+	working_set_t		*ws	= &ctx->ws;
+	del_faces_task_t	tasks[DEL_MAX_THREADS];
+	unsigned int		num_tasks, num_verts, size;
+
+	ctx->del.num_faces	= 0;
+	ctx->del.indices	= NULL;
+
+	num_verts	= del_context_mesh( ctx, points, num_points, num_threads, &del, ws );
+
+	if( num_verts >= 3 ) {
+		if( ctx->ordering != DEL_ORDERING_SORTED ) {
+			if( renumber )
+				ctx->del.indices	= ctx->indices	= (unsigned int*)del_reserve(ctx->indices, &ctx->max_indices, num_verts, sizeof(unsigned int));
+
+			del_curve_layout( ctx, &del, ws, ctx->del.indices );
+		}
+
+		ws->he_face	= ctx->he_face	= (unsigned int*)del_reserve(ctx->he_face, &ctx->max_he_face, ws->num_edges, sizeof(unsigned int));
+		size		= del_count_faces( &del, tasks, &num_tasks, num_threads );
+
+		ws->max_face	= del.num_faces;
+		ws->faces	= ctx->faces	= (face_t*)del_reserve(ctx->faces, &ctx->max_faces, ws->max_face, sizeof(face_t));
+
+		/* a caller buffer is never overrun, even by a mesh split by failed predicates */
+		if( out == NULL )
+			out	= ctx->del.faces	= (unsigned int*)del_reserve(ctx->del.faces, &ctx->max_del_faces, size, sizeof(unsigned int));
+		else if( size > delaunay2d_faces_size(num_points) )
+			return DEL_NIL;
+
+		del_build_faces( &del, tasks, num_tasks, out );
+		ctx->del.num_faces	= del.num_faces;
+		DEL_STATS_PHASE(ctx, faces);
+
+		return size;
+	}
+
+	return 0;
+}
+
+delaunay2d_t* delaunay2d_context_from(delaunay2d_context_t* ctx, del_point2d_t *points, unsigned int num_points) {
+	unsigned int	i;
+
+	DEL_STATS_START(ctx);
+	del_context_build( ctx, points, num_points, del_threads(ctx->num_threads), NULL, 1 );
+
+	/* the points are copied in the order of the face indices, the renumbered
+	   ones leave the duplicates out */
+	ctx->del.num_points	= num_points;
+	ctx->del.points		= (del_point2d_t*)del_reserve(ctx->del.points, &ctx->max_del_points, num_points, sizeof(del_point2d_t));
+	if( ctx->del.indices ) {
+		ctx->del.num_points	= num_points - ctx->del.num_duplicates;
+		for( i = 0; i < ctx->del.num_points; i++ )
+			ctx->del.points[i]	= points[ctx->del.indices[i]];
+	} else
+		memcpy(ctx->del.points, points, sizeof(del_point2d_t) * num_points);
+	DEL_STATS_PHASE(ctx, copy);
+
+	return &ctx->del;
+}
+
+unsigned int delaunay2d_faces_size(unsigned int num_points) {
+	/* E <= 3V - 6, and the faces take 3E - V + 2 */
+	return num_points < 3 ? 0 : 8 * num_points - 16;
+}
+
+unsigned int delaunay2d_context_faces(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points, unsigned int *faces, unsigned int *num_faces) {
+	unsigned int	size;
+
+	DEL_STATS_START(ctx);
+	size		= del_context_build( ctx, points, num_points, del_threads(ctx->num_threads), faces, 0 );
+	*num_faces	= ctx->del.num_faces;
+
+	return size;
+}
+
+const unsigned int* delaunay2d_context_representatives(delaunay2d_context_t* ctx, unsigned int *num_duplicates) {
+	*num_duplicates	= ctx->del.num_duplicates;
+	return ctx->del.representatives;
+}
+
+/*
+*/
+delaunay2d_t* delaunay2d_from(del_point2d_t *points, unsigned int num_points) {
+	delaunay2d_t*		res	= NULL;
+	delaunay2d_context_t	ctx;
+
+	del_context_init( &ctx );
+	delaunay2d_context_from( &ctx, points, num_points );
+
+	/* the result takes the context output buffers */
+	res		= (delaunay2d_t*)malloc(sizeof(delaunay2d_t));
+	assert( NULL != res );
+	*res		= ctx.del;
+	if( num_points < 3 ) {
+		free(res->faces);
+		res->faces	= NULL;
+	}
+
+	ctx.del.points		= NULL;
+	ctx.del.faces		= NULL;
+	ctx.indices		= NULL;
+	ctx.representatives	= NULL;
+	del_context_free( &ctx );
+
+	return res;
+}
+
+void delaunay2d_release(delaunay2d_t *del) {
+	free(del->representatives);
+	free(del->indices);
+	free(del->faces);
+	free(del->points);
+	free(del);
+}
+
+/*
+* a batch worker: a thread of the pool (or the calling thread for the first one)
+* with its own build context, its faces are appended to its own arena (or
+* written to their slot of the caller arena)
+*/
+typedef struct {
+	delaunay2d_batch_t*	batch;
+	unsigned int		index;			/* worker index, 0 is the calling thread */
+	delaunay2d_context_t	ctx;			/* build buffers of the worker */
+	unsigned int*		faces;			/* faces arena */
+	unsigned int		num_faces;		/* used size of the arena */
+	unsigned int		max_faces;		/* capacity of the arena */
+} del_batch_worker_t;
+
+/*
+* a batch job, the jobs are taken biggest first
+*/
+typedef struct {
+	unsigned int		set;			/* point set index */
+	unsigned int		num_points;		/* point set size */
+	unsigned int		worker;			/* worker that built it */
+	unsigned int		offset;			/* faces offset in the worker arena, DEL_NIL when they don't fit the caller arena */
+	unsigned int		representatives;	/* representatives offset in the worker arena, DEL_NIL without duplicates */
+	size_t			slot;			/* offset of the set in the caller arena */
+} del_batch_job_t;
+
+struct delaunay2d_batch_s {
+	pthread_mutex_t		lock;
+	pthread_cond_t		posted;			/* a batch is posted, or the pool quits */
+	pthread_cond_t		done;			/* the pool is through with the batch */
+
+	pthread_t		threads[DEL_MAX_THREADS];
+	del_batch_worker_t*	workers[DEL_MAX_THREADS];
+	unsigned int		num_workers;		/* workers, the calling thread included */
+	unsigned int		num_active;		/* workers of the current batch */
+	unsigned int		num_busy;		/* pool workers still on the current batch */
+	unsigned int		generation;		/* current batch number */
+	int			quit;			/* the pool is shutting down */
+
+	del_predicates_t	predicates;		/* predicates of the builds */
+	del_ordering_t		ordering;		/* vertex and face order of the builds */
+	unsigned int		num_threads;		/* worker count, 0 for all the online processors */
+
+	del_point_set_t*	sets;			/* point sets of the current batch */
+	del_batch_job_t*	jobs;			/* jobs of the current batch */
+	unsigned int		num_jobs;		/* job count */
+	unsigned int		max_jobs;		/* capacity of jobs */
+	unsigned int		next_job;		/* first job not taken yet */
+
+	delaunay2d_t*		results;		/* one result per point set */
+	unsigned int		max_results;		/* capacity of results */
+
+	delaunay2d_t*		out;			/* results of the current batch: results, or the caller ones */
+	unsigned int*		arena;			/* caller arena of the current batch, NULL for the worker arenas */
+};
+
+static int del_batch_job_cmp( const void *a, const void *b )
+{
+	const del_batch_job_t	*ja	= (const del_batch_job_t*)a;
+	const del_batch_job_t	*jb	= (const del_batch_job_t*)b;
+
+	if( ja->num_points != jb->num_points )
+		return ja->num_points > jb->num_points ? -1 : 1;
+
+	return ja->set < jb->set ? -1 : (ja->set > jb->set);
+}
+
+/*
+* build a job straight into its slot of the caller arena: the faces, then the
+* representatives of the points
+*/
+static void del_batch_slot( delaunay2d_batch_t *batch, del_batch_worker_t *w, del_batch_job_t *job )
+{
+	del_point_set_t		*set	= &(batch->sets[job->set]);
+	delaunay2d_t		*res	= &(batch->out[job->set]);
+	unsigned int		*out	= batch->arena + job->slot;
+
+	job->offset	= del_context_build( &w->ctx, set->points, set->num_points, 1, out, 0 );
+	job->worker	= w->index;
+
+	/* failed predicates split the mesh into more faces than the slot holds */
+	if( job->offset == DEL_NIL )
+		return;
+
+	res->num_faces		= w->ctx.del.num_faces;
+	res->faces		= (res->num_faces > 0) ? out : NULL;
+	res->num_duplicates	= w->ctx.del.num_duplicates;
+
+	if( w->ctx.del.representatives != NULL ) {
+		res->representatives	= out + delaunay2d_faces_size(set->num_points);
+		memcpy(res->representatives, w->ctx.del.representatives, set->num_points * sizeof(unsigned int));
+	}
+}
+
+/*
+* take jobs until there is none left, each one is built single threaded
+*/
+static void del_batch_work( delaunay2d_batch_t *batch, del_batch_worker_t *w )
+{
+	del_batch_job_t		*job;
+	del_point_set_t		*set;
+	unsigned int		size, num_reps, *faces;
+
+	w->num_faces	= 0;
+
+	for( ;; )
+	{
+		pthread_mutex_lock(&batch->lock);
+		job	= (batch->next_job < batch->num_jobs) ? &(batch->jobs[batch->next_job++]) : NULL;
+		pthread_mutex_unlock(&batch->lock);
+
+		if( job == NULL )
+			break;
+
+		set	= &(batch->sets[job->set]);
+		DEL_STATS_START(&w->ctx);
+
+		if( batch->arena != NULL ) {
+			del_batch_slot( batch, w, job );
+			continue;
+		}
+
+		/* the flat size of the faces, the representatives follow them */
+		size		= del_context_build( &w->ctx, set->points, set->num_points, 1, NULL, 0 );
+		faces		= w->ctx.del.faces;
+		num_reps	= w->ctx.del.representatives ? set->num_points : 0;
+
+		if( w->num_faces + size + num_reps > w->max_faces ) {
+			w->max_faces	= 2 * (w->num_faces + size + num_reps);
+			w->faces	= (unsigned int*)realloc(w->faces, w->max_faces * sizeof(unsigned int));
+			assert( NULL != w->faces );
+		}
+
+		memcpy(w->faces + w->num_faces, faces, size * sizeof(unsigned int));
+		if( num_reps > 0 )
+			memcpy(w->faces + w->num_faces + size, w->ctx.del.representatives, num_reps * sizeof(unsigned int));
+
+		job->worker		= w->index;
+		job->offset		= w->num_faces;
+		job->representatives	= num_reps ? w->num_faces + size : DEL_NIL;
+		w->num_faces		+= size + num_reps;
+
+		batch->out[job->set].num_faces		= w->ctx.del.num_faces;
+		batch->out[job->set].num_duplicates	= w->ctx.del.num_duplicates;
+	}
+}
+
+static void* del_batch_worker_run( void *arg )
+{
+	del_batch_worker_t	*w	= (del_batch_worker_t*)arg;
+	delaunay2d_batch_t	*batch	= w->batch;
+	unsigned int		generation	= 0;
+
+	pthread_mutex_lock(&batch->lock);
+	for( ;; )
+	{
+		while( !batch->quit && batch->generation == generation )
+			pthread_cond_wait(&batch->posted, &batch->lock);
+
+		if( batch->quit )
+			break;
+
+		generation	= batch->generation;
+		if( w->index >= batch->num_active )
+			continue;
+
+		pthread_mutex_unlock(&batch->lock);
+		del_batch_work( batch, w );
+		pthread_mutex_lock(&batch->lock);
+
+		if( --(batch->num_busy) == 0 )
+			pthread_cond_signal(&batch->done);
+	}
+	pthread_mutex_unlock(&batch->lock);
+
+	return NULL;
+}
+
+static del_batch_worker_t* del_batch_worker_create( delaunay2d_batch_t *batch, unsigned int index )
+{
+	del_batch_worker_t	*w	= (del_batch_worker_t*)malloc(sizeof(del_batch_worker_t));
+	assert( NULL != w );
+
+	memset(w, 0, sizeof(del_batch_worker_t));
+	w->batch	= batch;
+	w->index	= index;
+
+	del_context_init( &w->ctx );
+	w->ctx.predicates	= batch->predicates;
+	w->ctx.ordering		= batch->ordering;
+
+	return w;
+}
+
+delaunay2d_batch_t* delaunay2d_batch_create(void) {
+	delaunay2d_batch_t*	batch	= (delaunay2d_batch_t*)malloc(sizeof(delaunay2d_batch_t));
+	assert( NULL != batch );
+
+	memset(batch, 0, sizeof(delaunay2d_batch_t));
+	batch->predicates	= del_predicates;
+	batch->ordering		= del_ordering;
+	batch->num_threads	= del_num_threads;
+
+	pthread_mutex_init(&batch->lock, NULL);
+	pthread_cond_init(&batch->posted, NULL);
+	pthread_cond_init(&batch->done, NULL);
+
+	/* the calling thread is the first worker */
+	batch->workers[0]	= del_batch_worker_create(batch, 0);
+	batch->num_workers	= 1;
+
+	return batch;
+}
+
+void delaunay2d_batch_release(delaunay2d_batch_t* batch) {
+	unsigned int	i;
+
+	pthread_mutex_lock(&batch->lock);
+	batch->quit	= 1;
+	pthread_cond_broadcast(&batch->posted);
+	pthread_mutex_unlock(&batch->lock);
+
+	for( i = 1; i < batch->num_workers; i++ )
+		pthread_join( batch->threads[i], NULL );
+
+	for( i = 0; i < batch->num_workers; i++ )
+	{
+		del_context_free( &(batch->workers[i]->ctx) );
+		free(batch->workers[i]->faces);
+		free(batch->workers[i]);
+	}
+
+	pthread_cond_destroy(&batch->done);
+	pthread_cond_destroy(&batch->posted);
+	pthread_mutex_destroy(&batch->lock);
+
+	free(batch->jobs);
+	free(batch->results);
+	free(batch);
+}
+
+/*
+* slot of a point set in a caller arena: room for its faces, then for the
+* representatives of its points
+*/
+static size_t del_batch_slot_size( unsigned int num_points )
+{
+	return (size_t)delaunay2d_faces_size(num_points) + num_points;
+}
+
+/*
+* spread the point sets over the workers, into results and the caller arena
+* (NULL for the worker arenas). Returns the count of sets that don't fit the
+* caller arena
+*/
+static unsigned int del_batch_run( delaunay2d_batch_t *batch, del_point_set_t *sets, unsigned int num_sets, delaunay2d_t *results, unsigned int *arena )
+{
+	unsigned int		num_threads	= del_threads(batch->num_threads);
+	unsigned int		i, num_failed;
+	size_t			slot;
+	del_batch_job_t		*job;
+
+	if( num_threads > DEL_MAX_THREADS )
+		num_threads	= DEL_MAX_THREADS;
+	if( num_threads > num_sets )
+		num_threads	= num_sets > 0 ? num_sets : 1;
+
+	/* grow the pool, a worker that can't get a thread is just left out */
+	while( batch->num_workers < num_threads )
+	{
+		del_batch_worker_t	*w	= del_batch_worker_create(batch, batch->num_workers);
+
+		if( pthread_create(&batch->threads[w->index], NULL, del_batch_worker_run, w) != 0 ) {
+			free(w);
+			break;
+		}
+
+		batch->workers[batch->num_workers++]	= w;
+	}
+
+	if( num_threads > batch->num_workers )
+		num_threads	= batch->num_workers;
+
+	batch->jobs	= (del_batch_job_t*)del_reserve(batch->jobs, &batch->max_jobs, num_sets, sizeof(del_batch_job_t));
+
+	for( i = 0, slot = 0; i < num_sets; i++ )
+	{
+		batch->jobs[i].set		= i;
+		batch->jobs[i].num_points	= sets[i].num_points;
+		batch->jobs[i].representatives	= DEL_NIL;
+		batch->jobs[i].slot		= slot;
+		slot	+= del_batch_slot_size(sets[i].num_points);
+
+		results[i].num_points		= sets[i].num_points;
+		results[i].points		= sets[i].points;
+		results[i].num_faces		= 0;
+		results[i].faces		= NULL;
+		results[i].indices		= NULL;
+		results[i].num_duplicates	= 0;
+		results[i].representatives	= NULL;
+	}
+
+	/* biggest jobs first, so the small ones fill the gaps at the end */
+	qsort(batch->jobs, num_sets, sizeof(del_batch_job_t), del_batch_job_cmp);
+
+	pthread_mutex_lock(&batch->lock);
+	batch->sets		= sets;
+	batch->out		= results;
+	batch->arena		= arena;
+	batch->num_jobs		= num_sets;
+	batch->next_job		= 0;
+	batch->num_active	= num_threads;
+	batch->num_busy		= num_threads - 1;
+	batch->generation++;
+	pthread_cond_broadcast(&batch->posted);
+	pthread_mutex_unlock(&batch->lock);
+
+	del_batch_work( batch, batch->workers[0] );
+
+	pthread_mutex_lock(&batch->lock);
+	while( batch->num_busy > 0 )
+		pthread_cond_wait(&batch->done, &batch->lock);
+	pthread_mutex_unlock(&batch->lock);
+
+	num_failed	= 0;
+	if( arena != NULL ) {
+		for( i = 0; i < num_sets; i++ )
+			num_failed	+= (batch->jobs[i].offset == DEL_NIL);
+		return num_failed;
+	}
+
+	/* the arenas don't move anymore, point the results to their faces */
+	for( i = 0; i < num_sets; i++ )
+	{
+		job	= &(batch->jobs[i]);
+		if( results[job->set].num_faces > 0 )
+			results[job->set].faces	= batch->workers[job->worker]->faces + job->offset;
+		if( job->representatives != DEL_NIL )
+			results[job->set].representatives	= batch->workers[job->worker]->faces + job->representatives;
+	}
+
+	return 0;
+}
+
+delaunay2d_t* delaunay2d_batch_from(delaunay2d_batch_t* batch, del_point_set_t* sets, unsigned int num_sets) {
+	batch->results	= (delaunay2d_t*)del_reserve(batch->results, &batch->max_results, num_sets, sizeof(delaunay2d_t));
+	del_batch_run( batch, sets, num_sets, batch->results, NULL );
+
+	return batch->results;
+}
+
+size_t delaunay2d_batch_arena_size(const del_point_set_t* sets, unsigned int num_sets) {
+	size_t		size	= 0;
+	unsigned int	i;
+
+	for( i = 0; i < num_sets; i++ )
+		size	+= del_batch_slot_size(sets[i].num_points);
+
+	return size;
+}
+
+unsigned int delaunay2d_batch_into(delaunay2d_batch_t* batch, del_point_set_t* sets, unsigned int num_sets, delaunay2d_t* results, unsigned int* arena) {
+	return del_batch_run( batch, sets, num_sets, results, arena );
+}
+
+
+/*
+* a persistent mesh: the halfedges of a build, kept alive to be updated. Its
+* inner faces are triangles
+*/
+struct delaunay2d_mesh_s {
+	delaunay2d_context_t	ctx;			/* build buffers, ctx.del.points holds the points in input order */
+	working_set_t		ws;			/* the mesh, in ctx.points and ctx.scratch. Vertex i is point i */
+	unsigned int		hull_he;		/* a halfedge of the external face (DEL_NIL under 3 points) */
+	unsigned int		last_vert;		/* the next point location starts there */
+	int			degenerate;		/* no inner face: under 3 points, or all colinear */
+
+	unsigned char*		removed;		/* removed points, their index is reused by the next insertions */
+	unsigned int		max_removed;		/* capacity of removed */
+	unsigned int*		free_points;		/* indices of the removed points */
+	unsigned int		num_free;		/* removed point count */
+	unsigned int		max_free;		/* capacity of free_points */
+	del_point2d_t*		live;			/* points left when the removed ones are rebuilt */
+	unsigned int		max_live;		/* capacity of live */
+
+	unsigned int*		star;			/* halfedges around the cavity of an insertion or a removal */
+	unsigned int		max_star;		/* capacity of star */
+	unsigned int*		stack;			/* edges left to check for flips, spokes of a removed point */
+	unsigned int		max_stack;		/* capacity of stack */
+};
+
+/*
+* link a halfedge after another one in the ring of its vertex
+*/
+static void del_insert_halfedge( working_set_t *ws, unsigned int d, unsigned int after )
+{
+	HE(ws, d).prev			= after;
+	HE(ws, d).next			= HE(ws, after).next;
+	HE(ws, HE(ws, after).next).prev	= d;
+	HE(ws, after).next		= d;
+}
+
+/*
+* add an edge between the vertices of 2 halfedges of the same face, in that
+* face. Returns the new halfedge leaving the vertex of a
+*/
+static unsigned int del_mesh_connect( working_set_t *ws, unsigned int a, unsigned int b )
+{
+	unsigned int	e	= halfedge_alloc(ws);
+
+	HE(ws, e).vertex		= HE(ws, a).vertex;
+	HE(ws, HE_PAIR(e)).vertex	= HE(ws, b).vertex;
+
+	del_insert_halfedge(ws, e, a);
+	del_insert_halfedge(ws, HE_PAIR(e), b);
+
+	return e;
+}
+
+/*
+* number of vertices on the face on the left of a halfedge
+*/
+static unsigned int del_face_size( working_set_t *ws, unsigned int d )
+{
+	unsigned int	curr	= d;
+	unsigned int	size	= 0;
+
+	do {
+		size++;
+		curr	= HE_FACE_NEXT(ws, curr);
+	} while( curr != d );
+
+	return size;
+}
+
+/*
+* test if the face on the left of a halfedge is an inner triangle: the
+* external face is the only one walked clockwise
+*/
+static int del_mesh_inner( working_set_t *ws, unsigned int d )
+{
+	unsigned int	d1	= HE_FACE_NEXT(ws, d);
+	unsigned int	d2	= HE_FACE_NEXT(ws, d1);
+
+	return HE_FACE_NEXT(ws, d2) == d &&
+	       classify_point_seg(ws, HE_VERTEX(ws, d), HE_VERTEX(ws, d1), HE_VERTEX(ws, d2)) == ON_LEFT;
+}
+
+/*
+* mark the halfedges of the external face in he_face
+*/
+static void del_mesh_mark_hull( delaunay2d_mesh_t *mesh )
+{
+	working_set_t	*ws	= &(mesh->ws);
+	unsigned int	h	= mesh->hull_he;
+
+	memset(ws->he_face, 0xFF, ws->num_edges * sizeof(unsigned int));
+
+	do {
+		ws->he_face[h]	= 0;
+		h		= HE_FACE_NEXT(ws, h);
+	} while( h != mesh->hull_he );
+}
+
+/*
+* test if the face on the left of a halfedge is flat, all its other vertices
+* lying on the halfedge, between its ends
+*/
+static int del_flat_face( working_set_t *ws, unsigned int d )
+{
+	point2d_t	*a	= HE_VERTEX(ws, d);
+	point2d_t	*b	= HE_VERTEX(ws, HE_PAIR(d));
+	point2d_t	*v;
+	unsigned int	curr	= HE_FACE_NEXT(ws, d);
+
+	while( curr != d ) {
+		v	= HE_VERTEX(ws, curr);
+		if( v != b && (classify_point_seg(ws, a, b, v) != ON_SEG ||
+		    v->x < (a->x < b->x ? a->x : b->x) || v->x > (a->x < b->x ? b->x : a->x) ||
+		    v->y < (a->y < b->y ? a->y : b->y) || v->y > (a->y < b->y ? b->y : a->y)) )
+			return 0;
+		curr	= HE_FACE_NEXT(ws, curr);
+	}
+
+	return 1;
+}
+
+/*
+* failed predicates (long double ones on nearly aligned points) can leave flat
+* faces along colinear hull vertices, a hull edge running over them: these
+* edges are removed. Then the faces of more than 3 (cocircular) vertices are
+* split into fans of triangles
+*/
+static void del_mesh_triangulate( delaunay2d_mesh_t *mesh )
+{
+	working_set_t	*ws	= &(mesh->ws);
+	unsigned int	v, d, h, spoke, k, j, num_flat;
+
+	ws->he_face	= mesh->ctx.he_face	= (unsigned int*)del_reserve(mesh->ctx.he_face, &mesh->ctx.max_he_face, ws->num_edges, sizeof(unsigned int));
+	del_mesh_mark_hull( mesh );
+
+	num_flat	= 0;
+	h		= mesh->hull_he;
+	do {
+		if( ws->he_face[HE_PAIR(h)] != 0 && del_flat_face(ws, HE_PAIR(h)) ) {
+			mesh->star	= (unsigned int*)del_grow(mesh->star, &mesh->max_star, num_flat + 1, sizeof(unsigned int));
+			mesh->star[num_flat++]	= h;
+		}
+		h	= HE_FACE_NEXT(ws, h);
+	} while( h != mesh->hull_he );
+
+	for( j = 0; j < num_flat; j++ )
+	{
+		mesh->hull_he	= HE_FACE_NEXT(ws, HE_PAIR(mesh->star[j]));
+		del_remove_edge(ws, mesh->star[j]);
+	}
+
+	if( num_flat > 0 )
+		del_mesh_mark_hull( mesh );
+
+	for( v = 0; v < mesh->ctx.del.num_points; v++ )
+	{
+		d	= ws->points[v].he;
+		if( d == DEL_NIL )
+			continue;
+
+		do {
+			/* the new diagonals only border triangles, so he_face is not read for them */
+			k	= del_face_size(ws, d);
+			if( k > 3 && del_owns_face(ws, d, v) ) {
+				h	= HE_FACE_NEXT(ws, d);
+				spoke	= d;
+				for( j = 2; j + 1 < k; j++ ) {
+					h	= HE_FACE_NEXT(ws, h);
+					spoke	= del_mesh_connect(ws, spoke, h);
+				}
+			}
+			d	= HE(ws, d).next;
+		} while( d != ws->points[v].he );
+	}
+}
+
+/*
+* build the mesh of the points in ctx.del.points that are not removed, with
+* room to grow. The vertices are then moved to the index of their point
+*/
+static void del_mesh_build( delaunay2d_mesh_t *mesh )
+{
+	delaunay2d_context_t	*ctx		= &(mesh->ctx);
+	working_set_t		*ws		= &(mesh->ws);
+	unsigned int		num_points	= ctx->del.num_points;
+	unsigned int		num_live	= num_points - mesh->num_free;
+	const del_point2d_t	*input		= ctx->del.points;
+	unsigned int		i, j, e, num_verts;
+	point2d_t		tmp;
+	delaunay_t		del;
+
+	DEL_STATS_START(ctx);
+
+	ctx->points	= (point2d_t*)del_reserve(ctx->points, &ctx->max_points, num_points + num_points / 2, sizeof(point2d_t));
+	ctx->scratch	= del_reserve(ctx->scratch, &ctx->max_scratch, num_points + num_points / 2, DEL_SCRATCH_SIZE);
+
+	if( mesh->num_free > 0 ) {
+		/* the star keeps the point index of each live point */
+		mesh->live	= (del_point2d_t*)del_reserve(mesh->live, &mesh->max_live, num_live, sizeof(del_point2d_t));
+		mesh->star	= (unsigned int*)del_reserve(mesh->star, &mesh->max_star, num_live, sizeof(unsigned int));
+		for( i = 0, j = 0; i < num_points; i++ )
+		{
+			if( mesh->removed[i] )
+				continue;
+
+			mesh->live[j]	= input[i];
+			mesh->star[j++]	= i;
+		}
+		input	= mesh->live;
+	}
+
+	/* the duplicates are left without halfedge, like the removed points */
+	del_init_working_set( ws, ctx, 0 );
+	num_verts	= del_context_mesh( ctx, input, num_live, del_threads(ctx->num_threads), &del, ws );
+	ws->points	= ctx->points;
+
+	ctx->del.num_duplicates		= 0;
+	ctx->del.representatives	= NULL;
+
+	for( i = 0; i < num_verts; i++ )
+	{
+		ws->points[i].idx	= (mesh->num_free > 0) ? mesh->star[ws->points[i].idx] : ws->points[i].idx;
+		if( num_verts < 3 )
+			ws->points[i].he	= DEL_NIL;
+	}
+
+	for( i = num_verts; i < num_points; i++ )
+		ws->points[i].idx	= DEL_NIL;
+
+	for( e = 0; num_verts >= 3 && e < ws->num_edges; e++ )
+		if( HE(ws, e).vertex != DEL_NIL )
+			HE(ws, e).vertex	= ws->points[HE(ws, e).vertex].idx;
+
+	/* move each point to its index, the removed ones are left without halfedge */
+	for( i = 0; i < num_points; i++ )
+	{
+		while( ws->points[i].idx != DEL_NIL && ws->points[i].idx != i ) {
+			j		= ws->points[i].idx;
+			tmp		= ws->points[j];
+			ws->points[j]	= ws->points[i];
+			ws->points[i]	= tmp;
+		}
+	}
+
+	for( i = 0; i < num_points; i++ )
+	{
+		if( ws->points[i].idx == DEL_NIL ) {
+			ws->points[i].x		= ctx->del.points[i].x;
+			ws->points[i].y		= ctx->del.points[i].y;
+			ws->points[i].he	= DEL_NIL;
+			ws->points[i].idx	= i;
+		}
+	}
+
+	mesh->hull_he		= DEL_NIL;
+	mesh->degenerate	= 1;
+
+	if( num_verts >= 3 ) {
+		ws->max_edge		= 2 * 3 * ctx->max_scratch;
+		mesh->hull_he		= HE_PAIR(del.rightmost_he);
+
+		del_mesh_triangulate( mesh );
+		mesh->degenerate	= !del_mesh_inner(ws, HE_PAIR(mesh->hull_he));
+		mesh->last_vert		= HE(ws, mesh->hull_he).vertex;
+	}
+}
+
+delaunay2d_mesh_t* delaunay2d_mesh_from(del_point2d_t *points, unsigned int num_points) {
+	delaunay2d_mesh_t*	mesh	= (delaunay2d_mesh_t*)malloc(sizeof(delaunay2d_mesh_t));
+	assert( NULL != mesh );
+
+	memset(mesh, 0, sizeof(delaunay2d_mesh_t));
+	del_context_init( &mesh->ctx );
+
+	mesh->ctx.del.num_points	= num_points;
+	mesh->ctx.del.points		= (del_point2d_t*)del_grow(NULL, &mesh->ctx.max_del_points, num_points, sizeof(del_point2d_t));
+	memcpy(mesh->ctx.del.points, points, sizeof(del_point2d_t) * num_points);
+
+	del_mesh_build( mesh );
+
+	return mesh;
+}
+
+void delaunay2d_mesh_release(delaunay2d_mesh_t* mesh) {
+	del_context_free( &(mesh->ctx) );
+	free(mesh->removed);
+	free(mesh->free_points);
+	free(mesh->live);
+	free(mesh->star);
+	free(mesh->stack);
+	free(mesh);
+}
+
+/*
+* walk from the last located vertex to the triangle holding a point. Returns
+* a halfedge of that triangle, or when the point is out of the hull, a hull
+* halfedge (the external face on its left) the point is strictly left of
+*/
+static unsigned int del_mesh_locate( delaunay2d_mesh_t *mesh, point2d_t *p, int *outside )
+{
+	working_set_t	*ws	= &(mesh->ws);
+	unsigned int	d, d1, d2;
+	int		entered	= 0;
+
+	d	= ws->points[mesh->last_vert].he;
+	while( !del_mesh_inner(ws, d) )
+		d	= HE(ws, d).next;
+
+	*outside	= 0;
+	for( ;; ) {
+		/* the point is on the left of the halfedge the walk came through */
+		d1	= HE_FACE_NEXT(ws, d);
+		d2	= HE_FACE_NEXT(ws, d1);
+
+		if( !entered && classify_point_seg(ws, HE_VERTEX(ws, d), HE_VERTEX(ws, d1), p) == ON_RIGHT )
+			d	= HE_PAIR(d);
+		else if( classify_point_seg(ws, HE_VERTEX(ws, d1), HE_VERTEX(ws, d2), p) == ON_RIGHT )
+			d	= HE_PAIR(d1);
+		else if( classify_point_seg(ws, HE_VERTEX(ws, d2), HE_VERTEX(ws, d), p) == ON_RIGHT )
+			d	= HE_PAIR(d2);
+		else
+			return d;
+
+		if( !del_mesh_inner(ws, d) ) {
+			*outside	= 1;
+			return d;
+		}
+		entered	= 1;
+	}
+}
+
+/*
+* connect a new vertex to the vertices of the star halfedges, each one has
+* the vertex in the wedge that follows it in its ring. Returns the last spoke
+*/
+static unsigned int del_mesh_star( delaunay2d_mesh_t *mesh, unsigned int v, unsigned int count )
+{
+	working_set_t	*ws	= &(mesh->ws);
+	unsigned int	prev	= DEL_NIL;
+	unsigned int	e, i;
+
+	for( i = 0; i < count; i++ )
+	{
+		e	= halfedge_alloc(ws);
+
+		HE(ws, e).vertex		= v;
+		HE(ws, HE_PAIR(e)).vertex	= HE(ws, mesh->star[i]).vertex;
+		del_insert_halfedge(ws, HE_PAIR(e), mesh->star[i]);
+
+		if( prev == DEL_NIL ) {
+			HE(ws, e).next		= e;
+			HE(ws, e).prev		= e;
+			ws->points[v].he	= e;
+		} else
+			del_insert_halfedge(ws, e, prev);
+
+		prev	= e;
+	}
+
+	return prev;
+}
+
+/*
+* restore the Delaunay property around a new vertex: the edges on the stack
+* face it, they are flipped while the vertex across is in its circumcircle
+*/
+static void del_mesh_flip( delaunay2d_mesh_t *mesh, unsigned int v, unsigned int num_stack )
+{
+	working_set_t	*ws	= &(mesh->ws);
+	unsigned int	t, f2, g1, g2;
+	point2d_t	*q;
+
+	while( num_stack > 0 ) {
+		t	= mesh->stack[--num_stack];
+		if( !del_mesh_inner(ws, HE_PAIR(t)) )
+			continue;
+
+		/* t goes from a to b, (a, b, v) on its left and (b, a, q) on its right */
+		g1	= HE(ws, t).prev;
+		q	= HE_VERTEX(ws, HE_PAIR(g1));
+		if( in_circle(ws, HE_VERTEX(ws, t), HE_VERTEX(ws, HE_PAIR(t)), &(ws->points[v]), q) != INSIDE )
+			continue;
+
+		f2	= HE_FACE_NEXT(ws, HE_FACE_NEXT(ws, t));
+		g2	= HE_FACE_NEXT(ws, g1);
+
+		del_remove_edge(ws, t);
+		del_mesh_connect(ws, f2, g2);
+
+		mesh->stack	= (unsigned int*)del_grow(mesh->stack, &mesh->max_stack, num_stack + 2, sizeof(unsigned int));
+		mesh->stack[num_stack++]	= g1;
+		mesh->stack[num_stack++]	= g2;
+	}
+}
+
+/*
+* store an inserted point, in the slot of a removed one or after the others
+*/
+static void del_mesh_add_point( delaunay2d_mesh_t *mesh, unsigned int slot, del_point2d_t point )
+{
+	delaunay2d_context_t	*ctx	= &(mesh->ctx);
+
+	if( slot == ctx->del.num_points ) {
+		ctx->del.points	= (del_point2d_t*)del_grow(ctx->del.points, &ctx->max_del_points, slot + 1, sizeof(del_point2d_t));
+		ctx->del.num_points	= slot + 1;
+
+		if( mesh->removed )
+			mesh->removed	= (unsigned char*)del_grow(mesh->removed, &mesh->max_removed, slot + 1, sizeof(unsigned char));
+	} else
+		mesh->num_free--;
+
+	ctx->del.points[slot]	= point;
+	if( mesh->removed )
+		mesh->removed[slot]	= 0;
+}
+
+unsigned int delaunay2d_mesh_insert(delaunay2d_mesh_t* mesh, del_point2d_t point) {
+	delaunay2d_context_t	*ctx	= &(mesh->ctx);
+	working_set_t		*ws	= &(mesh->ws);
+	unsigned int		n	= ctx->del.num_points;
+	unsigned int		slot	= (mesh->num_free > 0) ? mesh->free_points[mesh->num_free - 1] : n;
+	unsigned int		d, d1, d2, e, count, i;
+	int			outside, side[3];
+	point2d_t		*p, *v[3];
+
+	if( mesh->degenerate ) {
+		/* no triangle to start from yet, the few (or colinear) points are rebuilt */
+		for( i = 0; i < n; i++ )
+			if( !(mesh->removed && mesh->removed[i]) && ctx->del.points[i].x == point.x && ctx->del.points[i].y == point.y )
+				return i;
+
+		del_mesh_add_point( mesh, slot, point );
+		del_mesh_build( mesh );
+		return slot;
+	}
+
+	/* room for the point and its 3 edges */
+	ws->points	= ctx->points	= (point2d_t*)del_grow(ctx->points, &ctx->max_points, n + 1, sizeof(point2d_t));
+	ws->edges	= (halfedge_t*)(ctx->scratch	= del_grow(ctx->scratch, &ctx->max_scratch, n + 1, DEL_SCRATCH_SIZE));
+	ws->max_edge	= 2 * 3 * ctx->max_scratch;
+
+	p	= &(ws->points[slot]);
+	p->x	= point.x;
+	p->y	= point.y;
+	p->he	= DEL_NIL;
+	p->idx	= slot;
+
+	/* a point the integer predicates can't take moves the mesh to the filtered ones */
+	if( ws->predicates == DEL_PREDICATES_INTEGER && !del_integer_point(point.x, point.y) )
+		ws->predicates	= del_supported_predicates(DEL_PREDICATES_FILTERED);
+
+	d	= del_mesh_locate(mesh, p, &outside);
+	count	= 0;
+
+	if( outside ) {
+		/* the visible part of the hull, its last vertex closes the star */
+		while( classify_point_seg(ws, HE_VERTEX(ws, HE_PAIR(HE(ws, d).next)), HE_VERTEX(ws, d), p) == ON_LEFT )
+			d	= HE_PAIR(HE(ws, d).next);
+
+		do {
+			mesh->star	= (unsigned int*)del_grow(mesh->star, &mesh->max_star, count + 2, sizeof(unsigned int));
+			mesh->star[count++]	= d;
+			d	= HE_FACE_NEXT(ws, d);
+		} while( classify_point_seg(ws, HE_VERTEX(ws, d), HE_VERTEX(ws, HE_PAIR(d)), p) == ON_LEFT );
+
+		mesh->star[count++]	= d;
+	} else {
+		d1	= HE_FACE_NEXT(ws, d);
+		d2	= HE_FACE_NEXT(ws, d1);
+
+		v[0]	= HE_VERTEX(ws, d);
+		v[1]	= HE_VERTEX(ws, d1);
+		v[2]	= HE_VERTEX(ws, d2);
+
+		for( i = 0; i < 3; i++ )
+			if( v[i]->x == p->x && v[i]->y == p->y )
+				return v[i]->idx;
+
+		side[0]	= classify_point_seg(ws, v[0], v[1], p);
+		side[1]	= classify_point_seg(ws, v[1], v[2], p);
+		side[2]	= classify_point_seg(ws, v[2], v[0], p);
+
+		/* on an edge, make it d */
+		if( side[1] == ON_SEG ) {
+			d	= d1;
+			d1	= d2;
+			d2	= HE_FACE_NEXT(ws, d2);
+		} else if( side[2] == ON_SEG ) {
+			d	= d2;
+			d2	= d1;
+			d1	= HE_FACE_NEXT(ws, d);
+		} else if( side[0] != ON_SEG )
+			d	= DEL_NIL;
+
+		mesh->star	= (unsigned int*)del_grow(mesh->star, &mesh->max_star, 4, sizeof(unsigned int));
+		if( d == DEL_NIL ) {
+			/* inside the triangle */
+			mesh->star[0]	= HE_FACE_NEXT(ws, d2);
+			mesh->star[1]	= d1;
+			mesh->star[2]	= d2;
+			count		= 3;
+		} else if( del_mesh_inner(ws, HE_PAIR(d)) ) {
+			/* on an inner edge, it goes and leaves a quad */
+			mesh->star[0]	= HE(ws, d).prev;
+			mesh->star[1]	= HE_FACE_NEXT(ws, mesh->star[0]);
+			mesh->star[2]	= d1;
+			mesh->star[3]	= d2;
+			count		= 4;
+			del_remove_edge(ws, d);
+		} else {
+			/* on a hull edge, it goes and the triangle opens on the outside */
+			mesh->star[0]	= d1;
+			mesh->star[1]	= d2;
+			count		= 2;
+			del_remove_edge(ws, d);
+			mesh->star[count++]	= HE_FACE_NEXT(ws, d2);
+			outside		= 1;
+		}
+	}
+
+	e	= del_mesh_star(mesh, slot, count);
+	if( outside ) {
+		/* the star is open on the outside, after its last spoke */
+		mesh->hull_he	= e;
+		count--;
+	}
+
+	mesh->stack	= (unsigned int*)del_grow(mesh->stack, &mesh->max_stack, count, sizeof(unsigned int));
+	memcpy(mesh->stack, mesh->star, count * sizeof(unsigned int));
+	del_mesh_flip(mesh, slot, count);
+
+	del_mesh_add_point( mesh, slot, point );
+	mesh->last_vert	= slot;
+
+	return slot;
+}
+
+/*
+* test if 3 consecutive vertices of the hole left by a removed vertex make a
+* Delaunay ear: a left turn, with none of the other hole vertices in its
+* circumcircle
+*/
+static int del_mesh_ear( working_set_t *ws, const unsigned int *hole, unsigned int count, unsigned int i )
+{
+	point2d_t	*a	= HE_VERTEX(ws, hole[i]);
+	point2d_t	*b	= HE_VERTEX(ws, hole[(i + 1) % count]);
+	point2d_t	*c	= HE_VERTEX(ws, hole[(i + 2) % count]);
+	point2d_t	*q;
+	unsigned int	j;
+
+	if( classify_point_seg(ws, a, b, c) != ON_LEFT )
+		return 0;
+
+	for( j = 0; j < count; j++ )
+	{
+		q	= HE_VERTEX(ws, hole[j]);
+		if( q != a && q != b && q != c && in_circle(ws, a, b, c, q) == INSIDE )
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+* cut the Delaunay ears of the hole left by a removed vertex. A closed hole
+* is cut down to a triangle, an open one (the removed vertex was on the hull)
+* until no ear is left, its last entry only gives the chain end
+*/
+static void del_mesh_fill( delaunay2d_mesh_t *mesh, unsigned int count, int closed )
+{
+	working_set_t	*ws	= &(mesh->ws);
+	unsigned int	*hole	= mesh->star;
+	unsigned int	i, last;
+
+	while( count > (closed ? 3u : 2u) ) {
+		last	= closed ? count : count - 2;
+		for( i = 0; i < last; i++ )
+			if( del_mesh_ear(ws, hole, count, i) )
+				break;
+
+		if( i == last ) {
+			/* the rest of the chain is on the hull */
+			assert( !closed );
+			return;
+		}
+
+		hole[i]	= del_mesh_connect(ws, hole[i], hole[(i + 2) % count]);
+		if( i + 1 == count ) {
+			/* the ear wrapped around, its middle vertex is the first one */
+			memmove(hole, hole + 1, (count - 1) * sizeof(unsigned int));
+		} else
+			memmove(hole + i + 1, hole + i + 2, (count - i - 2) * sizeof(unsigned int));
+		count--;
+	}
+}
+
+int delaunay2d_mesh_remove(delaunay2d_mesh_t* mesh, unsigned int index) {
+	delaunay2d_context_t	*ctx	= &(mesh->ctx);
+	working_set_t		*ws	= &(mesh->ws);
+	unsigned int		n	= ctx->del.num_points;
+	unsigned int		d, k, i, j, count;
+
+	if( index >= n || (mesh->removed && mesh->removed[index]) )
+		return 0;
+
+	if( mesh->removed == NULL ) {
+		mesh->removed	= (unsigned char*)del_grow(NULL, &mesh->max_removed, n, sizeof(unsigned char));
+		memset(mesh->removed, 0, n);
+	}
+
+	mesh->removed[index]	= 1;
+	mesh->free_points	= (unsigned int*)del_grow(mesh->free_points, &mesh->max_free, mesh->num_free + 1, sizeof(unsigned int));
+	mesh->free_points[mesh->num_free++]	= index;
+
+	if( mesh->degenerate || n - mesh->num_free < 3 ) {
+		del_mesh_build( mesh );
+		return 1;
+	}
+
+	/* a duplicate has no vertex to take out */
+	if( ws->points[index].he == DEL_NIL )
+		return 1;
+
+	/* the spokes of the vertex, and the one with the outside on its left */
+	k	= 0;
+	j	= DEL_NIL;
+	d	= ws->points[index].he;
+	do {
+		mesh->stack	= (unsigned int*)del_grow(mesh->stack, &mesh->max_stack, k + 1, sizeof(unsigned int));
+		if( !del_mesh_inner(ws, d) )
+			j	= k;
+		mesh->stack[k++]	= d;
+		d	= HE(ws, d).next;
+	} while( d != ws->points[index].he );
+
+	/* the edges across the faces around it, in order */
+	mesh->star	= (unsigned int*)del_grow(mesh->star, &mesh->max_star, k + 1, sizeof(unsigned int));
+	count	= 0;
+	for( i = 1; i <= k; i++ )
+		if( j == DEL_NIL || (j + i) % k != j )
+			mesh->star[count++]	= HE_FACE_NEXT(ws, mesh->stack[(j == DEL_NIL ? i : j + i) % k]);
+
+	for( i = 0; i < k; i++ )
+		del_remove_edge(ws, mesh->stack[i]);
+
+	ws->points[index].he	= DEL_NIL;
+
+	if( j == DEL_NIL )
+		del_mesh_fill(mesh, count, 1);
+	else {
+		/* on the hull, the chain ends where the next hull edge starts */
+		mesh->star[count]	= HE_FACE_NEXT(ws, mesh->star[count - 1]);
+		del_mesh_fill(mesh, count + 1, 0);
+
+		mesh->hull_he		= mesh->star[0];
+		mesh->degenerate	= !del_mesh_inner(ws, HE_PAIR(mesh->hull_he));
+	}
+
+	mesh->last_vert	= HE(ws, mesh->star[0]).vertex;
+
+	return 1;
+}
+
+delaunay2d_t* delaunay2d_mesh_faces(delaunay2d_mesh_t* mesh) {
+	delaunay2d_context_t	*ctx	= &(mesh->ctx);
+	working_set_t		*ws	= &(mesh->ws);
+	delaunay_t		del;
+	del_faces_task_t	tasks[DEL_MAX_THREADS];
+	unsigned int		num_tasks, size;
+
+	ctx->del.num_faces	= 0;
+	if( mesh->hull_he == DEL_NIL )
+		return &(ctx->del);
+
+	del.ws			= ws;
+	del.rightmost_he	= HE_PAIR(mesh->hull_he);
+	del.leftmost_he		= DEL_NIL;
+	del.start_point		= 0;
+	del.end_point		= ctx->del.num_points - 1;
+
+	ws->he_face	= ctx->he_face	= (unsigned int*)del_reserve(ctx->he_face, &ctx->max_he_face, ws->num_edges, sizeof(unsigned int));
+	size		= del_count_faces( &del, tasks, &num_tasks, del_threads(ctx->num_threads) );
+
+	ws->max_face	= del.num_faces;
+	ws->faces	= ctx->faces	= (face_t*)del_reserve(ctx->faces, &ctx->max_faces, ws->max_face, sizeof(face_t));
+	ctx->del.faces	= (unsigned int*)del_reserve(ctx->del.faces, &ctx->max_del_faces, size, sizeof(unsigned int));
+
+	del_build_faces( &del, tasks, num_tasks, ctx->del.faces );
+	ctx->del.num_faces	= del.num_faces;
+
+	return &(ctx->del);
+}
+
+/*
+* number of triangles in a set of faces
+*/
+static unsigned int del_num_triangles( const unsigned int *faces, unsigned int num_faces )
+{
+	unsigned int		v_offset;
+	unsigned int		num_triangles	= 0;
+	unsigned int		i;
+
+	/* no face at all: less than 3 distinct points */
+	if( 0 == num_faces )
+		return 0;
+
+	v_offset	= faces[0] + 1;	/* ignore external face */
+
+	if( 1 == num_faces ) { /* degenerate case: only external face exists */
+		unsigned int	nv	= faces[0];
+		num_triangles	+= nv - 2;
+	} else {
+		for( i = 1; i < num_faces; ++i ) {
+			unsigned int	nv	= faces[v_offset];
+			num_triangles	+= nv - 2;
+			v_offset	+= nv + 1;
+		}
+	}
+
+	return num_triangles;
+}
+
+/*
+* split a set of faces into triangles (del_num_triangles() of them)
+*/
+static void del_fan_triangles( const unsigned int *faces, unsigned int num_faces, unsigned int *tris )
+{
+	unsigned int		v_offset;
+	unsigned int		dst_offset	= 0;
+	unsigned int		i;
+
+	if( 0 == num_faces )
+		return;
+
+	v_offset	= faces[0] + 1;	/* ignore external face */
+
+	if( 1 == num_faces ) {
+		/* handle the degenerated case where only the external face exists */
+		unsigned int	nv	= faces[0];
+		unsigned int	j	= 0;
+		v_offset	= 1;
+		for( ; j < nv - 2; ++j ) {
+			tris[dst_offset]	= faces[v_offset + j];
+			tris[dst_offset + 1]	= faces[(v_offset + j + 1) % nv];
+			tris[dst_offset + 2]	= faces[v_offset + j];
+			dst_offset	+= 3;
+		}
+	} else {
+		for( i = 1; i < num_faces; ++i ) {
+			unsigned int	nv	= faces[v_offset];
+			unsigned int	j	= 0;
+			unsigned int	first	= faces[v_offset + 1];
+
+
+			for( ; j < nv - 2; ++j ) {
+				tris[dst_offset]	= first;
+				tris[dst_offset + 1]	= faces[v_offset + j + 2];
+				tris[dst_offset + 2]	= faces[v_offset + j + 3];
+				dst_offset	+= 3;
+			}
+
+			v_offset		+= nv + 1;
+		}
+	}
+}
+
+tri_delaunay2d_t* tri_delaunay2d_context_from(delaunay2d_context_t* ctx, delaunay2d_t* del) {
+	tri_delaunay2d_t*	tdel = &ctx->tdel;
+
+	/* count the number of triangles */
+	tdel->num_triangles	= del_num_triangles(del->faces, del->num_faces);
+
+	/* copy points */
+	tdel->num_points	= del->num_points;
+	tdel->points		= (del_point2d_t*)del_reserve(tdel->points, &ctx->max_tdel_points, del->num_points, sizeof(del_point2d_t));
+	memcpy(tdel->points, del->points, sizeof(del_point2d_t) * del->num_points);
+
+	/* build the triangles */
+	tdel->tris		= (unsigned int*)del_reserve(tdel->tris, &ctx->max_tdel_tris, 3 * tdel->num_triangles, sizeof(unsigned int));
+	del_fan_triangles(del->faces, del->num_faces, tdel->tris);
+
+	return tdel;
+}
+
+unsigned int tri_delaunay2d_max_triangles(unsigned int num_points) {
+	/* 2V - 2 - h triangles with at least 3 points on the hull, and 2V - 4
+	   flat ones for the external face when all the points are aligned */
+	return num_points < 3 ? 0 : 2 * num_points - 4;
+}
+
+/*
+* fan the inner faces of the mesh of a context straight into triangles, each
+* face from the vertex owning it as in del_faces_task_run(): the triangles
+* come in the order of del_fan_triangles() without building the faces. The
+* buffer is sized from Euler's formula, 2V - 2 - h triangles for V vertices
+* and h halfedges on the hull, and grows past it when failed predicates split
+* the mesh (see del_count_faces()). Without grow, tris is a caller buffer of
+* max_tris indices that is never reallocated. Returns the triangle count, or
+* DEL_NIL when they don't fit in it
+*/
+static unsigned int del_fan_mesh( delaunay_t *del, unsigned int num_verts, unsigned int **tris, unsigned int *max_tris, int grow )
+{
+	working_set_t		*ws	= del->ws;
+	unsigned int		num_hull, n, v, d, h, last, v0;
+	unsigned int		*t;
+
+	num_hull	= del_mark_external( del );
+
+	/* aligned points: the external face is fanned into flat triangles, as
+	   del_fan_triangles() does */
+	if( 2 * num_verts - 2 <= num_hull ) {
+		if( grow )
+			*tris	= (unsigned int*)del_reserve(*tris, max_tris, 3 * (num_hull - 2), sizeof(unsigned int));
+		else if( 3 * (num_hull - 2) > *max_tris )
+			return DEL_NIL;
+
+		t	= *tris;
+		d	= HE_PAIR(del->rightmost_he);
+		for( n = 0; n < num_hull - 2; n++, d = HE_FACE_NEXT(ws, d) )
+		{
+			t[3 * n]	= HE_VERTEX(ws, d)->idx;
+			t[3 * n + 1]	= HE_VERTEX(ws, HE_PAIR(d))->idx;
+			t[3 * n + 2]	= HE_VERTEX(ws, d)->idx;
+		}
+
+		return num_hull - 2;
+	}
+
+	if( grow )
+		*tris	= (unsigned int*)del_reserve(*tris, max_tris, 3 * (2 * num_verts - 2 - num_hull), sizeof(unsigned int));
+
+	t	= *tris;
+	n	= 0;
+
+	for( v = 0; v < num_verts; v++ )
+	{
+		d	= ws->points[v].he;
+		do {
+			if( del_owns_face(ws, d, v) ) {
+				/* the fan of v, up to the halfedge arriving at v */
+				v0	= HE_VERTEX(ws, d)->idx;
+				last	= HE_PAIR(HE(ws, d).next);
+				for( h = HE_FACE_NEXT(ws, d); h != last; h = HE_FACE_NEXT(ws, h), n++ )
+				{
+					if( 3 * (n + 1) > *max_tris ) {
+						if( !grow )
+							return DEL_NIL;
+
+						*tris	= (unsigned int*)del_grow(*tris, max_tris, 3 * (n + 1), sizeof(unsigned int));
+						t	= *tris;
+					}
+
+					t[3 * n]	= v0;
+					t[3 * n + 1]	= HE_VERTEX(ws, h)->idx;
+					t[3 * n + 2]	= HE_VERTEX(ws, HE_PAIR(h))->idx;
+				}
+			}
+			d	= HE(ws, d).next;
+		} while( d != ws->points[v].he );
+	}
+
+	return n;
+}
+
+/*
+* build the triangles of a point set with the context buffers, straight from
+* its mesh, into tris (of max_tris indices, it grows when it is too small and
+* grow is given). Returns the triangle count, DEL_NIL when they don't fit
+*/
+static unsigned int del_context_fan( delaunay2d_context_t *ctx, const del_point2d_t *points, unsigned int num_points, unsigned int **tris, unsigned int *max_tris, int grow )
+{
+	delaunay_t		del;
+	working_set_t		*ws	= &ctx->ws;
+	unsigned int		num_verts, num_triangles;
+
+	ctx->del.num_faces	= 0;
+	ctx->del.indices	= NULL;
+
+	num_verts	= del_context_mesh( ctx, points, num_points, del_threads(ctx->num_threads), &del, ws );
+	if( num_verts < 3 ) {
+		if( grow )
+			*tris	= (unsigned int*)del_reserve(*tris, max_tris, 0, sizeof(unsigned int));
+		return 0;
+	}
+
+	/* the owned faces, and their triangles, come along the curve */
+	if( ctx->ordering != DEL_ORDERING_SORTED )
+		del_curve_layout( ctx, &del, ws, NULL );
+
+	ws->he_face	= ctx->he_face	= (unsigned int*)del_reserve(ctx->he_face, &ctx->max_he_face, ws->num_edges, sizeof(unsigned int));
+	num_triangles	= del_fan_mesh( &del, num_verts, tris, max_tris, grow );
+	DEL_STATS_PHASE(ctx, faces);
+
+	return num_triangles;
+}
+
+tri_delaunay2d_t* tri_delaunay2d_context_points(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points) {
+	tri_delaunay2d_t*	tdel	= &ctx->tdel;
+
+	DEL_STATS_START(ctx);
+	tdel->num_triangles	= del_context_fan( ctx, points, num_points, &tdel->tris, &ctx->max_tdel_tris, 1 );
+
+	tdel->num_points	= num_points;
+	tdel->points		= (del_point2d_t*)del_reserve(tdel->points, &ctx->max_tdel_points, num_points, sizeof(del_point2d_t));
+	memcpy(tdel->points, points, sizeof(del_point2d_t) * num_points);
+	DEL_STATS_PHASE(ctx, copy);
+
+	return tdel;
+}
+
+tri_delaunay2d_t* tri_delaunay2d_points_from(const del_point2d_t *points, unsigned int num_points) {
+	tri_delaunay2d_t*	tdel	= NULL;
+	delaunay2d_context_t	ctx;
+
+	del_context_init( &ctx );
+	tri_delaunay2d_context_points( &ctx, points, num_points );
+
+	/* the result takes the context output buffers */
+	tdel		= (tri_delaunay2d_t*)malloc(sizeof(tri_delaunay2d_t));
+	assert( NULL != tdel );
+	*tdel		= ctx.tdel;
+
+	ctx.tdel.points	= NULL;
+	ctx.tdel.tris	= NULL;
+	del_context_free( &ctx );
+
+	return tdel;
+}
+
+unsigned int tri_delaunay2d_context_tris(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points, unsigned int *tris) {
+	unsigned int	max_tris	= 3 * tri_delaunay2d_max_triangles(num_points);
+
+	if( num_points < 3 )
+		return 0;
+
+	/* the caller buffer is never reallocated, a split mesh that doesn't fit is an error */
+	DEL_STATS_START(ctx);
+	return del_context_fan( ctx, points, num_points, &tris, &max_tris, 0 );
+}
+
+/*
+* fan the faces of the last build of a context into triangles, in the order
+* of del_fan_triangles(), and give each triangle edge the triangle across it
+* (DEL_NIL on the hull) from the halfedge pairs. The face map of the
+* halfedges is reused for the triangle corner of each one
+*/
+static void del_export_neighbors( delaunay2d_context_t *ctx, unsigned int *tris, unsigned int *neighbors )
+{
+	working_set_t		*ws	= &ctx->ws;
+	unsigned int		*corner	= ws->he_face;
+	unsigned int		f, h, j, k, t, c, v0;
+
+	/* aligned points: the external face is fanned into flat triangles */
+	if( ctx->del.num_faces == 1 ) {
+		del_fan_triangles(ctx->del.faces, 1, tris);
+		memset(neighbors, 0xFF, 3 * del_num_triangles(ctx->del.faces, 1) * sizeof(unsigned int));
+		return;
+	}
+
+	h	= ws->faces[0].he;
+	do {
+		corner[h]	= DEL_NIL;
+		h		= HE_FACE_NEXT(ws, h);
+	} while( h != ws->faces[0].he );
+
+	/* face edge j is edge 0 of the first triangle, edge 1 of triangle j - 1
+	   and edge 2 of the last one, the fan edges link consecutive triangles */
+	for( f = 1, t = 0; f < ctx->del.num_faces; f++ )
+	{
+		h	= ws->faces[f].he;
+		k	= ws->faces[f].num_verts;
+		v0	= HE_VERTEX(ws, h)->idx;
+
+		for( j = 0; j < k; j++, h = HE_FACE_NEXT(ws, h) )
+		{
+			if( j == 0 )
+				corner[h]	= 3 * t;
+			else if( j == k - 1 )
+				corner[h]	= 3 * (t + k - 3) + 2;
+			else {
+				c		= 3 * (t + j - 1);
+				corner[h]	= c + 1;
+				tris[c]		= v0;
+				tris[c + 1]	= HE_VERTEX(ws, h)->idx;
+				tris[c + 2]	= HE_VERTEX(ws, HE_PAIR(h))->idx;
+
+				if( j > 1 ) {
+					neighbors[c]		= t + j - 2;
+					neighbors[c - 1]	= t + j - 1;
+				}
+			}
+		}
+
+		t	+= k - 2;
+	}
+
+	for( h = 0; h < ws->num_edges; h++ )
+	{
+		c	= corner[h];
+		if( c != DEL_NIL )
+			neighbors[c]	= (corner[HE_PAIR(h)] != DEL_NIL) ? corner[HE_PAIR(h)] / 3 : DEL_NIL;
+	}
+}
+
+unsigned int tri_delaunay2d_context_neighbors(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points, unsigned int *tris, unsigned int *neighbors) {
+	unsigned int	num_triangles;
+
+	if( num_points < 3 )
+		return 0;
+
+	DEL_STATS_START(ctx);
+	del_context_build( ctx, points, num_points, del_threads(ctx->num_threads), NULL, 0 );
+
+	if( ctx->del.num_faces == 0 )
+		return 0;
+
+	/* the caller buffers hold tri_delaunay2d_max_triangles(), a split mesh may not fit */
+	num_triangles	= del_num_triangles(ctx->del.faces, ctx->del.num_faces);
+	if( num_triangles > tri_delaunay2d_max_triangles(num_points) )
+		return DEL_NIL;
+
+	del_export_neighbors( ctx, tris, neighbors );
+
+	return num_triangles;
+}
+
+tri_delaunay2d_t* tri_delaunay2d_neighbors_from(const del_point2d_t *points, unsigned int num_points) {
+	tri_delaunay2d_t*	tdel;
+	delaunay2d_context_t	ctx;
+	unsigned int		max_neighbors	= 0;
+
+	del_context_init( &ctx );
+	del_context_build( &ctx, points, num_points, del_threads(ctx.num_threads), NULL, 0 );
+
+	tdel			= &ctx.tdel;
+	tdel->num_points	= num_points;
+	tdel->points		= (del_point2d_t*)del_reserve(NULL, &ctx.max_tdel_points, num_points, sizeof(del_point2d_t));
+	memcpy(tdel->points, points, sizeof(del_point2d_t) * num_points);
+
+	tdel->num_triangles	= del_num_triangles(ctx.del.faces, ctx.del.num_faces);
+	tdel->tris		= (unsigned int*)del_reserve(NULL, &ctx.max_tdel_tris, 3 * tdel->num_triangles, sizeof(unsigned int));
+	tdel->neighbors		= (unsigned int*)del_reserve(NULL, &max_neighbors, 3 * tdel->num_triangles, sizeof(unsigned int));
+
+	if( ctx.del.num_faces > 0 )
+		del_export_neighbors( &ctx, tdel->tris, tdel->neighbors );
+
+	/* the result takes the context output buffers */
+	tdel		= (tri_delaunay2d_t*)malloc(sizeof(tri_delaunay2d_t));
+	assert( NULL != tdel );
+	*tdel		= ctx.tdel;
+
+	ctx.tdel.points	= NULL;
+	ctx.tdel.tris	= NULL;
+	del_context_free( &ctx );
+
+	return tdel;
+}
+
+tri_delaunay2d_t* tri_delaunay2d_from(delaunay2d_t* del) {
+	tri_delaunay2d_t*	tdel	= NULL;
+	delaunay2d_context_t	ctx;
+
+	del_context_init( &ctx );
+	tri_delaunay2d_context_from( &ctx, del );
+
+	/* the result takes the context output buffers */
+	tdel		= (tri_delaunay2d_t*)malloc(sizeof(tri_delaunay2d_t));
+	assert( NULL != tdel );
+	*tdel		= ctx.tdel;
+
+	ctx.tdel.points	= NULL;
+	ctx.tdel.tris	= NULL;
+	del_context_free( &ctx );
+
+	return tdel;
+}
+
+void tri_delaunay2d_release(tri_delaunay2d_t* tdel) {
+	free(tdel->neighbors);
+	free(tdel->tris);
+	free(tdel->points);
+	free(tdel);
+}
+
+/*
+* circumcenter of a Delaunay face, from 3 of its vertices (the other ones
+* of a larger face are on the same circle). Returns 0 for a flat face, its
+* center is at infinity and o is left at a
+*/
+static int del_circumcenter( const point2d_t *a, const point2d_t *b, const point2d_t *c, del_point2d_t *o )
+{
+	long double	bx, by, cx, cy, b2, c2, d;
+
+	bx	= (long double)b->x - a->x;
+	by	= (long double)b->y - a->y;
+	cx	= (long double)c->x - a->x;
+	cy	= (long double)c->y - a->y;
+
+	o->x	= a->x;
+	o->y	= a->y;
+
+	d	= REAL_TWO * (bx * cy - by * cx);
+	if( d == REAL_ZERO )
+		return 0;
+
+	b2	= bx * bx + by * by;
+	c2	= cx * cx + cy * cy;
+	o->x	= (real)(a->x + (cy * b2 - by * c2) / d);
+	o->y	= (real)(a->y + (bx * c2 - cx * b2) / d);
+
+	return 1;
+}
+
+/*
+* build the Voronoi diagram of a point set with the context buffers: the
+* vertices are the circumcenters of the inner faces, in face order, and each
+* cell is read from the ring of its site, counterclockwise
+*/
+static void del_context_voronoi( delaunay2d_context_t *ctx, const del_point2d_t *points, unsigned int num_points )
+{
+	delaunay2d_voronoi_t	*vor	= &(ctx->vor);
+	delaunay_t		del;
+	working_set_t		ws;
+	del_faces_task_t	tasks[DEL_MAX_THREADS];
+	unsigned int		num_tasks, num_verts, size, num_flat, i, v, f, h, first, j;
+	const point2d_t		*p, *q;
+
+	ctx->del.num_faces	= 0;
+	ctx->del.indices	= NULL;
+
+	num_verts	= del_context_mesh( ctx, points, num_points, del_threads(ctx->num_threads), &del, &ws );
+
+	vor->num_sites		= num_points;
+	vor->num_vertices	= 0;
+	vor->offsets		= (unsigned int*)del_reserve(vor->offsets, &ctx->max_vor_offsets, num_points + 1, sizeof(unsigned int));
+	vor->rays		= (del_point2d_t*)del_reserve(vor->rays, &ctx->max_vor_rays, 2 * num_points, sizeof(del_point2d_t));
+
+	/* duplicates, and points that are all aligned, have empty cells */
+	memset(vor->offsets, 0, (num_points + 1) * sizeof(unsigned int));
+	memset(vor->rays, 0, 2 * num_points * sizeof(del_point2d_t));
+
+	if( num_verts < 3 )
+		return;
+
+	ws.he_face	= ctx->he_face	= (unsigned int*)del_reserve(ctx->he_face, &ctx->max_he_face, ws.num_edges, sizeof(unsigned int));
+	size		= del_count_faces( &del, tasks, &num_tasks, del_threads(ctx->num_threads) );
+
+	ws.max_face	= del.num_faces;
+	ws.faces	= ctx->faces	= (face_t*)del_reserve(ctx->faces, &ctx->max_faces, ws.max_face, sizeof(face_t));
+	ctx->del.faces	= (unsigned int*)del_reserve(ctx->del.faces, &ctx->max_del_faces, size, sizeof(unsigned int));
+	del_build_faces( &del, tasks, num_tasks, ctx->del.faces );
+	ctx->del.num_faces	= del.num_faces;
+	DEL_STATS_PHASE(ctx, faces);
+
+	/* the vertices, face f is vertex f - 1 */
+	vor->num_vertices	= del.num_faces - 1;
+	vor->vertices		= (del_point2d_t*)del_reserve(vor->vertices, &ctx->max_vor_vertices, vor->num_vertices, sizeof(del_point2d_t));
+	for( f = 1, num_flat = 0; f < del.num_faces; f++ )
+	{
+		h	= ws.faces[f].he;
+		if( del_circumcenter(HE_VERTEX(&ws, h), HE_VERTEX(&ws, HE_FACE_NEXT(&ws, h)),
+				     HE_VERTEX(&ws, HE_FACE_NEXT(&ws, HE_FACE_NEXT(&ws, h))), &vor->vertices[f - 1]) )
+			continue;
+
+		/* a flat face (the D&C keeps aligned triples on the hull) has no
+		   vertex, the cells go around it like the external face */
+		num_flat++;
+		do {
+			ws.he_face[h]	= 0;
+			h		= HE_FACE_NEXT(&ws, h);
+		} while( h != ws.faces[f].he );
+	}
+
+	/* aligned points only have flat faces: their cells are strips, without vertex */
+	if( num_flat == vor->num_vertices ) {
+		vor->num_vertices	= 0;
+		return;
+	}
+
+	/* a cell takes the faces around its site, a halfedge ring at most */
+	vor->cells	= (unsigned int*)del_reserve(vor->cells, &ctx->max_vor_cells, ws.num_edges, sizeof(unsigned int));
+
+	/* the sizes first, at the offset of the next site */
+	for( v = 0; v < num_verts; v++ )
+	{
+		h	= ws.points[v].he;
+		do {
+			vor->offsets[ws.points[v].idx + 1]	+= (ws.he_face[h] != 0);
+			h	= HE(&ws, h).next;
+		} while( h != ws.points[v].he );
+	}
+
+	for( i = 0; i < num_points; i++ )
+		vor->offsets[i + 1]	+= vor->offsets[i];
+
+	for( v = 0; v < num_verts; v++ )
+	{
+		p	= &ws.points[v];
+		j	= vor->offsets[p->idx];
+		if( j == vor->offsets[p->idx + 1] )
+			continue;
+
+		/* the face left of a halfedge is between it and the next one of the
+		   ring: a hull site starts after the external faces */
+		first	= p->he;
+		do {
+			if( ws.he_face[first] == 0 && ws.he_face[HE(&ws, first).next] != 0 )
+				break;
+			first	= HE(&ws, first).next;
+		} while( first != p->he );
+
+		if( ws.he_face[first] == 0 ) {
+			/* the rays leave the cell across its 2 hull edges: from the
+			   first vertex, then from the last one */
+			first	= HE(&ws, first).next;
+			for( h = first; ws.he_face[h] != 0; h = HE(&ws, h).next )
+				;
+
+			q				= HE_VERTEX(&ws, HE_PAIR(first));
+			vor->rays[2 * p->idx].x		= q->y - p->y;
+			vor->rays[2 * p->idx].y		= p->x - q->x;
+
+			q				= HE_VERTEX(&ws, HE_PAIR(h));
+			vor->rays[2 * p->idx + 1].x	= p->y - q->y;
+			vor->rays[2 * p->idx + 1].y	= q->x - p->x;
+		}
+
+		h	= first;
+		do {
+			if( ws.he_face[h] != 0 )
+				vor->cells[j++]	= ws.he_face[h] - 1;
+			h	= HE(&ws, h).next;
+		} while( h != first );
+	}
+}
+
+delaunay2d_voronoi_t* delaunay2d_context_voronoi(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points) {
+	DEL_STATS_START(ctx);
+	del_context_voronoi( ctx, points, num_points );
+
+	return &ctx->vor;
+}
+
+delaunay2d_voronoi_t* delaunay2d_voronoi_from(const del_point2d_t *points, unsigned int num_points) {
+	delaunay2d_voronoi_t*	vor	= NULL;
+	delaunay2d_context_t	ctx;
+
+	del_context_init( &ctx );
+	del_context_voronoi( &ctx, points, num_points );
+
+	/* the result takes the context output buffers */
+	vor		= (delaunay2d_voronoi_t*)malloc(sizeof(delaunay2d_voronoi_t));
+	assert( NULL != vor );
+	*vor		= ctx.vor;
+
+	memset(&ctx.vor, 0, sizeof(delaunay2d_voronoi_t));
+	del_context_free( &ctx );
+
+	return vor;
+}
+
+void delaunay2d_voronoi_release(delaunay2d_voronoi_t* vor) {
+	free(vor->vertices);
+	free(vor->offsets);
+	free(vor->cells);
+	free(vor->rays);
+	free(vor);
+}
+
+/*
+* the neighbours of a range of vertices, read from their rings on their own
+* thread: counted at the offset of the next point, or written
+*/
+typedef struct {
+	working_set_t		*ws;
+	delaunay2d_adjacency_t	*adj;
+	unsigned int		start;			/* first vertex */
+	unsigned int		end;			/* last vertex + 1 */
+	int			fill;			/* write the neighbours, only count them otherwise */
+} del_adjacency_task_t;
+
+static void* del_adjacency_task_run( void *arg )
+{
+	del_adjacency_task_t	*task	= (del_adjacency_task_t*)arg;
+	working_set_t		*ws	= task->ws;
+	unsigned int		*offsets	= task->adj->offsets;
+	unsigned int		*neighbors	= task->adj->neighbors;
+	const point2d_t		*p;
+	unsigned int		v, h, j;
+
+	for( v = task->start; v < task->end; v++ )
+	{
+		p	= &ws->points[v];
+		h	= p->he;
+		j	= task->fill ? offsets[p->idx] : 0;
+
+		do {
+			if( task->fill )
+				neighbors[j]	= HE_VERTEX(ws, HE_PAIR(h))->idx;
+			j++;
+			h	= HE(ws, h).next;
+		} while( h != p->he );
+
+		if( !task->fill )
+			offsets[p->idx + 1]	= j;
+	}
+
+	return NULL;
+}
+
+/*
+* build the adjacency of a point set with the context buffers, the mesh alone
+* is needed: its faces aren't built
+*/
+static void del_context_adjacency( delaunay2d_context_t *ctx, const del_point2d_t *points, unsigned int num_points )
+{
+	delaunay2d_adjacency_t	*adj	= &(ctx->adj);
+	delaunay_t		del;
+	working_set_t		ws;
+	del_adjacency_task_t	tasks[DEL_MAX_THREADS];
+	unsigned int		num_verts, num_threads, chunk, i, t;
+
+	ctx->del.num_faces	= 0;
+	ctx->del.indices	= NULL;
+
+	num_threads	= del_threads(ctx->num_threads);
+	num_verts	= del_context_mesh( ctx, points, num_points, num_threads, &del, &ws );
+
+	/* the duplicates, and everything under 3 distinct points, have no neighbour */
+	adj->num_points	= num_points;
+	adj->offsets	= (unsigned int*)del_reserve(adj->offsets, &ctx->max_adj_offsets, num_points + 1, sizeof(unsigned int));
+	memset(adj->offsets, 0, (num_points + 1) * sizeof(unsigned int));
+
+	if( num_verts < 3 ) {
+		adj->neighbors	= (unsigned int*)del_reserve(adj->neighbors, &ctx->max_adj_neighbors, 0, sizeof(unsigned int));
+		return;
+	}
+
+	num_threads	= (num_verts < DEL_PARALLEL_CUTOFF) ? 1 : num_threads;
+	if( num_threads > DEL_MAX_THREADS )
+		num_threads	= DEL_MAX_THREADS;
+	chunk		= (num_verts + num_threads - 1) / num_threads;
+
+	for( t = 0; t < num_threads; t++ )
+	{
+		tasks[t].ws	= &ws;
+		tasks[t].adj	= adj;
+		tasks[t].start	= (t * chunk < num_verts) ? t * chunk : num_verts;
+		tasks[t].end	= ((t + 1) * chunk < num_verts) ? (t + 1) * chunk : num_verts;
+		tasks[t].fill	= 0;
+	}
+
+	del_run_tasks( tasks, sizeof(del_adjacency_task_t), num_threads, del_adjacency_task_run );
+
+	for( i = 0; i < num_points; i++ )
+		adj->offsets[i + 1]	+= adj->offsets[i];
+
+	adj->neighbors	= (unsigned int*)del_reserve(adj->neighbors, &ctx->max_adj_neighbors, adj->offsets[num_points], sizeof(unsigned int));
+
+	for( t = 0; t < num_threads; t++ )
+		tasks[t].fill	= 1;
+
+	del_run_tasks( tasks, sizeof(del_adjacency_task_t), num_threads, del_adjacency_task_run );
+	DEL_STATS_PHASE(ctx, faces);
+}
+
+delaunay2d_adjacency_t* delaunay2d_context_adjacency(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points) {
+	DEL_STATS_START(ctx);
+	del_context_adjacency( ctx, points, num_points );
+
+	return &ctx->adj;
+}
+
+delaunay2d_adjacency_t* delaunay2d_adjacency_from(const del_point2d_t *points, unsigned int num_points) {
+	delaunay2d_adjacency_t*	adj	= NULL;
+	delaunay2d_context_t	ctx;
+
+	del_context_init( &ctx );
+	del_context_adjacency( &ctx, points, num_points );
+
+	/* the result takes the context output buffers */
+	adj		= (delaunay2d_adjacency_t*)malloc(sizeof(delaunay2d_adjacency_t));
+	assert( NULL != adj );
+	*adj		= ctx.adj;
+
+	memset(&ctx.adj, 0, sizeof(delaunay2d_adjacency_t));
+	del_context_free( &ctx );
+
+	return adj;
+}
+
+void delaunay2d_adjacency_release(delaunay2d_adjacency_t* adj) {
+	free(adj->offsets);
+	free(adj->neighbors);
+	free(adj);
+}
+
+/*
+* a streaming build: the points of the faces that may still change (the
+* front) are built again with each chunk of points read, the others are
+* dropped once their faces are written
+*/
+typedef struct {
+	delaunay2d_context_t	ctx;			/* build buffers */
+	del_point2d_t*		points;			/* the front points, then the points read */
+	unsigned int*		ids;			/* stream index of each point */
+	del_point2d_t*		front_points;		/* the front of the next build */
+	unsigned int*		front_ids;		/* stream index of the front points */
+	unsigned int*		frontier;		/* front edges as pairs of front points, the written faces on their left */
+	unsigned int*		next_frontier;		/* front edges of the next build */
+	unsigned int*		map;			/* sorted position of each point, then the front index of each position */
+	unsigned char*		he_front;		/* halfedges of the previous front edges */
+	unsigned char*		face_state;		/* DEL_FACE_* state of each face */
+	unsigned int*		stack;			/* written faces to visit */
+	unsigned int*		tris;			/* triangles written by the build */
+	unsigned int		num_front;		/* number of front points */
+	unsigned int		num_frontier;		/* number of front edges */
+	unsigned int		num_next_frontier;	/* number of front edges of the next build */
+	unsigned int		max_points;		/* capacity of points */
+	unsigned int		max_ids;		/* capacity of ids */
+	unsigned int		max_front_points;	/* capacity of front_points */
+	unsigned int		max_front_ids;		/* capacity of front_ids */
+	unsigned int		max_frontier;		/* capacity of frontier, in edges */
+	unsigned int		max_next_frontier;	/* capacity of next_frontier, in edges */
+	unsigned int		max_map;		/* capacity of map */
+	unsigned int		max_he_front;		/* capacity of he_front */
+	unsigned int		max_face_state;		/* capacity of face_state */
+	unsigned int		max_stack;		/* capacity of stack */
+	unsigned int		max_tris;		/* capacity of tris, in triangles */
+} del_stream_t;
+
+/*
+* test if the circle through 3 points lies left of x = s, flat triangles have
+* none. The test leans to the safe side of rounding: a face found final too
+* late only stays longer in the front
+*/
+static int del_circle_left( const point2d_t *a, const point2d_t *b, const point2d_t *c, real s )
+{
+	long double	bx, by, cx, cy, b2, c2, d, ux, uy, gap;
+
+	bx	= (long double)b->x - a->x;
+	by	= (long double)b->y - a->y;
+	cx	= (long double)c->x - a->x;
+	cy	= (long double)c->y - a->y;
+
+	d	= REAL_TWO * (bx * cy - by * cx);
+	if( d == REAL_ZERO )
+		return 0;
+
+	b2	= bx * bx + by * by;
+	c2	= cx * cx + cy * cy;
+	ux	= (cy * b2 - by * c2) / d;
+	uy	= (bx * c2 - cx * b2) / d;
+
+	gap	= (long double)s - a->x - ux;
+	return gap > REAL_ZERO && gap * gap > (ux * ux + uy * uy) * (REAL_ONE + 1e-9l);
+}
+
+/*
+* find the halfedge from a vertex to another one, DEL_NIL when they are not
+* linked
+*/
+static unsigned int del_find_halfedge( working_set_t *ws, unsigned int u, unsigned int v )
+{
+	unsigned int	h	= ws->points[u].he;
+
+	do {
+		if( HE(ws, HE_PAIR(h)).vertex == v )
+			return h;
+		h	= HE(ws, h).next;
+	} while( h != ws->points[u].he );
+
+	return DEL_NIL;
+}
+
+/*
+* build the front and the points read after it, and write the faces that
+* can't change anymore: the points to come are right of x = s, so are out of
+* the faces circles left of it (all the faces are final on the last build).
+* The faces left of the previous front edges were written before, their
+* points may be gone, so the build has other faces there: they are flooded
+* from the front edges and skipped. Returns the number of triangles written
+*/
+static unsigned int del_stream_build( del_stream_t *st, unsigned int num_points, real s, int last, del_stream_write_t write, void *user )
+{
+	delaunay2d_context_t	*ctx	= &(st->ctx);
+	delaunay_t		del;
+	working_set_t		ws;
+	del_faces_task_t	tasks[DEL_MAX_THREADS];
+	unsigned int		num_tasks, num_verts, size, num_tris, sp, i, f, g, h, d, k, v0;
+	void			*tmp;
+
+	DEL_STATS_START(ctx);
+	num_verts	= del_context_mesh( ctx, st->points, num_points, del_threads(ctx->num_threads), &del, &ws );
+
+	/* less than 3 distinct points: they all stay in the front */
+	if( num_verts < 3 ) {
+		st->num_front	= num_points;
+		return 0;
+	}
+
+	ws.he_face	= ctx->he_face	= (unsigned int*)del_reserve(ctx->he_face, &ctx->max_he_face, ws.num_edges, sizeof(unsigned int));
+	size		= del_count_faces( &del, tasks, &num_tasks, del_threads(ctx->num_threads) );
+
+	ws.max_face	= del.num_faces;
+	ws.faces	= ctx->faces	= (face_t*)del_reserve(ctx->faces, &ctx->max_faces, ws.max_face, sizeof(face_t));
+	ctx->del.faces	= (unsigned int*)del_reserve(ctx->del.faces, &ctx->max_del_faces, size, sizeof(unsigned int));
+	del_build_faces( &del, tasks, num_tasks, ctx->del.faces );
+
+	st->map		= (unsigned int*)del_reserve(st->map, &st->max_map, num_points, sizeof(unsigned int));
+	st->he_front	= (unsigned char*)del_reserve(st->he_front, &st->max_he_front, ws.num_edges, sizeof(unsigned char));
+	st->face_state	= (unsigned char*)del_reserve(st->face_state, &st->max_face_state, del.num_faces, sizeof(unsigned char));
+	st->stack	= (unsigned int*)del_reserve(st->stack, &st->max_stack, del.num_faces, sizeof(unsigned int));
+	memset(st->he_front, 0, ws.num_edges * sizeof(unsigned char));
+	memset(st->face_state, DEL_FACE_OPEN, del.num_faces * sizeof(unsigned char));
+
+	for( i = 0; i < num_verts; i++ )
+		st->map[ws.points[i].idx]	= i;
+
+	/* the previous front edges, then the written faces left of them */
+	k	= 0;
+	for( i = 0; i < st->num_frontier; i++ )
+	{
+		h	= del_find_halfedge(&ws, st->map[st->frontier[2 * i]], st->map[st->frontier[2 * i + 1]]);
+		if( h != DEL_NIL ) {
+			st->he_front[h]		= 1;
+			st->frontier[k++]	= h;
+		}
+	}
+
+	for( i = 0; i < k; i++ )
+	{
+		f	= ws.he_face[st->frontier[i]];
+		if( f == 0 || st->face_state[f] != DEL_FACE_OPEN )
+			continue;
+
+		st->face_state[f]	= DEL_FACE_DONE;
+		sp			= 0;
+		st->stack[sp++]		= f;
+		while( sp > 0 ) {
+			f	= st->stack[--sp];
+			d	= ws.faces[f].he;
+			g	= d;
+			do {
+				f	= ws.he_face[HE_PAIR(g)];
+				if( !st->he_front[g] && f != 0 && f != DEL_NIL && st->face_state[f] == DEL_FACE_OPEN ) {
+					st->face_state[f]	= DEL_FACE_DONE;
+					st->stack[sp++]		= f;
+				}
+				g	= HE_FACE_NEXT(&ws, g);
+			} while( g != d );
+		}
+	}
+
+	/* write the final faces, split as in del_fan_triangles() */
+	st->tris	= (unsigned int*)del_reserve(st->tris, &st->max_tris, 2 * num_verts, 3 * sizeof(unsigned int));
+	num_tris	= 0;
+	for( f = 1; f < del.num_faces; f++ )
+	{
+		d	= ws.faces[f].he;
+		g	= HE_FACE_NEXT(&ws, d);
+		if( st->face_state[f] != DEL_FACE_OPEN ||
+		    !(last || del_circle_left(HE_VERTEX(&ws, d), HE_VERTEX(&ws, g), HE_VERTEX(&ws, HE_FACE_NEXT(&ws, g)), s)) )
+			continue;
+
+		st->face_state[f]	= DEL_FACE_FINAL;
+		v0			= st->ids[HE_VERTEX(&ws, d)->idx];
+		for( i = 0; i + 2 < ws.faces[f].num_verts; i++ )
+		{
+			st->tris[3 * num_tris]		= v0;
+			st->tris[3 * num_tris + 1]	= st->ids[HE_VERTEX(&ws, g)->idx];
+			g				= HE_FACE_NEXT(&ws, g);
+			st->tris[3 * num_tris + 2]	= st->ids[HE_VERTEX(&ws, g)->idx];
+			num_tris++;
+		}
+	}
+
+	if( num_tris > 0 )
+		write(user, st->tris, num_tris);
+
+	if( last )
+		return num_tris;
+
+	/* the next front: both ends of the halfedges of the open faces, and the
+	   edges between them and the written ones */
+	memset(st->map, 0xFF, num_verts * sizeof(unsigned int));
+	for( h = 0; h < ws.num_edges; h++ )
+	{
+		f	= ws.he_face[h];
+		if( f != DEL_NIL && st->face_state[f] == DEL_FACE_OPEN && !st->he_front[h] ) {
+			st->map[HE(&ws, h).vertex]		= 0;
+			st->map[HE(&ws, HE_PAIR(h)).vertex]	= 0;
+		}
+	}
+
+	st->front_points	= (del_point2d_t*)del_reserve(st->front_points, &st->max_front_points, num_verts, sizeof(del_point2d_t));
+	st->front_ids		= (unsigned int*)del_reserve(st->front_ids, &st->max_front_ids, num_verts, sizeof(unsigned int));
+	k	= 0;
+	for( i = 0; i < num_verts; i++ )
+	{
+		if( st->map[i] == DEL_NIL )
+			continue;
+
+		st->map[i]		= k;
+		st->front_points[k].x	= ws.points[i].x;
+		st->front_points[k].y	= ws.points[i].y;
+		st->front_ids[k++]	= st->ids[ws.points[i].idx];
+	}
+
+	st->num_next_frontier	= 0;
+	for( h = 0; h < ws.num_edges; h++ )
+	{
+		f	= ws.he_face[h];
+		g	= HE_PAIR(h);
+		if( f == DEL_NIL || st->face_state[f] != DEL_FACE_OPEN || st->he_front[h] ||
+		    (st->face_state[ws.he_face[g]] == DEL_FACE_OPEN && !st->he_front[g]) )
+			continue;
+
+		st->next_frontier	= (unsigned int*)del_grow(st->next_frontier, &st->max_next_frontier, st->num_next_frontier + 1, 2 * sizeof(unsigned int));
+		st->next_frontier[2 * st->num_next_frontier]		= st->map[HE(&ws, g).vertex];
+		st->next_frontier[2 * st->num_next_frontier + 1]	= st->map[HE(&ws, h).vertex];
+		st->num_next_frontier++;
+	}
+
+	/* the front becomes the start of the points of the next build */
+	tmp			= st->points;
+	st->points		= st->front_points;
+	st->front_points	= (del_point2d_t*)tmp;
+	tmp			= st->ids;
+	st->ids			= st->front_ids;
+	st->front_ids		= (unsigned int*)tmp;
+	i			= st->max_points;
+	st->max_points		= st->max_front_points;
+	st->max_front_points	= i;
+	i			= st->max_ids;
+	st->max_ids		= st->max_front_ids;
+	st->max_front_ids	= i;
+	tmp			= st->frontier;
+	st->frontier		= st->next_frontier;
+	st->next_frontier	= (unsigned int*)tmp;
+	i			= st->max_frontier;
+	st->max_frontier	= st->max_next_frontier;
+	st->max_next_frontier	= i;
+	st->num_frontier	= st->num_next_frontier;
+	st->num_front		= k;
+
+	return num_tris;
+}
+
+unsigned int tri_delaunay2d_stream(del_stream_read_t read, del_stream_write_t write, void *user, size_t budget) {
+	del_stream_t		st;
+	unsigned int		capacity, chunk, n, i, total;
+	real			s;
+
+	memset(&st, 0, sizeof(del_stream_t));
+	del_context_init( &st.ctx );
+
+	capacity	= (budget / DEL_STREAM_POINT_SIZE < DEL_STREAM_MIN_POINTS) ? DEL_STREAM_MIN_POINTS : (unsigned int)(budget / DEL_STREAM_POINT_SIZE);
+	total		= 0;
+	s		= -DBL_MAX;
+
+	for( ;; )
+	{
+		/* the budget left by the front, a quarter of it at least */
+		chunk		= (st.num_front + capacity / 4 < capacity) ? capacity - st.num_front : capacity / 4;
+		st.points	= (del_point2d_t*)del_grow(st.points, &st.max_points, st.num_front + chunk, sizeof(del_point2d_t));
+		st.ids		= (unsigned int*)del_grow(st.ids, &st.max_ids, st.num_front + chunk, sizeof(unsigned int));
+
+		n	= read(user, st.points + st.num_front, chunk);
+
+		if( n == 0 ) {
+			del_stream_build( &st, st.num_front, s, 1, write, user );
+			break;
+		}
+
+		/* more points than asked, or than the ids can count */
+		if( n > chunk || n > DEL_STREAM_MAX_POINTS - total ) {
+			total	= DEL_NIL;
+			break;
+		}
+
+		/* the faces left of s are final: a point left of it (or NaN) would
+		   make the written triangles wrong, stop before building it */
+		for( i = 0; i < n; i++ )
+		{
+			if( !(st.points[st.num_front + i].x >= s) )
+				break;
+
+			st.ids[st.num_front + i]	= total + i;
+		}
+
+		if( i < n ) {
+			total	= DEL_NIL;
+			break;
+		}
+
+		for( i = 0; i < n; i++ )
+			s	= (st.points[st.num_front + i].x > s) ? st.points[st.num_front + i].x : s;
+
+		total	+= n;
+		del_stream_build( &st, st.num_front + n, s, 0, write, user );
+	}
+
+	del_context_free( &st.ctx );
+	free(st.points);
+	free(st.ids);
+	free(st.front_points);
+	free(st.front_ids);
+	free(st.frontier);
+	free(st.next_frontier);
+	free(st.map);
+	free(st.he_front);
+	free(st.face_state);
+	free(st.stack);
+	free(st.tris);
+
+	return total;
+}
+
+/*
+* find the triangle across each triangle edge, through the triangles around
+* each vertex, and a corner of each vertex
+*/
+static void del_tri_neighbors( const tri_delaunay2d_t *tdel, unsigned int *neighbors, unsigned int *vert_corners )
+{
+	const unsigned int	*tris	= tdel->tris;
+	unsigned int		num_corners	= 3 * tdel->num_triangles;
+	unsigned int		*first, *corners;
+	unsigned int		c, d, e, i, j, v, b;
+
+	/* the corners of each vertex, in a compact list */
+	first	= (unsigned int*)malloc((tdel->num_points + 1) * sizeof(unsigned int));
+	assert( NULL != first );
+	corners	= (unsigned int*)malloc(num_corners * sizeof(unsigned int));
+	assert( NULL != corners );
+
+	memset(first, 0, (tdel->num_points + 1) * sizeof(unsigned int));
+	for( c = 0; c < num_corners; c++ )
+		first[tris[c] + 1]++;
+	for( v = 0; v < tdel->num_points; v++ )
+		first[v + 1]	+= first[v];
+	for( c = 0; c < num_corners; c++ )
+		corners[first[tris[c]]++]	= c;
+	for( v = tdel->num_points; v > 0; v-- )
+		first[v]	= first[v - 1];
+	first[0]	= 0;
+
+	memset(neighbors, 0xFF, num_corners * sizeof(unsigned int));
+
+	/* the edge vb leaving a corner is the edge bv arriving at another corner
+	   of v, both are matched at once */
+	for( v = 0; v < tdel->num_points; v++ )
+	{
+		vert_corners[v]	= (first[v] < first[v + 1]) ? corners[first[v]] : DEL_NIL;
+
+		for( i = first[v]; i < first[v + 1]; i++ )
+		{
+			c	= corners[i];
+			if( neighbors[c] != DEL_NIL )
+				continue;
+
+			b	= tris[c - c % 3 + (c + 1) % 3];
+			for( j = first[v]; j < first[v + 1]; j++ )
+			{
+				d	= corners[j];
+				e	= d - d % 3 + (d + 2) % 3;
+				if( tris[e] == b ) {
+					neighbors[c]	= d / 3;
+					neighbors[e]	= c / 3;
+					break;
+				}
+			}
+		}
+	}
+
+	free(corners);
+	free(first);
+}
+
+/*
+* a point locator: the triangles of a tri_delaunay2d_t with their neighbours,
+* to walk from triangle to triangle
+*/
+struct tri_delaunay2d_locator_s {
+	const tri_delaunay2d_t*	tdel;			/* the triangulation, not copied */
+	const unsigned int*	neighbors;		/* triangle across each triangle edge v0v1, v1v2, v2v0 (DEL_NIL on the hull) */
+	unsigned int*		own_neighbors;		/* the neighbours, when the triangulation comes without */
+	unsigned int*		vert_corners;		/* a triangle corner of each point (DEL_NIL when it has none) */
+	int			flat;			/* no triangle with an area: all the points are aligned */
+	unsigned int		num_threads;		/* thread count of the queries, 0 for all the online processors */
+
+	del_curve_key_t*	keys;			/* sorted queries, then the sort buffer */
+	unsigned int		max_keys;		/* capacity of keys */
+};
+
+/*
+* test if a triangulation has no triangle with an area. Colinear hull points
+* can leave flat triangles next to the others, when all the points are
+* aligned there are only flat ones
+*/
+static int del_tri_flat( const tri_delaunay2d_t *tdel )
+{
+	const unsigned int	*t	= tdel->tris;
+	const del_point2d_t	*p	= tdel->points;
+	unsigned int		i;
+
+	for( i = 0; i < tdel->num_triangles; i++, t += 3 )
+		if( classify_coords(DEL_QUERY_PREDICATES, p[t[0]].x, p[t[0]].y, p[t[1]].x, p[t[1]].y, p[t[2]].x, p[t[2]].y) == ON_LEFT )
+			return 0;
+
+	return 1;
+}
+
+tri_delaunay2d_locator_t* tri_delaunay2d_locator_create(const tri_delaunay2d_t* tdel) {
+	tri_delaunay2d_locator_t*	loc	= (tri_delaunay2d_locator_t*)malloc(sizeof(tri_delaunay2d_locator_t));
+	unsigned int			c;
+
+	assert( NULL != loc );
+	memset(loc, 0, sizeof(tri_delaunay2d_locator_t));
+	loc->num_threads	= del_num_threads;
+
+	loc->tdel	= tdel;
+	loc->flat	= del_tri_flat( tdel );
+
+	if( !loc->flat ) {
+		loc->vert_corners	= (unsigned int*)malloc(tdel->num_points * sizeof(unsigned int));
+		assert( NULL != loc->vert_corners );
+
+		if( tdel->neighbors != NULL ) {
+			/* the neighbours of the triangulation are used as they are, any
+			   corner of a point will do */
+			loc->neighbors	= tdel->neighbors;
+			memset(loc->vert_corners, 0xFF, tdel->num_points * sizeof(unsigned int));
+			for( c = 0; c < 3 * tdel->num_triangles; c++ )
+				loc->vert_corners[tdel->tris[c]]	= c;
+		} else {
+			loc->own_neighbors	= (unsigned int*)malloc(3 * tdel->num_triangles * sizeof(unsigned int));
+			assert( NULL != loc->own_neighbors );
+			del_tri_neighbors( tdel, loc->own_neighbors, loc->vert_corners );
+			loc->neighbors	= loc->own_neighbors;
+		}
+	}
+
+	return loc;
+}
+
+void tri_delaunay2d_locator_release(tri_delaunay2d_locator_t* loc) {
+	free(loc->own_neighbors);
+	free(loc->vert_corners);
+	free(loc->keys);
+	free(loc);
+}
+
+/*
+* a stretch of sorted queries, located on its own thread
+*/
+typedef struct {
+	const tri_delaunay2d_locator_t	*loc;
+	const del_point2d_t	*queries;		/* the queries, in input order */
+	unsigned int		*out;			/* triangle, or nearest point, of each query */
+	int			nearest;		/* look for the nearest points instead of the triangles */
+	unsigned int		start;			/* first sorted query */
+	unsigned int		end;			/* last sorted query + 1 */
+	unsigned int		num_found;		/* queries inside a triangle */
+} del_locate_task_t;
+
+/*
+* jump: the triangle whose first vertex is the closest to a point, out of
+* about cbrt(n) triangles spread over the triangulation
+*/
+static unsigned int del_locate_jump( const tri_delaunay2d_locator_t *loc, const del_point2d_t *p )
+{
+	const tri_delaunay2d_t	*tdel	= loc->tdel;
+	unsigned int		step	= 1;
+	unsigned int		best	= 0;
+	real			best_dist, dx, dy;
+	unsigned int		t;
+
+	while( step * step * step < tdel->num_triangles )
+		step++;
+	step	= tdel->num_triangles / step;
+
+	best_dist	= -1.0;
+	for( t = 0; t < tdel->num_triangles; t += step )
+	{
+		dx	= tdel->points[tdel->tris[3 * t]].x - p->x;
+		dy	= tdel->points[tdel->tris[3 * t]].y - p->y;
+		if( best_dist < 0.0 || dx * dx + dy * dy < best_dist ) {
+			best_dist	= dx * dx + dy * dy;
+			best		= t;
 		}
+	}
 
-		assert( v != u && "1: floating point precision error");
-		if( v != lv && v != rv && in_circle(lv, rv, u, v) == ON_CIRCLE )
+	return best;
+}
+
+/*
+* walk: cross the edges that have the point on their right until the
+* triangle holds it. Returns the last triangle, inside tells if it holds the
+* point or if the walk came out of the hull
+*/
+static unsigned int del_locate_walk( const tri_delaunay2d_locator_t *loc, unsigned int t, const del_point2d_t *p, int *inside )
+{
+	const unsigned int	*tris	= loc->tdel->tris;
+	const del_point2d_t	*pts	= loc->tdel->points;
+	unsigned int		from	= t;
+	unsigned int		i, c;
+	const del_point2d_t	*a, *b;
+
+	for( ;; ) {
+		for( i = 0; i < 3; i++ )
 		{
-			du	= du->next;
-			del_remove_edge(b);
+			c	= 3 * t + i;
+			if( loc->neighbors[c] == from )
+				continue;
+
+			a	= &(pts[tris[c]]);
+			b	= &(pts[tris[3 * t + (i + 1) % 3]]);
+			/* the query points are not integers under the integer predicates */
+			if( classify_coords(DEL_QUERY_PREDICATES, a->x, a->y, b->x, b->y, p->x, p->y) == ON_RIGHT )
+				break;
 		}
-	} else
-		du	= dd;
 
-	assert(du->pair);
-	return du;
+		if( i == 3 ) {
+			*inside	= 1;
+			return t;
+		}
+
+		if( loc->neighbors[c] == DEL_NIL ) {
+			*inside	= 0;
+			return t;
+		}
+
+		from	= t;
+		t	= loc->neighbors[c];
+	}
 }
 
+/*
+* corner of a vertex in a triangle
+*/
+static unsigned int del_tri_corner( const unsigned int *tris, unsigned int t, unsigned int v )
+{
+	return 3 * t + ((tris[3 * t] == v) ? 0 : ((tris[3 * t + 1] == v) ? 1 : 2));
+}
 
 /*
-* validate a link
+* greedy walk on the Delaunay graph: move to the neighbour closest to the
+* point while it is closer than the current vertex. A vertex that is not the
+* nearest to the point always has a closer neighbour
 */
-static halfedge_t* del_valid_link( halfedge_t *b )
+static unsigned int del_nearest_walk( const tri_delaunay2d_locator_t *loc, unsigned int v, const del_point2d_t *p )
 {
-	point2d_t	*g, *g_p, *d, *d_p;
-	halfedge_t	*gd, *dd, *new_gd, *new_dd;
-	int		a;
+	const unsigned int	*tris	= loc->tdel->tris;
+	const del_point2d_t	*pts	= loc->tdel->points;
+	unsigned int		best, c, t, k, u, w;
+	real			best_dist, dx, dy;
+
+	dx		= pts[v].x - p->x;
+	dy		= pts[v].y - p->y;
+	best_dist	= dx * dx + dy * dy;
+
+	for( ;; ) {
+		best	= v;
+
+		/* turn around v through the edges leaving it, then, when the
+		   turn stops on the hull, the other way through the edges
+		   arriving at it */
+		c	= loc->vert_corners[v];
+		do {
+			t	= c / 3;
+			k	= c % 3;
+			w	= tris[3 * t + (k + 1) % 3];
+			dx	= pts[w].x - p->x;
+			dy	= pts[w].y - p->y;
+			if( dx * dx + dy * dy < best_dist ) {
+				best		= w;
+				best_dist	= dx * dx + dy * dy;
+			}
 
-	g	= b->vertex;
-	gd	= del_valid_left(b);
-	g_p	= gd->vertex;
+			u	= loc->neighbors[c];
+			c	= (u == DEL_NIL) ? DEL_NIL : del_tri_corner(tris, u, v);
+		} while( c != DEL_NIL && c != loc->vert_corners[v] );
+
+		c	= (c == DEL_NIL) ? loc->vert_corners[v] : DEL_NIL;
+		while( c != DEL_NIL ) {
+			t	= c / 3;
+			k	= c % 3;
+			w	= tris[3 * t + (k + 2) % 3];
+			dx	= pts[w].x - p->x;
+			dy	= pts[w].y - p->y;
+			if( dx * dx + dy * dy < best_dist ) {
+				best		= w;
+				best_dist	= dx * dx + dy * dy;
+			}
 
-	assert(b->pair);
-	d	= b->pair->vertex;
-	dd	= del_valid_right(b);
-	d_p	= dd->vertex;
-	assert(b->pair);
+			u	= loc->neighbors[3 * t + (k + 2) % 3];
+			c	= (u == DEL_NIL) ? DEL_NIL : del_tri_corner(tris, u, v);
+		}
 
-	if( g != g_p && d != d_p ) {
-		a	= in_circle(g, d, g_p, d_p);
+		if( best == v )
+			return v;
 
-		if( a != ON_CIRCLE ) {
-			if( a == INSIDE ) {
-				g_p	= g;
-				gd	= b;
-			} else {
-				d_p = d;
-				dd	= b->pair;
-			}
+		v	= best;
+	}
+}
+
+/*
+* locate a range of sorted queries, each walk starts where the previous ended
+*/
+static void* del_locate_task_run( void *arg )
+{
+	del_locate_task_t	*task	= (del_locate_task_t*)arg;
+	const del_point2d_t	*q;
+	unsigned int		i, t, v, idx;
+	int			inside;
+
+	task->num_found	= 0;
+	if( task->start == task->end )
+		return NULL;
+
+	t	= del_locate_jump(task->loc, &(task->queries[task->loc->keys[task->start].idx]));
+	v	= task->loc->tdel->tris[3 * t];
+	for( i = task->start; i < task->end; i++ )
+	{
+		idx	= task->loc->keys[i].idx;
+		q	= &(task->queries[idx]);
+
+		if( task->nearest ) {
+			v		= del_nearest_walk(task->loc, v, q);
+			task->out[idx]	= v;
+		} else {
+			t		= del_locate_walk(task->loc, t, q, &inside);
+			task->out[idx]	= inside ? t : DEL_NIL;
+			task->num_found	+= inside;
 		}
 	}
 
-	/* create the 2 halfedges */
-	new_gd	= halfedge_alloc();
-	new_dd	= halfedge_alloc();
+	return NULL;
+}
 
-	/* setup new_gd and new_dd */
+/*
+* sort the queries along the Hilbert curve of their bounding box
+*/
+static void del_sort_queries( tri_delaunay2d_locator_t *loc, const del_point2d_t *queries, unsigned int num_queries )
+{
+	del_curve_key_t		*src, *dst;
+	real			min_x, min_y, max_x, max_y, sx, sy;
+	unsigned int		i;
+
+	loc->keys	= (del_curve_key_t*)del_reserve(loc->keys, &loc->max_keys, 2 * num_queries, sizeof(del_curve_key_t));
+	src		= loc->keys;
+	dst		= loc->keys + num_queries;
+
+	min_x	= max_x	= queries[0].x;
+	min_y	= max_y	= queries[0].y;
+	for( i = 1; i < num_queries; i++ )
+	{
+		min_x	= queries[i].x < min_x ? queries[i].x : min_x;
+		max_x	= queries[i].x > max_x ? queries[i].x : max_x;
+		min_y	= queries[i].y < min_y ? queries[i].y : min_y;
+		max_y	= queries[i].y > max_y ? queries[i].y : max_y;
+	}
 
-	new_gd->vertex	= gd->vertex;
-	new_gd->pair	= new_dd;
-	new_gd->prev	= gd;
-	new_gd->next	= gd->next;
-	gd->next->prev	= new_gd;
-	gd->next		= new_gd;
+	sx	= (max_x > min_x) ? 65535.0 / (max_x - min_x) : 0.0;
+	sy	= (max_y > min_y) ? 65535.0 / (max_y - min_y) : 0.0;
 
-	new_dd->vertex	= dd->vertex;
-	new_dd->pair	= new_gd;
-	new_dd->prev	= dd->prev;
-	dd->prev->next	= new_dd;
-	new_dd->next	= dd;
-	dd->prev		= new_dd;
+	for( i = 0; i < num_queries; i++ )
+	{
+		src[i].key	= del_hilbert_key((unsigned int)((queries[i].x - min_x) * sx), (unsigned int)((queries[i].y - min_y) * sy));
+		src[i].idx	= i;
+	}
 
-	return new_gd;
+	del_sort_curve_keys( src, dst, num_queries );
 }
 
 /*
-* find the lower tangent between the two delaunay, going from left to right (returns the left half edge)
+* sort a batch of queries, and split it along the curve over the threads.
+* Returns the number of queries inside a triangle
 */
-static halfedge_t* del_get_lower_tangent( delaunay_t *left, delaunay_t *right )
+static unsigned int del_locate_batch( tri_delaunay2d_locator_t *loc, const del_point2d_t *queries, unsigned int num_queries, unsigned int *out, int nearest )
 {
-	point2d_t	*pl, *pr;
-	halfedge_t	*right_d, *left_d, *new_ld, *new_rd;
-	int		sl, sr;
+	del_locate_task_t	tasks[DEL_MAX_THREADS];
+	unsigned int		num_threads	= del_threads(loc->num_threads);
+	unsigned int		chunk, num_found, t;
 
-	left_d	= left->rightmost_he;
-	right_d	= right->leftmost_he;
+	del_sort_queries( loc, queries, num_queries );
 
-	do {
-		pl		= left_d->prev->pair->vertex;
-		pr		= right_d->pair->vertex;
+	num_threads	= (num_queries < DEL_PARALLEL_CUTOFF) ? 1 : num_threads;
+	if( num_threads > DEL_MAX_THREADS )
+		num_threads	= DEL_MAX_THREADS;
+	chunk		= (num_queries + num_threads - 1) / num_threads;
 
-		if( (sl = classify_point_seg(left_d->vertex, right_d->vertex, pl)) == ON_RIGHT ) {
-			left_d	= left_d->prev->pair;
-		}
+	/* each thread takes a stretch of the curve */
+	for( t = 0; t < num_threads; t++ )
+	{
+		tasks[t].loc		= loc;
+		tasks[t].queries	= queries;
+		tasks[t].out		= out;
+		tasks[t].nearest	= nearest;
+		tasks[t].start		= (t * chunk < num_queries) ? t * chunk : num_queries;
+		tasks[t].end		= ((t + 1) * chunk < num_queries) ? (t + 1) * chunk : num_queries;
+	}
 
-		if( (sr = classify_point_seg(left_d->vertex, right_d->vertex, pr)) == ON_RIGHT ) {
-			right_d	= right_d->pair->next;
-		}
+	del_run_tasks( tasks, sizeof(del_locate_task_t), num_threads, del_locate_task_run );
 
-	} while( sl == ON_RIGHT || sr == ON_RIGHT );
+	num_found	= 0;
+	for( t = 0; t < num_threads; t++ )
+		num_found	+= tasks[t].num_found;
 
-	/* create the 2 halfedges */
-	new_ld	= halfedge_alloc();
-	new_rd	= halfedge_alloc();
+	return num_found;
+}
 
-	/* setup new_gd and new_dd */
-	new_ld->vertex	= left_d->vertex;
-	new_ld->pair	= new_rd;
-	new_ld->prev	= left_d->prev;
-	left_d->prev->next	= new_ld;
-	new_ld->next	= left_d;
-	left_d->prev	= new_ld;
-
-	new_rd->vertex	= right_d->vertex;
-	new_rd->pair	= new_ld;
-	new_rd->prev	= right_d->prev;
-	right_d->prev->next	= new_rd;
-	new_rd->next	= right_d;
-	right_d->prev	= new_rd;
+unsigned int tri_delaunay2d_locate(tri_delaunay2d_locator_t* loc, const del_point2d_t *queries, unsigned int num_queries, unsigned int *tris) {
+	if( loc->flat || num_queries == 0 ) {
+		memset(tris, 0xFF, num_queries * sizeof(unsigned int));
+		return 0;
+	}
 
-	return new_ld;
+	return del_locate_batch( loc, queries, num_queries, tris, 0 );
+}
+
+void tri_delaunay2d_nearest(tri_delaunay2d_locator_t* loc, const del_point2d_t *queries, unsigned int num_queries, unsigned int *sites) {
+	const tri_delaunay2d_t	*tdel	= loc->tdel;
+	unsigned int		i, v;
+	real			best_dist, dx, dy;
+
+	if( num_queries == 0 )
+		return;
+
+	if( !loc->flat ) {
+		del_locate_batch( loc, queries, num_queries, sites, 1 );
+		return;
+	}
+
+	/* aligned points have no triangle to walk on, they are all tested */
+	for( i = 0; i < num_queries; i++ )
+	{
+		best_dist	= -1.0;
+		for( v = 0; v < tdel->num_points; v++ )
+		{
+			dx	= tdel->points[v].x - queries[i].x;
+			dy	= tdel->points[v].y - queries[i].y;
+			if( best_dist < 0.0 || dx * dx + dy * dy < best_dist ) {
+				best_dist	= dx * dx + dy * dy;
+				sites[i]	= v;
+			}
+		}
+	}
 }
 
 /*
-* link the 2 delaunay together
+* order points on x, then on y
 */
-static void del_link( delaunay_t *result, delaunay_t *left, delaunay_t *right )
+static int cmp_points( const void *_pt0, const void *_pt1 )
 {
-	point2d_t		*u, *v, *ml, *mr;
-	halfedge_t		*base;
+	const point2d_t		*pt0, *pt1;
 
-	assert( left->points == right->points );
+	pt0	= (const point2d_t*)(_pt0);
+	pt1	= (const point2d_t*)(_pt1);
 
-	/* save the most right point and the most left point */
-	ml		= left->leftmost_he->vertex;
-	mr		= right->rightmost_he->vertex;
+	if( pt0->x < pt1->x )
+		return -1;
+	else if( pt0->x > pt1->x )
+		return 1;
+	else if( pt0->y < pt1->y )
+		return -1;
+	else if( pt0->y > pt1->y )
+		return 1;
+	return 0;
+}
 
-	base		= del_get_lower_tangent(left, right);
+/*
+* nearest other point of aligned points: one of the points next to it along
+* the line
+*/
+static void del_aligned_nearest( const tri_delaunay2d_t *tdel, unsigned int *nearest )
+{
+	const del_point2d_t	*pts	= tdel->points;
+	point2d_t		*line;
+	real			dx, dy, dist, next_dist;
+	unsigned int		i;
 
-	u		= base->next->pair->vertex;
-	v		= base->pair->prev->pair->vertex;
+	line	= (point2d_t*)malloc(tdel->num_points * sizeof(point2d_t));
+	assert( NULL != line );
 
-	while( del_classify_point(base, u) == ON_LEFT ||
-	       del_classify_point(base, v) == ON_LEFT )
+	for( i = 0; i < tdel->num_points; i++ )
 	{
-		base	= del_valid_link(base);
-		u	= base->next->pair->vertex;
-		v	= base->pair->prev->pair->vertex;
+		line[i].x	= pts[i].x;
+		line[i].y	= pts[i].y;
+		line[i].idx	= i;
 	}
 
-	right->rightmost_he	= mr->he;
-	left->leftmost_he	= ml->he;
+	qsort(line, tdel->num_points, sizeof(point2d_t), cmp_points);
 
-	/* TODO: this part is not needed, and can be optimized */
-	while( del_classify_point( right->rightmost_he, right->rightmost_he->prev->pair->vertex ) == ON_RIGHT )
-	       right->rightmost_he	= right->rightmost_he->prev;
+	dist	= -1.0;
+	for( i = 0; i < tdel->num_points; i++ )
+	{
+		next_dist	= -1.0;
+		if( i + 1 < tdel->num_points ) {
+			dx		= line[i + 1].x - line[i].x;
+			dy		= line[i + 1].y - line[i].y;
+			next_dist	= dx * dx + dy * dy;
+		}
 
-	while( del_classify_point( left->leftmost_he, left->leftmost_he->prev->pair->vertex ) == ON_RIGHT )
-	       left->leftmost_he	= left->leftmost_he->prev;
+		if( next_dist < 0.0 || (dist >= 0.0 && dist <= next_dist) )
+			nearest[line[i].idx]	= line[i - 1].idx;
+		else
+			nearest[line[i].idx]	= line[i + 1].idx;
 
-	result->leftmost_he		= left->leftmost_he;
-	result->rightmost_he		= right->rightmost_he;
-	result->points			= left->points;
-	result->start_point		= left->start_point;
-	result->end_point		= right->end_point;
+		dist	= next_dist;
+	}
+
+	free(line);
 }
 
 /*
-* divide and conquer delaunay
+* nearest point of the duplicate points, that no triangle refers to: the point
+* at the same coordinates that the triangles refer to
 */
-void del_divide_and_conquer( delaunay_t *del, int start, int end )
+static void del_duplicate_nearest( const tri_delaunay2d_t *tdel, unsigned int *nearest )
 {
-	delaunay_t	left, right;
-	int			i, n;
+	const del_point2d_t	*pts	= tdel->points;
+	point2d_t		*line;
+	unsigned int		i, j, end, rep;
 
-	n		= (end - start + 1);
+	line	= (point2d_t*)malloc(tdel->num_points * sizeof(point2d_t));
+	assert( NULL != line );
 
-	if( n > 3 ) {
-		i		= (n / 2) + (n & 1);
-		left.points		= del->points;
-		right.points	= del->points;
-		del_divide_and_conquer( &left, start, start + i - 1 );
-		del_divide_and_conquer( &right, start + i, end );
-		del_link( del, &left, &right );
-	} else {
-		if( n == 3 ) {
-			del_init_tri( del, start );
-		} else {
-			if( n == 2 ) {
-				del_init_seg( del, start );
-			}
-		}
+	for( i = 0; i < tdel->num_points; i++ )
+	{
+		line[i].x	= pts[i].x;
+		line[i].y	= pts[i].y;
+		line[i].idx	= i;
+	}
+
+	qsort(line, tdel->num_points, sizeof(point2d_t), cmp_points);
+
+	for( i = 0; i < tdel->num_points; i = end )
+	{
+		/* the run of points at the same coordinates, and the one that is
+		   triangulated (the first one when none is) */
+		rep	= line[i].idx;
+		for( end = i + 1; end < tdel->num_points && cmp_points(&line[i], &line[end]) == 0; end++ )
+			if( nearest[line[end].idx] != DEL_NIL )
+				rep	= line[end].idx;
+
+		if( end - i < 2 )
+			continue;
+
+		for( j = i; j < end; j++ )
+			if( nearest[line[j].idx] == DEL_NIL )
+				nearest[line[j].idx]	= (line[j].idx == rep) ? line[j == i ? i + 1 : i].idx : rep;
 	}
+
+	free(line);
 }
 
-static void build_halfedge_face( delaunay_t *del, halfedge_t *d )
-{
-	halfedge_t	*curr;
+void tri_delaunay2d_all_nearest(const tri_delaunay2d_t* tdel, unsigned int *nearest) {
+	const unsigned int	*tris	= tdel->tris;
+	const del_point2d_t	*pts	= tdel->points;
+	real			*dist;
+	real			dx, dy, d;
+	unsigned int		c, a, b;
 
-	/* test if the halfedge has already a pointing face */
-	if( d->face != NULL )
+	memset(nearest, 0xFF, tdel->num_points * sizeof(unsigned int));
+
+	if( tdel->num_points >= 2 && del_tri_flat(tdel) ) {
+		del_aligned_nearest( tdel, nearest );
 		return;
+	}
 
-	/* TODO: optimize this */
-	del->faces = (face_t*)realloc(del->faces, (del->num_faces + 1) * sizeof(face_t));
-	assert( NULL != del->faces );
+	dist	= (real*)malloc(tdel->num_points * sizeof(real));
+	assert( NULL != dist );
 
-	face_t	*f	= &(del->faces[del->num_faces]);
-	curr	= d;
-	f->he	= d;
-	f->num_verts	= 0;
-	do {
-		curr->face	= f;
-		(f->num_verts)++;
-		curr	= curr->pair->prev;
-	} while( curr != d );
+	/* the nearest neighbour graph is part of the Delaunay graph: one pass
+	   over the triangle edges (flat triangles included) is enough */
+	for( c = 0; c < 3 * tdel->num_triangles; c++ )
+	{
+		a	= tris[c];
+		b	= tris[c - c % 3 + (c + 1) % 3];
+		if( a == b )
+			continue;
+
+		dx	= pts[a].x - pts[b].x;
+		dy	= pts[a].y - pts[b].y;
+		d	= dx * dx + dy * dy;
+
+		if( nearest[a] == DEL_NIL || d < dist[a] ) {
+			nearest[a]	= b;
+			dist[a]		= d;
+		}
 
-	(del->num_faces)++;
+		if( nearest[b] == DEL_NIL || d < dist[b] ) {
+			nearest[b]	= a;
+			dist[b]		= d;
+		}
+	}
+
+	free(dist);
+
+	for( c = 0; c < tdel->num_points; c++ )
+		if( nearest[c] == DEL_NIL ) {
+			del_duplicate_nearest( tdel, nearest );
+			break;
+		}
 }
 
 /*
-* build the faces for all the halfedge
+* header of the point and triangulation files, little endian. The points
+* (2 doubles each) follow it, then the triangles (3 uint32 each), then their
+* neighbours when the flags say so
+*/
+typedef struct {
+	char			magic[4];		/* DEL_FILE_MAGIC */
+	uint32_t		version;		/* DEL_FILE_VERSION */
+	uint32_t		flags;			/* DEL_FILE_NEIGHBORS */
+	uint32_t		num_points;		/* point count */
+	uint32_t		num_triangles;		/* triangle count, 0 for a point file */
+	uint32_t		reserved[3];		/* 0, the points start 8 bytes aligned */
+} del_file_header_t;
+
+struct del_file_s {
+	tri_delaunay2d_t	tdel;			/* the points and triangles, in the mapping */
+	void*			base;			/* the mapping */
+	size_t			size;			/* mapping size */
+};
+
+/*
+* size of a file, its arrays are mapped as they are so the host must be little
+* endian
 */
-void del_build_faces( delaunay_t *del )
+static size_t del_file_size( unsigned int num_points, unsigned int num_triangles, int neighbors )
 {
-	unsigned int	i;
-	halfedge_t	*curr;
+	return sizeof(del_file_header_t) + (size_t)num_points * sizeof(del_point2d_t) +
+		(size_t)num_triangles * 3 * sizeof(unsigned int) * (neighbors ? 2 : 1);
+}
 
-	del->num_faces	= 0;
-	del->faces		= NULL;
+static int del_little_endian( void )
+{
+	const uint32_t	one	= 1;
 
-	/* build external face first */
-	build_halfedge_face(del, del->rightmost_he->pair);
+	return *(const unsigned char*)&one == 1;
+}
 
-	for( i = del->start_point; i <= del->end_point; i++ )
-	{
-		curr	= del->points[i].he;
+/*
+* point the views of a file to its arrays
+*/
+static void del_file_views( del_file_t *file )
+{
+	del_file_header_t	*h	= (del_file_header_t*)file->base;
 
-		do {
-			build_halfedge_face( del, curr );
-			curr	= curr->next;
-		} while( curr != del->points[i].he );
-	}
+	file->tdel.num_points		= h->num_points;
+	file->tdel.points		= (del_point2d_t*)((char*)file->base + sizeof(del_file_header_t));
+	file->tdel.num_triangles	= h->num_triangles;
+	file->tdel.tris			= (unsigned int*)(file->tdel.points + h->num_points);
+	file->tdel.neighbors		= (h->flags & DEL_FILE_NEIGHBORS) ? file->tdel.tris + 3 * (size_t)h->num_triangles : NULL;
 }
 
 /*
+* test if the arrays of a file can be used as they are: the triangles refer to
+* its points, and the neighbours to its triangles, both ways. The geometry is
+* not checked
 */
-delaunay2d_t* delaunay2d_from(del_point2d_t *points, unsigned int num_points) {
-	delaunay2d_t*	res	= NULL;
-	delaunay_t	del;
-	unsigned int	i, j, fbuff_size = 0;
-	unsigned int*	faces	= NULL;
+static int del_file_valid( const del_file_t *file )
+{
+	const tri_delaunay2d_t	*tdel	= &file->tdel;
+	const unsigned int	*nb	= tdel->neighbors;
+	unsigned int		c, n;
 
-	/* allocate the points */
-	del.points	= (point2d_t*)malloc(num_points * sizeof(point2d_t));
-	assert( NULL != del.points );
-	memset(del.points, 0, num_points * sizeof(point2d_t));
+	for( c = 0; c < 3 * tdel->num_triangles; c++ )
+		if( tdel->tris[c] >= tdel->num_points )
+			return 0;
 
-	/* copy the points */
-	for( i = 0; i < num_points; i++ )
+	if( nb == NULL )
+		return 1;
+
+	for( c = 0; c < 3 * tdel->num_triangles; c++ )
 	{
-		del.points[i].idx	= i;
-		del.points[i].x	= points[i].x;
-		del.points[i].y	= points[i].y;
+		n	= nb[c];
+		if( n == DEL_NIL )
+			continue;
+
+		if( n >= tdel->num_triangles || (nb[3 * n] != c / 3 && nb[3 * n + 1] != c / 3 && nb[3 * n + 2] != c / 3) )
+			return 0;
 	}
 
-	qsort(del.points, num_points, sizeof(point2d_t), cmp_points);
+	return 1;
+}
 
-	if( num_points >= 3 ) {
-		del_divide_and_conquer( &del, 0, num_points - 1 );
+del_file_t* del_file_open(const char *path) {
+	del_file_t*		file;
+	del_file_header_t	*h;
+	struct stat		st;
+	void			*base;
+	int			fd;
 
-		del_build_faces( &del );
+	if( !del_little_endian() )
+		return NULL;
 
-		fbuff_size	= 0;
-		for( i = 0; i < del.num_faces; i++ )
-			fbuff_size	+= del.faces[i].num_verts + 1;
+	fd	= open(path, O_RDONLY);
+	if( fd < 0 )
+		return NULL;
 
-		faces = (unsigned int*)malloc(sizeof(unsigned int) * fbuff_size);
-		assert( NULL != faces );
+	if( fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(del_file_header_t) ) {
+		close(fd);
+		return NULL;
+	}
 
-		j = 0;
-		for( i = 0; i < del.num_faces; i++ )
-		{
-			halfedge_t	*curr;
+	base	= mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if( base == MAP_FAILED )
+		return NULL;
 
-			faces[j]	= del.faces[i].num_verts;
-			j++;
+	h	= (del_file_header_t*)base;
+	if( memcmp(h->magic, DEL_FILE_MAGIC, 4) != 0 || h->version != DEL_FILE_VERSION ||
+	    (size_t)st.st_size != del_file_size(h->num_points, h->num_triangles, h->flags & DEL_FILE_NEIGHBORS) ) {
+		munmap(base, (size_t)st.st_size);
+		return NULL;
+	}
 
-			curr	= del.faces[i].he;
-			do {
-				faces[j]	= curr->vertex->idx;
-				j++;
-				curr	= curr->pair->prev;
-			} while( curr != del.faces[i].he );
-		}
+	file	= (del_file_t*)malloc(sizeof(del_file_t));
+	assert( NULL != file );
+
+	file->base	= base;
+	file->size	= (size_t)st.st_size;
+	del_file_views( file );
 
-		del_free_halfedges( &del );
+	/* the arrays are read once, in order */
+	madvise(base, file->size, MADV_SEQUENTIAL);
 
-		free(del.faces);
-		free(del.points);
+	/* the consumers index the points and triangles with them */
+	if( !del_file_valid( file ) ) {
+		del_file_close( file );
+		return NULL;
 	}
 
-	res		= (delaunay2d_t*)malloc(sizeof(delaunay2d_t));
-	assert( NULL != res );
-	res->num_points	= num_points;
-	res->points	= (del_point2d_t*)malloc(sizeof(del_point2d_t) * num_points);
-	assert( NULL != res->points );
-	memcpy(res->points, points, sizeof(del_point2d_t) * num_points);
-	res->num_faces	= del.num_faces;
-	res->faces	= faces;
+	return file;
+}
 
-	return res;
+const tri_delaunay2d_t* del_file_triangles(const del_file_t *file) {
+	return &file->tdel;
 }
 
-void delaunay2d_release(delaunay2d_t *del) {
-	free(del->faces);
-	free(del->points);
-	free(del);
+const unsigned int* del_file_neighbors(const del_file_t *file) {
+	return file->tdel.neighbors;
 }
 
+void del_file_close(del_file_t *file) {
+	munmap(file->base, file->size);
+	free(file);
+}
 
-tri_delaunay2d_t* tri_delaunay2d_from(delaunay2d_t* del) {
-	unsigned int		v_offset	= del->faces[0] + 1;	/* ignore external face */
-	unsigned int		dst_offset	= 0;
-	unsigned int		i;
+/*
+* create a file for a given layout and map it writable, the header holds the
+* counts. Returns the mapping, NULL when the file can't be created
+*/
+static void* del_file_create( const char *path, unsigned int num_points, unsigned int num_triangles, int neighbors, size_t size )
+{
+	del_file_header_t	*h;
+	void			*base;
+	int			fd;
 
-	tri_delaunay2d_t*	tdel = (tri_delaunay2d_t*)malloc(sizeof(tri_delaunay2d_t));
-	assert( NULL != tdel );
-	tdel->num_triangles	= 0;
+	if( !del_little_endian() )
+		return NULL;
 
-	/* count the number of triangles */
-	if( 1 == del->num_faces ) { /* degenerate case: only external face exists */
-		unsigned int	nv	= del->faces[0];
-		tdel->num_triangles	+= nv - 2;
-	} else {
-		for( i = 1; i < del->num_faces; ++i ) {
-			unsigned int	nv	= del->faces[v_offset];
-			tdel->num_triangles	+= nv - 2;
-			v_offset		+= nv + 1;
-		}
+	fd	= open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if( fd < 0 )
+		return NULL;
+
+	if( ftruncate(fd, (off_t)size) != 0 ) {
+		close(fd);
+		return NULL;
 	}
 
-	/* copy points */
-	tdel->num_points	= del->num_points;
-	tdel->points		= (del_point2d_t*)malloc(sizeof(del_point2d_t) * del->num_points);
-	assert( NULL != tdel->points );
-	memcpy(tdel->points, del->points, sizeof(del_point2d_t) * del->num_points);
+	base	= mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if( base == MAP_FAILED )
+		return NULL;
 
-	/* build the triangles */
-	tdel->tris		= (unsigned int*)malloc(sizeof(unsigned int) * 3 * tdel->num_triangles);
-	assert( NULL != tdel->tris );
+	h	= (del_file_header_t*)base;
+	memset(h, 0, sizeof(del_file_header_t));
+	memcpy(h->magic, DEL_FILE_MAGIC, 4);
+	h->version		= DEL_FILE_VERSION;
+	h->flags		= neighbors ? DEL_FILE_NEIGHBORS : 0;
+	h->num_points		= num_points;
+	h->num_triangles	= num_triangles;
 
-	v_offset	= del->faces[0] + 1;	/* ignore external face */
+	return base;
+}
 
-	if( 1 == del->num_faces ) {
-		/* handle the degenerated case where only the external face exists */
-		unsigned int	nv	= del->faces[0];
-		unsigned int	j	= 0;
-		v_offset	= 1;
-		for( ; j < nv - 2; ++j ) {
-			tdel->tris[dst_offset]		= del->faces[v_offset + j];
-			tdel->tris[dst_offset + 1]	= del->faces[(v_offset + j + 1) % nv];
-			tdel->tris[dst_offset + 2]	= del->faces[v_offset + j];
-			dst_offset	+= 3;
-		}
-	} else {
-		for( i = 1; i < del->num_faces; ++i ) {
-			unsigned int	nv	= del->faces[v_offset];
-			unsigned int	j	= 0;
-			unsigned int	first	= del->faces[v_offset + 1];
+/*
+* fill the neighbours of the triangles of a file being written
+*/
+static void del_file_neighbors_fill( del_file_t *file )
+{
+	unsigned int	*vert_corners;
 
+	vert_corners	= (unsigned int*)malloc((file->tdel.num_points + 1) * sizeof(unsigned int));
+	assert( NULL != vert_corners );
 
-			for( ; j < nv - 2; ++j ) {
-				tdel->tris[dst_offset]		= first;
-				tdel->tris[dst_offset + 1]	= del->faces[v_offset + j + 2];
-				tdel->tris[dst_offset + 2]	= del->faces[v_offset + j + 3];
-				dst_offset	+= 3;
-			}
+	del_tri_neighbors( &file->tdel, file->tdel.neighbors, vert_corners );
+	free(vert_corners);
+}
 
-			v_offset		+= nv + 1;
-		}
-	}
+int del_file_write_points(const char *path, const del_point2d_t *points, unsigned int num_points) {
+	size_t		size	= del_file_size(num_points, 0, 0);
+	void		*base	= del_file_create(path, num_points, 0, 0, size);
 
-	return tdel;
+	if( base == NULL )
+		return 0;
+
+	memcpy((char*)base + sizeof(del_file_header_t), points, (size_t)num_points * sizeof(del_point2d_t));
+	munmap(base, size);
+
+	return 1;
 }
 
+int tri_delaunay2d_write_file(const tri_delaunay2d_t *tdel, int neighbors, const char *path) {
+	del_file_t	file;
 
-void tri_delaunay2d_release(tri_delaunay2d_t* tdel) {
-	free(tdel->tris);
-	free(tdel->points);
-	free(tdel);
+	file.size	= del_file_size(tdel->num_points, tdel->num_triangles, neighbors);
+	file.base	= del_file_create(path, tdel->num_points, tdel->num_triangles, neighbors, file.size);
+	if( file.base == NULL )
+		return 0;
+
+	del_file_views( &file );
+	memcpy(file.tdel.points, tdel->points, (size_t)tdel->num_points * sizeof(del_point2d_t));
+	memcpy(file.tdel.tris, tdel->tris, (size_t)tdel->num_triangles * 3 * sizeof(unsigned int));
+	if( neighbors && tdel->neighbors != NULL )
+		memcpy(file.tdel.neighbors, tdel->neighbors, (size_t)tdel->num_triangles * 3 * sizeof(unsigned int));
+	else if( neighbors )
+		del_file_neighbors_fill( &file );
+
+	munmap(file.base, file.size);
+
+	return 1;
+}
+
+int tri_delaunay2d_context_file(delaunay2d_context_t *ctx, const del_point2d_t *points, unsigned int num_points, int neighbors, const char *path) {
+	del_file_t		file;
+	unsigned int		num_triangles;
+
+	/* the faces give the exact triangle count, then the triangles (and their
+	   neighbours) are written from the halfedges straight into the file. The
+	   mapping is sized from that count and never grows */
+	DEL_STATS_START(ctx);
+	del_context_build( ctx, points, num_points, del_threads(ctx->num_threads), NULL, 0 );
+	num_triangles	= del_num_triangles(ctx->del.faces, ctx->del.num_faces);
+
+	file.size	= del_file_size(num_points, num_triangles, neighbors);
+	file.base	= del_file_create(path, num_points, num_triangles, neighbors, file.size);
+	if( file.base == NULL )
+		return 0;
+
+	del_file_views( &file );
+	memcpy(file.tdel.points, points, (size_t)num_points * sizeof(del_point2d_t));
+
+	if( neighbors && ctx->del.num_faces > 0 )
+		del_export_neighbors( ctx, file.tdel.tris, file.tdel.neighbors );
+	else
+		del_fan_triangles(ctx->del.faces, ctx->del.num_faces, file.tdel.tris);
+
+	munmap(file.base, file.size);
+
+	return 1;
 }
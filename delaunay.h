@@ -23,6 +23,8 @@
 
 
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -46,6 +48,18 @@ typedef struct {
 	/** the faces are given as a sequence: num verts, verts indices, num verts, verts indices...
 	 * the first face is the external face */
 	unsigned int*	faces;
+
+	/** input index of each point when a curve ordering renumbered them, NULL
+	 * when the points are in input order */
+	unsigned int*	indices;
+
+	/** number of input points at the exact coordinate of another one, they
+	 * are left out of the faces */
+	unsigned int	num_duplicates;
+
+	/** representative of each input point: the lowest input index at its
+	 * coordinate (its own index when unique). NULL without duplicates */
+	unsigned int*	representatives;
 } delaunay2d_t;
 
 /*
@@ -65,6 +79,274 @@ delaunay2d_t*			delaunay2d_from(del_point2d_t *points, unsigned int num_points);
  */
 void				delaunay2d_release(delaunay2d_t* del);
 
+typedef struct delaunay2d_context_s	delaunay2d_context_t;
+
+/*
+ * create a build context: it keeps its buffers from one build to the next, once
+ * they have grown to the largest point set a single threaded build does not
+ * allocate. It takes the process wide thread count, predicates and ordering,
+ * delaunay2d_context_set_num_threads() and the like change them for it alone
+ */
+delaunay2d_context_t*		delaunay2d_context_create(void);
+
+/*
+ * release a build context, and the results it holds
+ */
+void				delaunay2d_context_release(delaunay2d_context_t* ctx);
+
+/*
+ * build the 2D Delaunay triangulation with the buffers of a context
+ *
+ * @ctx: the build context
+ * @points: point set given as a sequence of tuple x0, y0, x1, y1, ....
+ * @num_points: number of given point
+ * @return: the created topology, owned by the context and valid until its next
+ *	build (do not call delaunay2d_release on it)
+ */
+delaunay2d_t*			delaunay2d_context_from(delaunay2d_context_t* ctx, del_point2d_t *points, unsigned int num_points);
+
+#ifdef DEL_STATS
+typedef struct {
+	/** seconds spent copying the input points */
+	double		copy;
+
+	/** seconds spent sorting the points */
+	double		sort;
+
+	/** seconds spent in the divide and conquer */
+	double		divide_and_conquer;
+
+	/** seconds spent building the faces (and writing the flat faces output) */
+	double		faces;
+} del_stats_t;
+
+/*
+ * phase timings of the last build of a context (builds compiled with DEL_STATS)
+ */
+void				delaunay2d_context_stats(delaunay2d_context_t* ctx, del_stats_t* stats);
+#endif
+
+/*
+ * size of a faces buffer large enough for any build of a given point count
+ */
+unsigned int			delaunay2d_faces_size(unsigned int num_points);
+
+/*
+ * build the 2D Delaunay faces with the buffers of a context, straight into a
+ * caller buffer. The points are neither copied nor kept
+ *
+ * @ctx: the build context
+ * @points: point set given as a sequence of tuple x0, y0, x1, y1, ....
+ * @num_points: number of given point
+ * @faces: the faces buffer, of delaunay2d_faces_size(num_points) at least
+ * @num_faces: the face count
+ * @return: the used size of the faces buffer, (unsigned int)-1 (and no face)
+ *	when they don't fit in it (the buffer is never overrun)
+ */
+unsigned int			delaunay2d_context_faces(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points, unsigned int *faces, unsigned int *num_faces);
+
+/*
+ * representatives of the points of the last build of a context, for the builds
+ * into caller buffers (see delaunay2d_t)
+ *
+ * @ctx: the build context
+ * @num_duplicates: the number of duplicates
+ * @return: the representative of each input point, NULL without duplicates.
+ *	Valid until the next build of the context
+ */
+const unsigned int*		delaunay2d_context_representatives(delaunay2d_context_t* ctx, unsigned int *num_duplicates);
+
+typedef struct {
+	/** point set */
+	del_point2d_t*	points;
+
+	/** point count */
+	unsigned int	num_points;
+} del_point_set_t;
+
+typedef struct delaunay2d_batch_s	delaunay2d_batch_t;
+
+/*
+ * create a batch: a pool of delaunay2d_num_threads() workers, each with its own
+ * build buffers and output arena. The thread count, predicates and ordering
+ * are the process wide ones at its creation
+ */
+delaunay2d_batch_t*		delaunay2d_batch_create(void);
+
+/*
+ * release a batch, its threads and the results it holds
+ */
+void				delaunay2d_batch_release(delaunay2d_batch_t* batch);
+
+/*
+ * build the 2D Delaunay triangulations of independent point sets, spread
+ * over the batch workers (biggest sets first). The faces go to arenas owned
+ * by the workers, see delaunay2d_batch_into() to give the arena instead
+ *
+ * @batch: the batch
+ * @sets: the point sets
+ * @num_sets: number of point sets
+ * @return: one topology per point set, owned by the batch. They are valid
+ *	until the next delaunay2d_batch_from() or delaunay2d_batch_into() of the
+ *	batch, or its release, whichever comes first. Their points are the given
+ *	ones (not a copy)
+ */
+delaunay2d_t*			delaunay2d_batch_from(delaunay2d_batch_t* batch, del_point_set_t* sets, unsigned int num_sets);
+
+/*
+ * size of the caller arena of delaunay2d_batch_into(), in unsigned int: the
+ * faces of each point set (delaunay2d_faces_size()) and the representatives of
+ * its points
+ */
+size_t				delaunay2d_batch_arena_size(const del_point_set_t* sets, unsigned int num_sets);
+
+/*
+ * build the 2D Delaunay triangulations of independent point sets as
+ * delaunay2d_batch_from() does, into caller memory: each set has its slot in
+ * the arena, in the order of the sets, and the workers write its faces there
+ * without a copy. The results belong to the caller, nothing of the batch is
+ * kept in them, they stay valid as long as the arena
+ *
+ * @batch: the batch
+ * @sets: the point sets
+ * @num_sets: number of point sets
+ * @results: one topology per point set, filled
+ * @arena: delaunay2d_batch_arena_size(sets, num_sets) unsigned int
+ * @return: the count of point sets whose faces didn't fit their slot, 0
+ *	unless failed predicates split a mesh. Those sets have no face
+ */
+unsigned int			delaunay2d_batch_into(delaunay2d_batch_t* batch, del_point_set_t* sets, unsigned int num_sets, delaunay2d_t* results, unsigned int* arena);
+
+typedef struct delaunay2d_mesh_s	delaunay2d_mesh_t;
+
+/*
+ * build a persistent mesh: the halfedges of the triangulation are kept, so
+ * points can be added to it. Its inner faces are triangles
+ *
+ * @points: point set given as a sequence of tuple x0, y0, x1, y1, ....
+ * @num_points: number of given point
+ * @return: the mesh, the points are copied
+ */
+delaunay2d_mesh_t*		delaunay2d_mesh_from(del_point2d_t *points, unsigned int num_points);
+
+/*
+ * release a mesh, and the faces it holds
+ */
+void				delaunay2d_mesh_release(delaunay2d_mesh_t* mesh);
+
+/*
+ * insert a point in a mesh: it is located by a walk from the last inserted
+ * point, and the Delaunay property is restored by flipping the edges around it
+ *
+ * @mesh: the mesh
+ * @point: the new point
+ * @return: the point index (the last removed one, or the point count before
+ *	the insertion), or the index of the point that already has these coordinates
+ */
+unsigned int			delaunay2d_mesh_insert(delaunay2d_mesh_t* mesh, del_point2d_t point);
+
+/*
+ * remove a point from a mesh: its edges go, and the hole is filled with
+ * Delaunay triangles. The point stays in the mesh points, no face refers to it
+ * and its index is reused by the next insertion
+ *
+ * @mesh: the mesh
+ * @index: the point index
+ * @return: 1 if the point was removed, 0 if there is no such point
+ */
+int				delaunay2d_mesh_remove(delaunay2d_mesh_t* mesh, unsigned int index);
+
+/*
+ * faces of a mesh
+ *
+ * @mesh: the mesh
+ * @return: the mesh points and faces, owned by the mesh and valid until its
+ *	next update (do not call delaunay2d_release on it)
+ */
+delaunay2d_t*			delaunay2d_mesh_faces(delaunay2d_mesh_t* mesh);
+
+/*
+ * set the number of threads the divide and conquer can use (1 by default).
+ * Like the predicates and the ordering below, it is a process wide default
+ * taken by the contexts, batches, meshes, locators and one shot builds when
+ * they are created: set it before, it is not synchronised with the builds
+ *
+ * @num_threads: thread count, 0 uses all the online processors
+ */
+void				delaunay2d_set_num_threads(unsigned int num_threads);
+
+/*
+ * number of threads the divide and conquer uses
+ */
+unsigned int			delaunay2d_num_threads(void);
+
+typedef enum {
+	/** orientation and incircle evaluated in long double (default) */
+	DEL_PREDICATES_LONG_DOUBLE	= 0,
+
+	/** double evaluation with an error bound, exact expansion arithmetic when the sign is uncertain */
+	DEL_PREDICATES_FILTERED		= 1,
+
+	/** exact 64 and 128 bits integer evaluation, for integer coordinates within +/- 2^29. A build
+	    with a point that isn't falls back to DEL_PREDICATES_FILTERED */
+	DEL_PREDICATES_INTEGER		= 2
+} del_predicates_t;
+
+/*
+ * select the geometric predicates used by the builds created from now on
+ * (not thread safe, see delaunay2d_set_num_threads()). The point location
+ * queries always use the filtered predicates
+ *
+ * @predicates: the predicates, DEL_PREDICATES_FILTERED is ignored where
+ *	double arithmetic is evaluated in extended precision (x87), and
+ *	DEL_PREDICATES_INTEGER falls back to it without 128 bits integers
+ */
+void				delaunay2d_set_predicates(del_predicates_t predicates);
+
+/*
+ * geometric predicates used by the builds
+ */
+del_predicates_t		delaunay2d_predicates(void);
+
+typedef enum {
+	/** vertices sorted on x then y, the divide and conquer order (default) */
+	DEL_ORDERING_SORTED		= 0,
+
+	/** vertices along a Hilbert curve */
+	DEL_ORDERING_HILBERT		= 1,
+
+	/** vertices along a Morton (Z order) curve */
+	DEL_ORDERING_MORTON		= 2
+} del_ordering_t;
+
+/*
+ * select the order the builds created from now on give their faces (and
+ * triangles) in (not thread safe, see delaunay2d_set_num_threads()): after the
+ * divide and conquer, the vertices are renumbered along the curve and the
+ * halfedges laid out in that order, so the faces come out of a vertex
+ * neighbourhood before moving to the next one.
+ * delaunay2d_from() and delaunay2d_context_from() also give their points in
+ * that order (indices maps them back to the input), the builds into caller
+ * buffers keep the input point indices
+ *
+ * @ordering: the vertex order
+ */
+void				delaunay2d_set_ordering(del_ordering_t ordering);
+
+/*
+ * vertex order of the builds
+ */
+del_ordering_t			delaunay2d_ordering(void);
+
+/*
+ * set the thread count, predicates or ordering of the builds of a context,
+ * whatever the process wide ones. Contexts used on different threads can
+ * have different settings
+ */
+void				delaunay2d_context_set_num_threads(delaunay2d_context_t* ctx, unsigned int num_threads);
+void				delaunay2d_context_set_predicates(delaunay2d_context_t* ctx, del_predicates_t predicates);
+void				delaunay2d_context_set_ordering(delaunay2d_context_t* ctx, del_ordering_t ordering);
+
 
 typedef struct {
 	/** input points count */
@@ -78,6 +360,10 @@ typedef struct {
 
 	/** the triangles indices v0,v1,v2, v0,v1,v2 .... */
 	unsigned int*	tris;
+
+	/** the triangle across each triangle edge v0v1, v1v2, v2v0, (unsigned
+	 * int)-1 on the hull. NULL unless the triangles are built with them */
+	unsigned int*	neighbors;
 } tri_delaunay2d_t;
 
 /**
@@ -85,11 +371,305 @@ typedef struct {
  */
 tri_delaunay2d_t*		tri_delaunay2d_from(delaunay2d_t* del);
 
+/**
+ * build a tri_delaunay2d_t out of a delaunay2d_t object with the buffers of a
+ * context, the result is owned by the context and valid until its next
+ * triangles build (do not call tri_delaunay2d_release on it)
+ */
+tri_delaunay2d_t*		tri_delaunay2d_context_from(delaunay2d_context_t* ctx, delaunay2d_t* del);
+
+/**
+ * number of triangles large enough for any build of a given point count
+ */
+unsigned int			tri_delaunay2d_max_triangles(unsigned int num_points);
+
+/**
+ * build the Delaunay triangles of a point set with the buffers of a context,
+ * straight into a caller buffer. The points are neither copied nor kept
+ *
+ * @tris: the triangles buffer, of 3 * tri_delaunay2d_max_triangles(num_points) at least
+ * @return: the triangle count, (unsigned int)-1 when they don't fit in tris (the
+ *	buffer is never reallocated)
+ */
+unsigned int			tri_delaunay2d_context_tris(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points, unsigned int *tris);
+
+/**
+ * build the Delaunay triangles of a point set straight from its halfedges,
+ * without the faces: the triangle count comes from Euler's formula, and each
+ * face is fanned as tri_delaunay2d_from() does. The triangles keep the input
+ * point indices
+ *
+ * @points: point set given as a sequence of tuple x0, y0, x1, y1, ....
+ * @num_points: number of given point
+ * @return: the triangles
+ */
+tri_delaunay2d_t*		tri_delaunay2d_points_from(const del_point2d_t *points, unsigned int num_points);
+
+/**
+ * build the Delaunay triangles of a point set straight from its halfedges
+ * with the buffers of a context, the result is owned by the context and valid
+ * until its next triangles build (do not call tri_delaunay2d_release on it)
+ */
+tri_delaunay2d_t*		tri_delaunay2d_context_points(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points);
+
+/**
+ * build the Delaunay triangles of a point set and their neighbours, read from
+ * the halfedges as the triangles are written
+ *
+ * @points: point set given as a sequence of tuple x0, y0, x1, y1, ....
+ * @num_points: number of given point
+ * @return: the triangles, with neighbors
+ */
+tri_delaunay2d_t*		tri_delaunay2d_neighbors_from(const del_point2d_t *points, unsigned int num_points);
+
+/**
+ * build the Delaunay triangles of a point set and their neighbours with the
+ * buffers of a context, straight into caller buffers
+ *
+ * @tris: the triangles buffer, of 3 * tri_delaunay2d_max_triangles(num_points) at least
+ * @neighbors: the neighbours buffer, as large as tris. The triangle across
+ *	edge v0v1, v1v2, v2v0 of each triangle, (unsigned int)-1 on the hull
+ * @return: the triangle count, (unsigned int)-1 when they don't fit in the
+ *	buffers (nothing is written then)
+ */
+unsigned int			tri_delaunay2d_context_neighbors(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points, unsigned int *tris, unsigned int *neighbors);
+
 /**
  * release a tri_delaunay2d_t object
  */
 void				tri_delaunay2d_release(tri_delaunay2d_t* tdel);
 
+typedef struct {
+	/** input points count: the sites */
+	unsigned int	num_sites;
+
+	/** number of Voronoi vertices */
+	unsigned int	num_vertices;
+
+	/** the Voronoi vertices: the circumcenters of the Delaunay faces (the
+	 * external one apart), in the delaunay2d_t faces order. A flat face,
+	 * that failed long double predicates can leave along aligned points on
+	 * the hull, has no circumcenter and no cell uses its vertex */
+	del_point2d_t*	vertices;
+
+	/** the cell of site i is cells[offsets[i]] to cells[offsets[i + 1] - 1],
+	 * its vertex indices counterclockwise (num_sites + 1 offsets) */
+	unsigned int*	offsets;
+	unsigned int*	cells;
+
+	/** the hull sites have unbounded cells: rays[2 * i] is the direction of
+	 * the ray from the first vertex of cell i to infinity, and rays[2 * i + 1]
+	 * the one from its last vertex. They are perpendicular to the hull edges
+	 * (and as long), (0, 0) for bounded cells. The duplicates, and points all
+	 * on a line, have empty cells */
+	del_point2d_t*	rays;
+} delaunay2d_voronoi_t;
+
+/*
+ * build the Voronoi diagram of a point set, straight from the halfedges of
+ * its triangulation
+ *
+ * @points: point set given as a sequence of tuple x0, y0, x1, y1, ....
+ * @num_points: number of given point
+ * @return: the created diagram
+ */
+delaunay2d_voronoi_t*		delaunay2d_voronoi_from(const del_point2d_t *points, unsigned int num_points);
+
+/*
+ * build the Voronoi diagram of a point set with the buffers of a context, the
+ * result is owned by the context and valid until its next Voronoi build (do
+ * not call delaunay2d_voronoi_release on it)
+ */
+delaunay2d_voronoi_t*		delaunay2d_context_voronoi(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points);
+
+/*
+ * release a delaunay2d_voronoi_t object
+ */
+void				delaunay2d_voronoi_release(delaunay2d_voronoi_t* vor);
+
+typedef struct {
+	/** input points count */
+	unsigned int	num_points;
+
+	/** the neighbours of point i are neighbors[offsets[i]] to
+	 * neighbors[offsets[i + 1] - 1], counterclockwise (num_points + 1
+	 * offsets). The duplicates have none */
+	unsigned int*	offsets;
+	unsigned int*	neighbors;
+} delaunay2d_adjacency_t;
+
+/*
+ * build the Delaunay graph of a point set: the neighbours of each point, read
+ * from its halfedge ring
+ *
+ * @points: point set given as a sequence of tuple x0, y0, x1, y1, ....
+ * @num_points: number of given point
+ * @return: the created adjacency
+ */
+delaunay2d_adjacency_t*		delaunay2d_adjacency_from(const del_point2d_t *points, unsigned int num_points);
+
+/*
+ * build the Delaunay graph of a point set with the buffers of a context, the
+ * result is owned by the context and valid until its next adjacency build (do
+ * not call delaunay2d_adjacency_release on it)
+ */
+delaunay2d_adjacency_t*		delaunay2d_context_adjacency(delaunay2d_context_t* ctx, const del_point2d_t *points, unsigned int num_points);
+
+/*
+ * release a delaunay2d_adjacency_t object
+ */
+void				delaunay2d_adjacency_release(delaunay2d_adjacency_t* adj);
+
+/**
+ * reader of a point stream: it fills points with max_points points at most,
+ * and returns how many, 0 at the end of the stream. The points come in x
+ * order: none of them is left of the points of the previous calls
+ */
+typedef unsigned int		(*del_stream_read_t)(void* user, del_point2d_t* points, unsigned int max_points);
+
+/**
+ * writer of the triangles of a point stream, v0,v1,v2, v0,v1,v2 ... given as
+ * point indices in the stream
+ */
+typedef void			(*del_stream_write_t)(void* user, const unsigned int* tris, unsigned int num_triangles);
+
+/**
+ * build the Delaunay triangles of a point stream larger than the memory: the
+ * points are read in chunks, each one built with the points of the faces
+ * that may still change (the front). The faces whose circle is left of the
+ * points read so far can't change anymore, they are written and their points
+ * dropped. The point indices are unsigned int, so a stream holds
+ * (unsigned int)-2 points at most
+ *
+ * @read: the point reader
+ * @write: the triangle writer
+ * @user: the reader and writer argument
+ * @budget: the bytes a build may take, the chunks fill what the front leaves
+ *	of it (a quarter of it at least, so a front larger than 3/4 of the
+ *	budget goes over it)
+ * @return: the number of points read, (unsigned int)-1 when a point is left
+ *	of the points of a previous read, the reader returns more points than
+ *	asked, or the stream goes over (unsigned int)-2 points. The build stops
+ *	there, the triangles written so far are final for the points before
+ *	that read
+ */
+unsigned int			tri_delaunay2d_stream(del_stream_read_t read, del_stream_write_t write, void* user, size_t budget);
+
+typedef struct tri_delaunay2d_locator_s	tri_delaunay2d_locator_t;
+
+/**
+ * create a point locator over a triangulation: it answers which triangle
+ * holds each query point (tri_delaunay2d_locate), and which triangulation
+ * point is the nearest to it (tri_delaunay2d_nearest). The triangulation is
+ * not copied, it must outlive the locator
+ */
+tri_delaunay2d_locator_t*	tri_delaunay2d_locator_create(const tri_delaunay2d_t* tdel);
+
+/**
+ * release a point locator
+ */
+void				tri_delaunay2d_locator_release(tri_delaunay2d_locator_t* loc);
+
+/**
+ * find the triangles holding a batch of points: the queries are sorted along
+ * a Hilbert curve, and each one walks from the triangle of the previous one.
+ * Large batches are split over delaunay2d_num_threads() threads
+ *
+ * @loc: the locator
+ * @queries: the points to locate
+ * @num_queries: number of queries
+ * @tris: the triangle index of each query, (unsigned int)-1 when it is out
+ *	of the triangulation
+ * @return: the number of queries inside the triangulation
+ */
+unsigned int			tri_delaunay2d_locate(tri_delaunay2d_locator_t* loc, const del_point2d_t *queries, unsigned int num_queries, unsigned int *tris);
+
+/**
+ * find the nearest point of a triangulation to each point of a batch: the
+ * queries are sorted as for tri_delaunay2d_locate(), and each one walks the
+ * Delaunay graph from the nearest point of the previous one, to the closest
+ * neighbour while there is a closer one
+ *
+ * @loc: the locator
+ * @queries: the query points
+ * @num_queries: number of queries
+ * @sites: the nearest point index of each query
+ */
+void				tri_delaunay2d_nearest(tri_delaunay2d_locator_t* loc, const del_point2d_t *queries, unsigned int num_queries, unsigned int *sites);
+
+/**
+ * find the nearest other point of each point of a triangulation, in a single
+ * pass over the triangle edges (the nearest neighbour graph is part of the
+ * Delaunay graph)
+ *
+ * @tdel: the triangulation
+ * @nearest: the nearest point index of each point, of tdel->num_points. A
+ *	duplicate point (that no triangle refers to) gets the point at its
+ *	coordinates that the triangles refer to, at distance 0. (unsigned int)-1
+ *	when there is no other point
+ */
+void				tri_delaunay2d_all_nearest(const tri_delaunay2d_t* tdel, unsigned int *nearest);
+
+typedef struct del_file_s	del_file_t;
+
+/**
+ * map a point or triangulation file, read only. The file holds a 32 bytes
+ * header ("DELF", version 1, flags, point count, triangle count, all uint32
+ * little endian), the points (x, y doubles), the triangles (v0, v1, v2
+ * uint32), and their neighbours when the flags bit 0 is set. Its arrays are
+ * used as they are, without copy: the host must be little endian. They are
+ * checked once at open: every triangle vertex must be a point of the file,
+ * and every neighbour a triangle of the file (or (unsigned int)-1) that has
+ * the triangle as a neighbour too. The coordinates are not checked, a file
+ * that isn't the Delaunay triangulation of its points gives wrong answers
+ *
+ * @path: the file path
+ * @return: the mapped file, NULL when it can't be mapped or isn't valid
+ */
+del_file_t*			del_file_open(const char* path);
+
+/**
+ * the points and triangles of a mapped file (no triangles for a point file),
+ * valid until the file is closed. They are read only
+ */
+const tri_delaunay2d_t*		del_file_triangles(const del_file_t* file);
+
+/**
+ * the triangle across each triangle edge v0v1, v1v2, v2v0 of a mapped file,
+ * (unsigned int)-1 on the hull, as del_file_triangles(file)->neighbors. NULL
+ * when the file has none
+ */
+const unsigned int*		del_file_neighbors(const del_file_t* file);
+
+/**
+ * unmap a file
+ */
+void				del_file_close(del_file_t* file);
+
+/**
+ * write a point file
+ *
+ * @return: 1 when written, 0 when the file can't be created
+ */
+int				del_file_write_points(const char* path, const del_point2d_t* points, unsigned int num_points);
+
+/**
+ * write a triangulation file
+ *
+ * @neighbors: also write the triangles neighbours
+ * @return: 1 when written, 0 when the file can't be created
+ */
+int				tri_delaunay2d_write_file(const tri_delaunay2d_t* tdel, int neighbors, const char* path);
+
+/**
+ * build the Delaunay triangles of a point set with the buffers of a context,
+ * straight into a mapped triangulation file
+ *
+ * @neighbors: also write the triangles neighbours
+ * @return: 1 when written, 0 when the file can't be created
+ */
+int				tri_delaunay2d_context_file(delaunay2d_context_t* ctx, const del_point2d_t* points, unsigned int num_points, int neighbors, const char* path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,769 @@
+#ifndef DELAUNAY_HPP
+#define DELAUNAY_HPP
+
+/*
+**  delaunay.hpp : compute 2D delaunay triangulation in the plane (C++ front-end).
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+* header only version of the divide and conquer of delaunay.c, templated on
+* the coordinate type. The points keep their type (a float point stays 8
+* bytes), and coord_traits picks the predicates of each type at compile time:
+*
+*	float		evaluated in double
+*	double		evaluated in long double (as delaunay.c)
+*	fixed<F>	exact, in 64 and 128 bits integers (raw values within
+*			+/- 2^29, checked by the builds)
+*
+* the faces and triangles are given in the same layout as delaunay2d_t and
+* tri_delaunay2d_t. Builds are single threaded
+*/
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+namespace delaunay {
+
+template<typename T>
+struct point2d {
+	T	x, y;
+};
+
+/*
+* signed fixed point coordinate with F fractional bits. The exact predicates
+* need raw values within +/- max_raw: the incircle of wider ones doesn't fit
+* in 128 bits
+*/
+template<int F>
+struct fixed {
+	enum { max_raw = 1 << 29 };
+
+	int32_t		raw;
+
+	static fixed	from_raw(int32_t r)	{ fixed f; f.raw = r; return f; }
+	static fixed	from_double(double v)	{ return from_raw((int32_t)(v * (double)(1 << F) + (v < 0 ? -0.5 : 0.5))); }
+	double		to_double() const	{ return (double)raw / (double)(1 << F); }
+};
+
+#ifdef __SIZEOF_INT128__
+__extension__ typedef __int128	int128_t;
+#endif
+
+/*
+* whether the predicates of a coordinate type are exact for a point, the
+* builds refuse the points that aren't
+*/
+template<typename T>
+inline bool in_range(const point2d<T> &) {
+	return true;
+}
+
+template<int F>
+inline bool in_range(const point2d< fixed<F> > &p) {
+	return p.x.raw >= -fixed<F>::max_raw && p.x.raw <= fixed<F>::max_raw &&
+	       p.y.raw >= -fixed<F>::max_raw && p.y.raw <= fixed<F>::max_raw;
+}
+
+/*
+* orientation and incircle of a coordinate type:
+*	orient(a, b, c) > 0 when c is on the left of a -> b
+*	in_circle(a, b, c, d) > 0 when d is inside the circle through a, b and c
+* and the lexicographic (x then y) order of the points
+*/
+template<typename T>
+struct coord_traits;
+
+/*
+* the predicates of the floating point types, evaluated in W
+*/
+template<typename T, typename W>
+struct float_coord_traits {
+	static int orient(const point2d<T> &a, const point2d<T> &b, const point2d<T> &c) {
+		W	abx	= (W)b.x - (W)a.x;
+		W	aby	= (W)b.y - (W)a.y;
+		W	acx	= (W)c.x - (W)a.x;
+		W	acy	= (W)c.y - (W)a.y;
+		W	res	= abx * acy - aby * acx;
+
+		return (res > 0) - (res < 0);
+	}
+
+	static int in_circle(const point2d<T> &a, const point2d<T> &b, const point2d<T> &c, const point2d<T> &d) {
+		W	adx	= (W)a.x - (W)d.x;
+		W	ady	= (W)a.y - (W)d.y;
+		W	bdx	= (W)b.x - (W)d.x;
+		W	bdy	= (W)b.y - (W)d.y;
+		W	cdx	= (W)c.x - (W)d.x;
+		W	cdy	= (W)c.y - (W)d.y;
+
+		W	al	= adx * adx + ady * ady;
+		W	bl	= bdx * bdx + bdy * bdy;
+		W	cl	= cdx * cdx + cdy * cdy;
+
+		W	res	= adx * (bdy * cl - bl * cdy)
+				- ady * (bdx * cl - bl * cdx)
+				+ al * (bdx * cdy - bdy * cdx);
+
+		return (res > 0) - (res < 0);
+	}
+
+	static bool less(const point2d<T> &a, const point2d<T> &b) {
+		return a.x < b.x || (a.x == b.x && a.y < b.y);
+	}
+
+	static bool equal(const point2d<T> &a, const point2d<T> &b) {
+		return a.x == b.x && a.y == b.y;
+	}
+};
+
+/* double carries twice the precision of the float inputs */
+template<>
+struct coord_traits<float> : float_coord_traits<float, double> {};
+
+template<>
+struct coord_traits<double> : float_coord_traits<double, long double> {};
+
+template<int F>
+struct coord_traits< fixed<F> > {
+	typedef point2d< fixed<F> >	point_t;
+
+#ifndef __SIZEOF_INT128__
+	/* a long double incircle would not be exact */
+	static_assert(F != F, "delaunay::fixed needs 128 bits integers");
+#endif
+
+	static int orient(const point_t &a, const point_t &b, const point_t &c) {
+		int64_t	abx	= (int64_t)b.x.raw - a.x.raw;
+		int64_t	aby	= (int64_t)b.y.raw - a.y.raw;
+		int64_t	acx	= (int64_t)c.x.raw - a.x.raw;
+		int64_t	acy	= (int64_t)c.y.raw - a.y.raw;
+		int64_t	res	= abx * acy - aby * acx;
+
+		return (res > 0) - (res < 0);
+	}
+
+	static int in_circle(const point_t &a, const point_t &b, const point_t &c, const point_t &d) {
+		int64_t	adx	= (int64_t)a.x.raw - d.x.raw;
+		int64_t	ady	= (int64_t)a.y.raw - d.y.raw;
+		int64_t	bdx	= (int64_t)b.x.raw - d.x.raw;
+		int64_t	bdy	= (int64_t)b.y.raw - d.y.raw;
+		int64_t	cdx	= (int64_t)c.x.raw - d.x.raw;
+		int64_t	cdy	= (int64_t)c.y.raw - d.y.raw;
+
+		/* the differences take 30 bits, the lifts and the minors 61 */
+		int64_t	al	= adx * adx + ady * ady;
+		int64_t	bl	= bdx * bdx + bdy * bdy;
+		int64_t	cl	= cdx * cdx + cdy * cdy;
+
+#ifdef __SIZEOF_INT128__
+		int128_t	res	= (int128_t)al * (bdx * cdy - bdy * cdx)
+					+ (int128_t)bl * (cdx * ady - cdy * adx)
+					+ (int128_t)cl * (adx * bdy - ady * bdx);
+#else
+		int64_t		res	= 0;
+#endif
+
+		return (res > 0) - (res < 0);
+	}
+
+	static bool less(const point_t &a, const point_t &b) {
+		return a.x.raw < b.x.raw || (a.x.raw == b.x.raw && a.y.raw < b.y.raw);
+	}
+
+	static bool equal(const point_t &a, const point_t &b) {
+		return a.x.raw == b.x.raw && a.y.raw == b.y.raw;
+	}
+};
+
+/*
+* a triangulation, its buffers are kept from one build to the next
+*/
+template<typename T, typename Traits = coord_traits<T> >
+class triangulation {
+public:
+	typedef point2d<T>	point_t;
+
+	triangulation() : num_faces_(0), num_duplicates_(0) {}
+
+	/*
+	* build the 2D Delaunay triangulation of a set of points, the points at the
+	* exact coordinate of another one are left out. Throws std::out_of_range
+	* when a point is outside the exact range of the predicates (see in_range)
+	*/
+	void build(const point_t *points, unsigned int num_points);
+
+	/*
+	* number of points left out as duplicates
+	*/
+	unsigned int	num_duplicates() const	{ return num_duplicates_; }
+
+	/*
+	* representative of each input point: the lowest input index at its
+	* coordinate (its own index when unique). Empty without duplicates
+	*/
+	const std::vector<unsigned int>&	representatives() const	{ return representatives_; }
+
+	/*
+	* number of faces, the first one is the external face
+	*/
+	unsigned int	num_faces() const	{ return num_faces_; }
+
+	/*
+	* the faces given as a sequence: num verts, verts indices, num verts, verts indices...
+	*/
+	const std::vector<unsigned int>&	faces() const	{ return faces_; }
+
+	/*
+	* split the faces into triangles, v0, v1, v2, v0, v1, v2...
+	*/
+	void triangles(std::vector<unsigned int> &tris) const;
+
+private:
+	enum { ON_RIGHT = 1, ON_SEG = 0, ON_LEFT = -1 };
+	enum { OUTSIDE = -1, ON_CIRCLE = 0, INSIDE = 1 };
+
+	static const unsigned int	NIL	= 0xFFFFFFFFu;
+
+	struct vertex {
+		point_t		p;			/* point coordinates */
+		unsigned int	he;			/* point halfedge */
+		unsigned int	idx;			/* point index in input buffer */
+	};
+
+	/* the 2 halfedges of an edge are allocated together, the pair of e is e ^ 1 */
+	struct halfedge {
+		unsigned int	vertex;
+		unsigned int	next;
+		unsigned int	prev;
+	};
+
+	struct hull {
+		unsigned int	rightmost_he;
+		unsigned int	leftmost_he;
+		unsigned int	start_point;
+		unsigned int	end_point;
+	};
+
+	struct index_less {
+		const point_t	*points;
+		bool operator()(unsigned int a, unsigned int b) const	{ return Traits::less(points[a], points[b]); }
+	};
+
+	std::vector<vertex>		verts_;
+	std::vector<halfedge>		edges_;
+	std::vector<unsigned int>	order_;
+	std::vector<unsigned char>	external_;
+	std::vector<unsigned int>	faces_;
+	std::vector<unsigned int>	representatives_;
+	unsigned int			num_faces_;
+	unsigned int			num_duplicates_;
+	unsigned int			free_edge_;
+
+	static unsigned int	pair(unsigned int e)		{ return e ^ 1; }
+	unsigned int		vert(unsigned int e) const	{ return edges_[e].vertex; }
+	const point_t&		pt(unsigned int v) const	{ return verts_[v].p; }
+
+	int classify(unsigned int s, unsigned int e, unsigned int p) const {
+		int	o	= Traits::orient(pt(s), pt(e), pt(p));
+		return o > 0 ? ON_LEFT : (o < 0 ? ON_RIGHT : ON_SEG);
+	}
+
+	int in_circle(unsigned int a, unsigned int b, unsigned int c, unsigned int d) const {
+		int	o	= Traits::in_circle(pt(a), pt(b), pt(c), pt(d));
+		return o > 0 ? INSIDE : (o < 0 ? OUTSIDE : ON_CIRCLE);
+	}
+
+	unsigned int	alloc_edge();
+	void		remove_edge(unsigned int d);
+	void		unlink(unsigned int d);
+	void		init_seg(hull &h, unsigned int start);
+	void		init_tri(hull &h, unsigned int start);
+	unsigned int	valid_left(unsigned int b);
+	unsigned int	valid_right(unsigned int b);
+	unsigned int	valid_link(unsigned int b);
+	unsigned int	lower_tangent(hull &left, hull &right);
+	void		link(hull &result, hull &left, hull &right);
+	void		divide_and_conquer(hull &h, unsigned int start, unsigned int end);
+	void		build_face(unsigned int d);
+	void		build_faces(const hull &h);
+};
+
+template<typename T, typename Traits>
+unsigned int triangulation<T, Traits>::alloc_edge()
+{
+	unsigned int	e;
+
+	if( free_edge_ != NIL ) {
+		e		= free_edge_;
+		free_edge_	= edges_[e].next;
+	} else {
+		e	= (unsigned int)edges_.size();
+		edges_.resize(e + 2);
+	}
+
+	edges_[e].vertex	= edges_[e + 1].vertex	= NIL;
+	edges_[e].next		= edges_[e + 1].next	= NIL;
+	edges_[e].prev		= edges_[e + 1].prev	= NIL;
+
+	return e;
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::unlink(unsigned int d)
+{
+	unsigned int	next	= edges_[d].next;
+	unsigned int	prev	= edges_[d].prev;
+
+	edges_[next].prev	= prev;
+	edges_[prev].next	= next;
+
+	if( verts_[vert(d)].he == d )
+		verts_[vert(d)].he	= next;
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::remove_edge(unsigned int d)
+{
+	unlink(d);
+	unlink(pair(d));
+
+	d			&= ~1u;
+	edges_[d].vertex	= edges_[d + 1].vertex	= NIL;
+	edges_[d].next		= free_edge_;
+	free_edge_		= d;
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::init_seg(hull &h, unsigned int start)
+{
+	unsigned int	d0	= alloc_edge();
+	unsigned int	d1	= pair(d0);
+
+	h.start_point	= start;
+	h.end_point	= start + 1;
+
+	edges_[d0].vertex	= start;
+	edges_[d1].vertex	= start + 1;
+	edges_[d0].next		= edges_[d0].prev	= d0;
+	edges_[d1].next		= edges_[d1].prev	= d1;
+
+	verts_[start].he	= d0;
+	verts_[start + 1].he	= d1;
+
+	h.rightmost_he	= d1;
+	h.leftmost_he	= d0;
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::init_tri(hull &h, unsigned int start)
+{
+	unsigned int	d0	= alloc_edge();
+	unsigned int	d1	= alloc_edge();
+	unsigned int	d2	= alloc_edge();
+	unsigned int	d3	= pair(d0);
+	unsigned int	d4	= pair(d1);
+	unsigned int	d5	= pair(d2);
+
+	h.start_point	= start;
+	h.end_point	= start + 2;
+
+	if( classify(start, start + 2, start + 1) == ON_LEFT ) {
+		edges_[d0].vertex	= start;
+		edges_[d1].vertex	= start + 2;
+		edges_[d2].vertex	= start + 1;
+		edges_[d3].vertex	= start + 2;
+		edges_[d4].vertex	= start + 1;
+		edges_[d5].vertex	= start;
+
+		verts_[start].he	= d0;
+		verts_[start + 1].he	= d2;
+		verts_[start + 2].he	= d1;
+
+		h.rightmost_he	= d1;
+	} else {
+		edges_[d0].vertex	= start;
+		edges_[d1].vertex	= start + 1;
+		edges_[d2].vertex	= start + 2;
+		edges_[d3].vertex	= start + 1;
+		edges_[d4].vertex	= start + 2;
+		edges_[d5].vertex	= start;
+
+		verts_[start].he	= d0;
+		verts_[start + 1].he	= d1;
+		verts_[start + 2].he	= d2;
+
+		h.rightmost_he	= d2;
+	}
+
+	h.leftmost_he	= d0;
+
+	edges_[d0].next	= edges_[d0].prev	= d5;
+	edges_[d1].next	= edges_[d1].prev	= d3;
+	edges_[d2].next	= edges_[d2].prev	= d4;
+	edges_[d3].next	= edges_[d3].prev	= d1;
+	edges_[d4].next	= edges_[d4].prev	= d2;
+	edges_[d5].next	= edges_[d5].prev	= d0;
+}
+
+template<typename T, typename Traits>
+unsigned int triangulation<T, Traits>::valid_left(unsigned int b)
+{
+	unsigned int	g, d, u, v, c, du, dg;
+
+	g	= vert(b);
+	dg	= b;
+	d	= vert(pair(b));
+	b	= edges_[b].next;
+	u	= vert(pair(b));
+	du	= pair(b);
+	v	= vert(pair(edges_[b].next));
+
+	if( classify(g, d, u) == ON_LEFT ) {
+		assert( v != u && "1: floating point precision error" );
+		while( v != d && v != g && in_circle(g, d, u, v) == INSIDE ) {
+			c	= edges_[b].next;
+			du	= pair(c);
+			remove_edge(b);
+			b	= c;
+			u	= vert(du);
+			v	= vert(pair(edges_[b].next));
+		}
+
+		assert( v != u && "2: floating point precision error" );
+		if( v != d && v != g && in_circle(g, d, u, v) == ON_CIRCLE ) {
+			du	= edges_[du].prev;
+			remove_edge(b);
+		}
+	} else
+		du	= dg;
+
+	return du;
+}
+
+template<typename T, typename Traits>
+unsigned int triangulation<T, Traits>::valid_right(unsigned int b)
+{
+	unsigned int	rv, lv, u, v, c, dd, du;
+
+	b	= pair(b);
+	rv	= vert(b);
+	dd	= b;
+	lv	= vert(pair(b));
+	b	= edges_[b].prev;
+	u	= vert(pair(b));
+	du	= pair(b);
+	v	= vert(pair(edges_[b].prev));
+
+	if( classify(lv, rv, u) == ON_LEFT ) {
+		assert( v != u && "1: floating point precision error" );
+		while( v != lv && v != rv && in_circle(lv, rv, u, v) == INSIDE ) {
+			c	= edges_[b].prev;
+			du	= pair(c);
+			remove_edge(b);
+			b	= c;
+			u	= vert(du);
+			v	= vert(pair(edges_[b].prev));
+		}
+
+		assert( v != u && "2: floating point precision error" );
+		if( v != lv && v != rv && in_circle(lv, rv, u, v) == ON_CIRCLE ) {
+			du	= edges_[du].next;
+			remove_edge(b);
+		}
+	} else
+		du	= dd;
+
+	return du;
+}
+
+template<typename T, typename Traits>
+unsigned int triangulation<T, Traits>::valid_link(unsigned int b)
+{
+	unsigned int	g, g_p, d, d_p, gd, dd, new_gd, new_dd;
+	int		a;
+
+	g	= vert(b);
+	gd	= valid_left(b);
+	g_p	= vert(gd);
+
+	d	= vert(pair(b));
+	dd	= valid_right(b);
+	d_p	= vert(dd);
+
+	if( g != g_p && d != d_p ) {
+		a	= in_circle(g, d, g_p, d_p);
+
+		if( a == INSIDE )
+			gd	= b;
+		else if( a == OUTSIDE )
+			dd	= pair(b);
+	}
+
+	new_gd	= alloc_edge();
+	new_dd	= pair(new_gd);
+
+	edges_[new_gd].vertex		= vert(gd);
+	edges_[new_gd].prev		= gd;
+	edges_[new_gd].next		= edges_[gd].next;
+	edges_[edges_[gd].next].prev	= new_gd;
+	edges_[gd].next			= new_gd;
+
+	edges_[new_dd].vertex		= vert(dd);
+	edges_[new_dd].prev		= edges_[dd].prev;
+	edges_[edges_[dd].prev].next	= new_dd;
+	edges_[new_dd].next		= dd;
+	edges_[dd].prev			= new_dd;
+
+	return new_gd;
+}
+
+template<typename T, typename Traits>
+unsigned int triangulation<T, Traits>::lower_tangent(hull &left, hull &right)
+{
+	unsigned int	left_d	= left.rightmost_he;
+	unsigned int	right_d	= right.leftmost_he;
+	unsigned int	new_ld, new_rd, pl, pr;
+	int		sl, sr;
+
+	do {
+		pl	= vert(pair(edges_[left_d].prev));
+		pr	= vert(pair(right_d));
+
+		if( (sl = classify(vert(left_d), vert(right_d), pl)) == ON_RIGHT )
+			left_d	= pair(edges_[left_d].prev);
+
+		if( (sr = classify(vert(left_d), vert(right_d), pr)) == ON_RIGHT )
+			right_d	= edges_[pair(right_d)].next;
+
+	} while( sl == ON_RIGHT || sr == ON_RIGHT );
+
+	new_ld	= alloc_edge();
+	new_rd	= pair(new_ld);
+
+	edges_[new_ld].vertex			= vert(left_d);
+	edges_[new_ld].prev			= edges_[left_d].prev;
+	edges_[edges_[left_d].prev].next	= new_ld;
+	edges_[new_ld].next			= left_d;
+	edges_[left_d].prev			= new_ld;
+
+	edges_[new_rd].vertex			= vert(right_d);
+	edges_[new_rd].prev			= edges_[right_d].prev;
+	edges_[edges_[right_d].prev].next	= new_rd;
+	edges_[new_rd].next			= right_d;
+	edges_[right_d].prev			= new_rd;
+
+	return new_ld;
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::link(hull &result, hull &left, hull &right)
+{
+	unsigned int	ml	= vert(left.leftmost_he);
+	unsigned int	mr	= vert(right.rightmost_he);
+	unsigned int	base	= lower_tangent(left, right);
+	unsigned int	u	= vert(pair(edges_[base].next));
+	unsigned int	v	= vert(pair(edges_[pair(base)].prev));
+
+	while( classify(vert(base), vert(pair(base)), u) == ON_LEFT ||
+	       classify(vert(base), vert(pair(base)), v) == ON_LEFT )
+	{
+		base	= valid_link(base);
+		u	= vert(pair(edges_[base].next));
+		v	= vert(pair(edges_[pair(base)].prev));
+	}
+
+	right.rightmost_he	= verts_[mr].he;
+	left.leftmost_he	= verts_[ml].he;
+
+	while( classify(vert(right.rightmost_he), vert(pair(right.rightmost_he)), vert(pair(edges_[right.rightmost_he].prev))) == ON_RIGHT )
+		right.rightmost_he	= edges_[right.rightmost_he].prev;
+
+	while( classify(vert(left.leftmost_he), vert(pair(left.leftmost_he)), vert(pair(edges_[left.leftmost_he].prev))) == ON_RIGHT )
+		left.leftmost_he	= edges_[left.leftmost_he].prev;
+
+	result.leftmost_he	= left.leftmost_he;
+	result.rightmost_he	= right.rightmost_he;
+	result.start_point	= left.start_point;
+	result.end_point	= right.end_point;
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::divide_and_conquer(hull &h, unsigned int start, unsigned int end)
+{
+	unsigned int	n	= end - start + 1;
+	unsigned int	i;
+	hull		left, right;
+
+	if( n > 3 ) {
+		i	= (n / 2) + (n & 1);
+		divide_and_conquer(left, start, start + i - 1);
+		divide_and_conquer(right, start + i, end);
+		link(h, left, right);
+	} else if( n == 3 ) {
+		init_tri(h, start);
+	} else if( n == 2 ) {
+		init_seg(h, start);
+	}
+}
+
+/*
+* walk the face of a halfedge, appending it to the flat faces
+*/
+template<typename T, typename Traits>
+void triangulation<T, Traits>::build_face(unsigned int d)
+{
+	unsigned int	head	= (unsigned int)faces_.size();
+	unsigned int	curr	= d;
+
+	faces_.push_back(0);
+	do {
+		faces_.push_back(verts_[vert(curr)].idx);
+		curr	= edges_[pair(curr)].prev;
+	} while( curr != d );
+
+	faces_[head]	= (unsigned int)faces_.size() - head - 1;
+	num_faces_++;
+}
+
+/*
+* same faces, in the same order, as delaunay.c: the external face first, then
+* each inner face from its lowest vertex
+*/
+template<typename T, typename Traits>
+void triangulation<T, Traits>::build_faces(const hull &h)
+{
+	unsigned int	v, curr;
+
+	external_.assign(edges_.size(), 0);
+	faces_.clear();
+	num_faces_	= 0;
+
+	curr	= pair(h.rightmost_he);
+	do {
+		external_[curr]	= 1;
+		curr		= edges_[pair(curr)].prev;
+	} while( curr != pair(h.rightmost_he) );
+
+	build_face(pair(h.rightmost_he));
+
+	for( v = 0; v < verts_.size(); v++ )
+	{
+		curr	= verts_[v].he;
+		do {
+			if( vert(pair(curr)) > v && vert(pair(edges_[curr].next)) > v && !external_[curr] )
+				build_face(curr);
+			curr	= edges_[curr].next;
+		} while( curr != verts_[v].he );
+	}
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::build(const point_t *points, unsigned int num_points)
+{
+	unsigned int	i, j, n;
+	index_less	cmp;
+	hull		h;
+
+	for( i = 0; i < num_points; i++ )
+		if( !in_range(points[i]) )
+			throw std::out_of_range("delaunay::triangulation::build: point outside the exact range of the predicates");
+
+	verts_.resize(num_points);
+	order_.resize(num_points);
+	edges_.clear();
+	faces_.clear();
+	representatives_.clear();
+	num_faces_	= 0;
+	num_duplicates_	= 0;
+	free_edge_	= NIL;
+
+	for( i = 0; i < num_points; i++ )
+		order_[i]	= i;
+
+	/* stable, so the lowest index of equal points comes first and represents them */
+	cmp.points	= points;
+	std::stable_sort(order_.begin(), order_.end(), cmp);
+
+	for( i = 0, n = 0; i < num_points; i++ )
+	{
+		if( i > 0 && Traits::equal(points[order_[i]], points[order_[i - 1]]) ) {
+			if( representatives_.empty() ) {
+				representatives_.resize(num_points);
+				for( j = 0; j < num_points; j++ )
+					representatives_[j]	= j;
+			}
+
+			representatives_[order_[i]]	= verts_[n - 1].idx;
+			num_duplicates_++;
+			continue;
+		}
+
+		verts_[n].p	= points[order_[i]];
+		verts_[n].he	= NIL;
+		verts_[n].idx	= order_[i];
+		n++;
+	}
+
+	verts_.resize(n);
+	if( n < 3 )
+		return;
+
+	edges_.reserve(2 * 3 * n);
+	divide_and_conquer(h, 0, n - 1);
+	build_faces(h);
+}
+
+template<typename T, typename Traits>
+void triangulation<T, Traits>::triangles(std::vector<unsigned int> &tris) const
+{
+	unsigned int	v_offset, i, j, nv;
+
+	tris.clear();
+	if( num_faces_ == 0 )
+		return;
+
+	if( num_faces_ == 1 ) {
+		/* degenerated case where only the external face exists */
+		nv	= faces_[0];
+		for( j = 0; j + 2 < nv; j++ ) {
+			tris.push_back(faces_[1 + j]);
+			tris.push_back(faces_[(1 + j + 1) % nv]);
+			tris.push_back(faces_[1 + j]);
+		}
+		return;
+	}
+
+	v_offset	= faces_[0] + 1;	/* ignore external face */
+	for( i = 1; i < num_faces_; i++ )
+	{
+		nv	= faces_[v_offset];
+		for( j = 0; j + 2 < nv; j++ ) {
+			tris.push_back(faces_[v_offset + 1]);
+			tris.push_back(faces_[v_offset + j + 2]);
+			tris.push_back(faces_[v_offset + j + 3]);
+		}
+		v_offset	+= nv + 1;
+	}
+}
+
+} /* namespace delaunay */
+
+#endif /* DELAUNAY_HPP */
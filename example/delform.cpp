@@ -9,7 +9,6 @@
 #include <cfloat>
 
 #include <vector>
-#include <unordered_set>
 
 DelForm::DelForm(QWidget *parent) :
 	QWidget(parent),
@@ -262,57 +261,32 @@ remap(const std::vector<del_point2d_t>& in, real w, real h) {
     return out;
 }
 
-namespace std {
-
-template <>
-struct hash<del_point2d_t>
-{
-    std::size_t operator()(const del_point2d_t& k) const
-    {
-        using std::size_t;
-        using std::hash;
-        return ((hash<double>()(k.x)
-                 ^ (hash<double>()(k.y) << 1)) >> 1);
-    }
-};
-
-}
-
-bool operator == (const del_point2d_t& a, const del_point2d_t& b) {
-    return a.x == b.x && a.y == b.y;
-}
-
 void
 DelForm::openFile() {
     QString fileName = QFileDialog::getOpenFileName(this,
-        tr("Open point set"), "/home/", tr("Text files (*.txt)"));
-
-    FILE* file = fopen(fileName.toStdString().c_str(), "rt");
+        tr("Open point set"), "/home/", tr("Point files (*.txt *.del)"));
 
     std::vector<del_point2d_t>  points;
-    while(!feof(file)) {
-        del_point2d_t   pt;
-        fscanf(file, "%lf,%lf", &pt.x, &pt.y);
-        points.push_back(pt);
-    }
-    fclose(file);
-
-    std::unordered_set<del_point2d_t>   point_set;
-
-    for( auto pt : points ) {
-        if( point_set.find(pt) != point_set.end() ) {
-            fprintf(stderr, "WARNING: points with same coordinate are found\n");
+    if( fileName.endsWith(".del") ) {
+        del_file_t* file = del_file_open(fileName.toStdString().c_str());
+        if( !file )
+            return;
+
+        const tri_delaunay2d_t* tdel = del_file_triangles(file);
+        points.assign(tdel->points, tdel->points + tdel->num_points);
+        del_file_close(file);
+    } else {
+        FILE* file = fopen(fileName.toStdString().c_str(), "rt");
+
+        while(!feof(file)) {
+            del_point2d_t   pt;
+            fscanf(file, "%lf,%lf", &pt.x, &pt.y);
+            points.push_back(pt);
         }
-        point_set.insert(pt);
-    }
-
-    points.clear();
-
-    for( auto pt : point_set ) {
-        points.push_back(pt);
+        fclose(file);
     }
 
-    // remap the point set
+    // the duplicates are left out by the triangulation, remap the point set
     points = remap(points, this->width(), this->height());
 
 
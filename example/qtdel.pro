@@ -15,3 +15,4 @@ FORMS += mainwindow.ui \
     delform.ui
 
 QMAKE_CXXFLAGS += -DQT_INCLUDE_COMPAT
+unix:LIBS += -lpthread
@@ -0,0 +1,155 @@
+/*
+**  adjacency.c : check the Delaunay graphs against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+#define GRID_SIZE	30
+
+static int adjacency_cmp( const void *a, const void *b )
+{
+	unsigned int	ua	= *(const unsigned int*)a;
+	unsigned int	ub	= *(const unsigned int*)b;
+
+	return ua < ub ? -1 : (ua > ub);
+}
+
+/*
+* the neighbours of each point are the points it shares a face edge with in a
+* fresh build, counterclockwise around it
+*/
+static void check_adjacency( const char *what, const del_point2d_t *points, unsigned int num_points, const delaunay2d_adjacency_t *adj )
+{
+	delaunay2d_t	*del	= delaunay2d_from((del_point2d_t*)points, num_points);
+	unsigned int	*offsets	= (unsigned int*)calloc(num_points + 1, sizeof(unsigned int));
+	unsigned int	*fresh, *sorted;
+	unsigned int	f, o, i, k, n, a, b, num_edges, wrong = 0, clockwise = 0;
+
+	CHECK( adj->num_points == num_points, "%s: %u points for %u", what, adj->num_points, num_points );
+
+	/* each halfedge ab is in a single face, the external one included: the
+	   neighbours of a are the ends of its halfedges */
+	for( f = 0, o = 0, num_edges = 0; f < del->num_faces; f++, o += del->faces[o] + 1 )
+		for( i = 0; i < del->faces[o]; i++, num_edges++ )
+			offsets[del->faces[o + 1 + i] + 1]++;
+
+	for( i = 0; i < num_points; i++ )
+		offsets[i + 1]	+= offsets[i];
+
+	fresh	= (unsigned int*)malloc((num_edges + 1) * sizeof(unsigned int));
+	sorted	= (unsigned int*)malloc((num_edges + 1) * sizeof(unsigned int));
+
+	for( f = 0, o = 0; f < del->num_faces; f++, o += del->faces[o] + 1 )
+		for( i = 0; i < del->faces[o]; i++ ) {
+			a	= del->faces[o + 1 + i];
+			b	= del->faces[o + 1 + (i + 1) % del->faces[o]];
+			fresh[offsets[a]++]	= b;
+		}
+
+	for( i = num_points; i > 0; i-- )
+		offsets[i]	= offsets[i - 1];
+	offsets[0]	= 0;
+
+	for( i = 0; i < num_points; i++ )
+	{
+		n	= adj->offsets[i + 1] - adj->offsets[i];
+		if( n != offsets[i + 1] - offsets[i] ) {
+			wrong++;
+			continue;
+		}
+
+		qsort(fresh + offsets[i], n, sizeof(unsigned int), adjacency_cmp);
+		memcpy(sorted, adj->neighbors + adj->offsets[i], n * sizeof(unsigned int));
+		qsort(sorted, n, sizeof(unsigned int), adjacency_cmp);
+		if( memcmp(sorted, fresh + offsets[i], n * sizeof(unsigned int)) != 0 )
+			wrong++;
+
+		/* counterclockwise: each turn to the next neighbour is to the left,
+		   but the one across the hull */
+		for( k = 0, a = 0; n > 2 && k < n; k++ )
+			a	+= check_orient(&points[i], &points[adj->neighbors[adj->offsets[i] + k]], &points[adj->neighbors[adj->offsets[i] + (k + 1) % n]]) <= 0;
+		if( a > 1 )
+			clockwise++;
+	}
+
+	CHECK( wrong == 0, "%s: %u points with other neighbours than in a fresh build", what, wrong );
+	CHECK( clockwise == 0, "%s: %u points with their neighbours out of order", what, clockwise );
+
+	free(sorted);
+	free(fresh);
+	free(offsets);
+	delaunay2d_release(del);
+}
+
+/*
+* the adjacency of a context is the allocated one
+*/
+static void check_context( const char *what, const del_point2d_t *points, unsigned int num_points, const delaunay2d_adjacency_t *adj )
+{
+	delaunay2d_context_t		*ctx	= delaunay2d_context_create();
+	const delaunay2d_adjacency_t	*cadj	= delaunay2d_context_adjacency(ctx, points, num_points);
+
+	CHECK( memcmp(cadj->offsets, adj->offsets, (num_points + 1) * sizeof(unsigned int)) == 0 &&
+	       memcmp(cadj->neighbors, adj->neighbors, adj->offsets[num_points] * sizeof(unsigned int)) == 0, "%s: the context adjacency differs", what );
+
+	delaunay2d_context_release(ctx);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t		*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	delaunay2d_adjacency_t	*adj;
+	unsigned int		i;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	adj	= delaunay2d_adjacency_from(points, NUM_POINTS);
+	check_adjacency("random", points, NUM_POINTS, adj);
+	check_context("random", points, NUM_POINTS, adj);
+	delaunay2d_adjacency_release(adj);
+
+	/* the duplicates have no neighbours */
+	for( i = 0; i < NUM_POINTS / 10; i++ )
+		points[(unsigned int)(check_random() * NUM_POINTS)]	= points[i];
+
+	adj	= delaunay2d_adjacency_from(points, NUM_POINTS);
+	check_adjacency("duplicates", points, NUM_POINTS, adj);
+	delaunay2d_adjacency_release(adj);
+
+	/* the cocircular faces have no diagonals */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= (real)(i % GRID_SIZE);
+		points[i].y	= (real)(i / GRID_SIZE);
+	}
+
+	adj	= delaunay2d_adjacency_from(points, GRID_SIZE * GRID_SIZE);
+	check_adjacency("grid", points, GRID_SIZE * GRID_SIZE, adj);
+	CHECK( adj->offsets[GRID_SIZE * GRID_SIZE] == 4 * GRID_SIZE * (GRID_SIZE - 1), "grid: %u neighbours, %u expected", adj->offsets[GRID_SIZE * GRID_SIZE], 4 * GRID_SIZE * (GRID_SIZE - 1) );
+	delaunay2d_adjacency_release(adj);
+
+	free(points);
+
+	return check_done("adjacency");
+}
@@ -0,0 +1,105 @@
+/*
+**  batch.c : check the batch builds against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_SETS	40
+#define MAX_POINTS	2000
+
+/*
+* compare the result of a set with a fresh build: triangles, duplicates and
+* their representatives
+*/
+static void check_result( const char *what, const del_point_set_t *set, const delaunay2d_t *res )
+{
+	delaunay2d_t	*del	= delaunay2d_from(set->points, set->num_points);
+	unsigned int	num_tris, num_fresh;
+	unsigned int	*tris	= check_face_tris(res, &num_tris);
+	unsigned int	*fresh	= check_face_tris(del, &num_fresh);
+
+	CHECK( res->num_points == set->num_points && res->points == set->points, "%s: the result points aren't the set ones", what );
+	check_same(what, tris, num_tris, fresh, num_fresh);
+
+	CHECK( res->num_duplicates == del->num_duplicates, "%s: %u duplicates, %u in a fresh build", what, res->num_duplicates, del->num_duplicates );
+	CHECK( (res->representatives == NULL) == (del->representatives == NULL), "%s: the representatives differ from a fresh build", what );
+	if( res->representatives != NULL && del->representatives != NULL )
+		CHECK( memcmp(res->representatives, del->representatives, set->num_points * sizeof(unsigned int)) == 0, "%s: the representatives differ from a fresh build", what );
+
+	free(fresh);
+	free(tris);
+	delaunay2d_release(del);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point_set_t		sets[NUM_SETS];
+	delaunay2d_t		results[NUM_SETS];
+	delaunay2d_batch_t	*batch;
+	delaunay2d_t		*res;
+	unsigned int		*arena;
+	unsigned int		i, j, round;
+
+	(void)argc;
+	(void)argv;
+
+	/* sizes from a few points to MAX_POINTS, some of them with duplicates */
+	for( i = 0; i < NUM_SETS; i++ )
+	{
+		sets[i].num_points	= 3 + (unsigned int)(check_random() * (MAX_POINTS - 3));
+		sets[i].points		= (del_point2d_t*)malloc(sets[i].num_points * sizeof(del_point2d_t));
+
+		for( j = 0; j < sets[i].num_points; j++ ) {
+			sets[i].points[j].x	= 100.0 * check_random();
+			sets[i].points[j].y	= 100.0 * check_random();
+		}
+
+		if( i % 3 == 0 )
+			for( j = 0; j < sets[i].num_points / 10; j++ )
+				sets[i].points[(unsigned int)(check_random() * sets[i].num_points)]	= sets[i].points[j];
+	}
+
+	delaunay2d_set_num_threads(4);
+	batch	= delaunay2d_batch_create();
+	delaunay2d_set_num_threads(1);
+
+	/* twice, so the second build reuses the worker buffers */
+	for( round = 0; round < 2; round++ )
+	{
+		res	= delaunay2d_batch_from(batch, sets, NUM_SETS);
+		for( i = 0; i < NUM_SETS; i++ )
+			check_result("batch", &sets[i], &res[i]);
+	}
+
+	arena	= (unsigned int*)malloc(delaunay2d_batch_arena_size(sets, NUM_SETS) * sizeof(unsigned int));
+	CHECK( delaunay2d_batch_into(batch, sets, NUM_SETS, results, arena) == 0, "some sets don't fit the caller arena" );
+	for( i = 0; i < NUM_SETS; i++ )
+		check_result("batch into", &sets[i], &results[i]);
+
+	/* the caller results don't depend on the batch anymore */
+	delaunay2d_batch_from(batch, sets, NUM_SETS / 2);
+	delaunay2d_batch_release(batch);
+	for( i = 0; i < NUM_SETS; i++ )
+		check_result("batch into after release", &sets[i], &results[i]);
+
+	free(arena);
+	for( i = 0; i < NUM_SETS; i++ )
+		free(sets[i].points);
+
+	return check_done("batch");
+}
@@ -0,0 +1,377 @@
+/*
+**  check.h : checks shared by the delaunay tests.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DELAUNAY_CHECK_H
+#define DELAUNAY_CHECK_H
+
+/*
+* the tests build a triangulation some other way (mesh updates, streaming)
+* and compare it with a fresh delaunay2d_from() of the same points: same
+* triangle set (the points are random, so no 4 of them are cocircular), and
+* no point inside the circle of any triangle
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "../delaunay.h"
+
+/* failed checks of the test */
+static unsigned int		check_failures	= 0;
+
+#define CHECK(cond, ...)	do { if( !(cond) ) { check_failures++; fprintf(stderr, "%s:%d: ", __FILE__, __LINE__); fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } } while( 0 )
+
+/*
+* xorshift, so every run sees the same points
+*/
+static unsigned long long	check_seed	= 88172645463325252ull;
+
+static inline double check_random(void)
+{
+	check_seed	^= check_seed << 13;
+	check_seed	^= check_seed >> 7;
+	check_seed	^= check_seed << 17;
+
+	return (double)(check_seed >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/*
+* orientation of (a, b, c), positive when counterclockwise
+*/
+static inline long double check_orient( const del_point2d_t *a, const del_point2d_t *b, const del_point2d_t *c )
+{
+	return ((long double)b->x - a->x) * ((long double)c->y - a->y) - ((long double)b->y - a->y) * ((long double)c->x - a->x);
+}
+
+/*
+* test if d is clearly inside the circle of the counterclockwise a, b, c: the
+* determinant is past a loose bound of its rounding error
+*/
+static inline int check_inside( const del_point2d_t *a, const del_point2d_t *b, const del_point2d_t *c, const del_point2d_t *d )
+{
+	long double	adx	= (long double)a->x - d->x, ady = (long double)a->y - d->y;
+	long double	bdx	= (long double)b->x - d->x, bdy = (long double)b->y - d->y;
+	long double	cdx	= (long double)c->x - d->x, cdy = (long double)c->y - d->y;
+	long double	al	= adx * adx + ady * ady;
+	long double	bl	= bdx * bdx + bdy * bdy;
+	long double	cl	= cdx * cdx + cdy * cdy;
+	long double	det	= al * (bdx * cdy - cdx * bdy) + bl * (cdx * ady - adx * cdy) + cl * (adx * bdy - bdx * ady);
+	long double	perm	= al * (fabsl(bdx * cdy) + fabsl(cdx * bdy)) + bl * (fabsl(cdx * ady) + fabsl(adx * cdy)) + cl * (fabsl(adx * bdy) + fabsl(bdx * ady));
+
+	return det > perm * 1e-12L;
+}
+
+static inline int check_tri_cmp( const void *a, const void *b )
+{
+	const unsigned int	*ta	= (const unsigned int*)a;
+	const unsigned int	*tb	= (const unsigned int*)b;
+	int			i;
+
+	for( i = 0; i < 3; i++ )
+		if( ta[i] != tb[i] )
+			return ta[i] < tb[i] ? -1 : 1;
+
+	return 0;
+}
+
+/*
+* canonical form of a triangle list: the flat triangles are left out, each
+* triangle starts at its lowest vertex (keeping its orientation) and the list
+* is sorted. Returns the triangle count left
+*/
+static inline unsigned int check_canon( const del_point2d_t *points, unsigned int *tris, unsigned int num_tris )
+{
+	unsigned int	i, n, a, b, c;
+
+	for( i = 0, n = 0; i < num_tris; i++ )
+	{
+		a	= tris[3 * i];
+		b	= tris[3 * i + 1];
+		c	= tris[3 * i + 2];
+
+		if( check_orient(&points[a], &points[b], &points[c]) == 0 )
+			continue;
+
+		if( b < a && b < c ) {
+			tris[3 * n] = b;	tris[3 * n + 1] = c;	tris[3 * n + 2] = a;
+		} else if( c < a && c < b ) {
+			tris[3 * n] = c;	tris[3 * n + 1] = a;	tris[3 * n + 2] = b;
+		} else {
+			tris[3 * n] = a;	tris[3 * n + 1] = b;	tris[3 * n + 2] = c;
+		}
+		n++;
+	}
+
+	qsort(tris, n, 3 * sizeof(unsigned int), check_tri_cmp);
+
+	return n;
+}
+
+/*
+* canonical triangles of a fresh build of points, with their indices. map,
+* when given, gives the index reported for each point
+*/
+static inline unsigned int* check_fresh( const del_point2d_t *points, unsigned int num_points, const unsigned int *map, const del_point2d_t *all, unsigned int *num_tris )
+{
+	delaunay2d_t		*del	= delaunay2d_from((del_point2d_t*)points, num_points);
+	tri_delaunay2d_t	*tdel	= tri_delaunay2d_from(del);
+	unsigned int		*tris	= (unsigned int*)malloc((3 * tdel->num_triangles + 1) * sizeof(unsigned int));
+	unsigned int		i;
+
+	for( i = 0; i < 3 * tdel->num_triangles; i++ )
+		tris[i]	= map ? map[tdel->tris[i]] : tdel->tris[i];
+
+	*num_tris	= check_canon(all ? all : points, tris, tdel->num_triangles);
+
+	tri_delaunay2d_release(tdel);
+	delaunay2d_release(del);
+
+	return tris;
+}
+
+/*
+* compare a canonical triangle list with the fresh build one
+*/
+static inline void check_same( const char *what, const unsigned int *tris, unsigned int num_tris, const unsigned int *fresh, unsigned int num_fresh )
+{
+	CHECK( num_tris == num_fresh, "%s: %u triangles, %u in a fresh build", what, num_tris, num_fresh );
+	if( num_tris == num_fresh )
+		CHECK( memcmp(tris, fresh, 3 * num_tris * sizeof(unsigned int)) == 0, "%s: the triangles differ from a fresh build", what );
+}
+
+/*
+* check that no point (but the ones gone says are removed) is inside the circle
+* of a triangle, and that the triangles are counterclockwise
+*/
+static inline void check_empty_circles( const char *what, const del_point2d_t *points, const unsigned char *gone, unsigned int num_points, const unsigned int *tris, unsigned int num_tris )
+{
+	unsigned int		t, i, bad = 0, flipped = 0;
+	const del_point2d_t	*a, *b, *c;
+
+	for( t = 0; t < num_tris; t++ )
+	{
+		a	= &points[tris[3 * t]];
+		b	= &points[tris[3 * t + 1]];
+		c	= &points[tris[3 * t + 2]];
+
+		if( check_orient(a, b, c) <= 0 ) {
+			flipped++;
+			continue;
+		}
+
+		for( i = 0; i < num_points; i++ )
+			if( !(gone && gone[i]) && check_inside(a, b, c, &points[i]) )
+				bad++;
+	}
+
+	CHECK( flipped == 0, "%s: %u clockwise triangles", what, flipped );
+	CHECK( bad == 0, "%s: %u points inside the circle of a triangle", what, bad );
+}
+
+/*
+* compare triangles given as point indices with a fresh build of the points,
+* same tells if they must be the same triangles (no 4 points cocircular) or
+* just as many. The triangles are copied, they can be read only
+*/
+static inline void check_tris( const char *what, const del_point2d_t *points, unsigned int num_points, const unsigned int *tris, unsigned int num_tris, int same )
+{
+	unsigned int	*copy	= (unsigned int*)malloc((3 * num_tris + 1) * sizeof(unsigned int));
+	unsigned int	*fresh;
+	unsigned int	num_fresh;
+
+	memcpy(copy, tris, 3 * num_tris * sizeof(unsigned int));
+	num_tris	= check_canon(points, copy, num_tris);
+	fresh		= check_fresh(points, num_points, NULL, NULL, &num_fresh);
+
+	if( same )
+		check_same(what, copy, num_tris, fresh, num_fresh);
+	else
+		CHECK( num_tris == num_fresh, "%s: %u triangles, %u in a fresh build", what, num_tris, num_fresh );
+
+	check_empty_circles(what, points, NULL, num_points, copy, num_tris);
+
+	free(fresh);
+	free(copy);
+}
+
+/*
+* an edge of a triangle, with its vertices in order, and the vertex across it
+*/
+typedef struct {
+	unsigned int	a, b;			/* the edge vertices, a < b */
+	unsigned int	tri;			/* its triangle */
+	unsigned int	opposite;		/* the triangle vertex across it */
+} check_edge_t;
+
+static inline int check_edge_cmp( const void *a, const void *b )
+{
+	const check_edge_t	*ea	= (const check_edge_t*)a;
+	const check_edge_t	*eb	= (const check_edge_t*)b;
+
+	if( ea->a != eb->a )
+		return ea->a < eb->a ? -1 : 1;
+	if( ea->b != eb->b )
+		return ea->b < eb->b ? -1 : 1;
+	return 0;
+}
+
+/*
+* check_empty_circles() for large triangulations: every edge borders 2
+* triangles at most, and the vertex across it in one is not inside the circle
+* of the other. A triangulation locally Delaunay at every edge is Delaunay
+*/
+static inline void check_local_delaunay( const char *what, const del_point2d_t *points, const unsigned int *tris, unsigned int num_tris )
+{
+	check_edge_t	*edges	= (check_edge_t*)malloc((3 * num_tris + 1) * sizeof(check_edge_t));
+	unsigned int	t, i, u, v, bad = 0, shared = 0, flipped = 0;
+	const unsigned int	*t0, *t1;
+
+	for( t = 0; t < num_tris; t++ )
+	{
+		if( check_orient(&points[tris[3 * t]], &points[tris[3 * t + 1]], &points[tris[3 * t + 2]]) <= 0 )
+			flipped++;
+
+		for( i = 0; i < 3; i++ )
+		{
+			u	= tris[3 * t + i];
+			v	= tris[3 * t + (i + 1) % 3];
+
+			edges[3 * t + i].a		= u < v ? u : v;
+			edges[3 * t + i].b		= u < v ? v : u;
+			edges[3 * t + i].tri		= t;
+			edges[3 * t + i].opposite	= tris[3 * t + (i + 2) % 3];
+		}
+	}
+
+	qsort(edges, 3 * num_tris, sizeof(check_edge_t), check_edge_cmp);
+
+	for( i = 0; i < 3 * num_tris; i++ )
+	{
+		if( i + 1 == 3 * num_tris || check_edge_cmp(&edges[i], &edges[i + 1]) != 0 )
+			continue;
+
+		if( i + 2 < 3 * num_tris && check_edge_cmp(&edges[i], &edges[i + 2]) == 0 ) {
+			shared++;
+			continue;
+		}
+
+		t0	= tris + 3 * edges[i].tri;
+		t1	= tris + 3 * edges[i + 1].tri;
+		if( check_inside(&points[t0[0]], &points[t0[1]], &points[t0[2]], &points[edges[i + 1].opposite]) ||
+		    check_inside(&points[t1[0]], &points[t1[1]], &points[t1[2]], &points[edges[i].opposite]) )
+			bad++;
+		i++;
+	}
+
+	CHECK( flipped == 0, "%s: %u clockwise triangles", what, flipped );
+	CHECK( shared == 0, "%s: %u edges border more than 2 triangles", what, shared );
+	CHECK( bad == 0, "%s: %u edges that aren't locally Delaunay", what, bad );
+
+	free(edges);
+}
+
+/*
+* check the triangle across each edge v0v1, v1v2, v2v0: it has the edge the
+* other way, and an edge without one has no triangle on its other side
+*/
+static inline void check_neighbors( const char *what, const unsigned int *tris, const unsigned int *neighbors, unsigned int num_tris )
+{
+	unsigned int	c, d, n, a, b, bad = 0;
+
+	for( c = 0; c < 3 * num_tris; c++ )
+	{
+		a	= tris[c];
+		b	= tris[c - c % 3 + (c + 1) % 3];
+		n	= neighbors[c];
+
+		if( n == (unsigned int)-1 ) {
+			/* a hull edge: no triangle has ba */
+			for( d = 0; d < 3 * num_tris; d++ )
+				if( tris[d] == b && tris[d - d % 3 + (d + 1) % 3] == a )
+					bad++;
+			continue;
+		}
+
+		if( n >= num_tris ) {
+			bad++;
+			continue;
+		}
+
+		for( d = 3 * n; d < 3 * n + 3; d++ )
+			if( tris[d] == b && tris[d - d % 3 + (d + 1) % 3] == a )
+				break;
+
+		if( d == 3 * n + 3 )
+			bad++;
+	}
+
+	CHECK( bad == 0, "%s: %u wrong neighbours", what, bad );
+}
+
+/*
+* the inner faces of a topology, as a canonical triangle list. They must all
+* be triangles
+*/
+static inline unsigned int* check_face_tris( const delaunay2d_t *del, unsigned int *num_tris )
+{
+	unsigned int	*tris	= (unsigned int*)malloc((3 * del->num_faces + 1) * sizeof(unsigned int));
+	unsigned int	f, o, n;
+
+	for( f = 0, o = 0, n = 0; f < del->num_faces; f++, o += del->faces[o] + 1 )
+	{
+		if( f == 0 )
+			continue;
+
+		CHECK( del->faces[o] == 3, "face %u has %u vertices", f, del->faces[o] );
+		if( del->faces[o] != 3 )
+			continue;
+
+		memcpy(tris + 3 * n, del->faces + o + 1, 3 * sizeof(unsigned int));
+		n++;
+	}
+
+	*num_tris	= check_canon(del->points, tris, n);
+
+	return tris;
+}
+
+/*
+* the inner faces of a mesh, as a canonical triangle list
+*/
+static inline unsigned int* check_mesh_tris( delaunay2d_mesh_t *mesh, unsigned int *num_tris )
+{
+	return check_face_tris(delaunay2d_mesh_faces(mesh), num_tris);
+}
+
+/*
+* exit status of the test
+*/
+static inline int check_done( const char *name )
+{
+	if( check_failures > 0 )
+		fprintf(stderr, "%s: %u failed checks\n", name, check_failures);
+	else
+		printf("%s: ok\n", name);
+
+	return check_failures > 0;
+}
+
+#endif /* DELAUNAY_CHECK_H */
@@ -0,0 +1,198 @@
+/*
+**  file.c : check the point and triangulation files.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+#define FILE_PATH	"test_file.del"
+#define HEADER_SIZE	32
+
+/*
+* overwrite an uint32 of a file
+*/
+static void file_poke( const char *path, long offset, unsigned int value )
+{
+	FILE	*f	= fopen(path, "r+b");
+
+	if( f == NULL )
+		return;
+
+	fseek(f, offset, SEEK_SET);
+	fwrite(&value, sizeof(unsigned int), 1, f);
+	fclose(f);
+}
+
+/*
+* cut a file to its first size bytes
+*/
+static void file_cut( const char *path, long size )
+{
+	FILE	*f	= fopen(path, "rb");
+	char	*data	= (char*)malloc(size);
+	size_t	n	= 0;
+
+	if( f != NULL ) {
+		n	= fread(data, 1, size, f);
+		fclose(f);
+	}
+
+	f	= fopen(path, "wb");
+	if( f != NULL ) {
+		fwrite(data, 1, n, f);
+		fclose(f);
+	}
+
+	free(data);
+}
+
+/*
+* a triangulation file written and mapped back: same points, triangles and
+* neighbours
+*/
+static void test_round_trip( const del_point2d_t *points )
+{
+	tri_delaunay2d_t	*tdel	= tri_delaunay2d_neighbors_from(points, NUM_POINTS);
+	const tri_delaunay2d_t	*ftdel;
+	del_file_t		*file;
+
+	CHECK( tri_delaunay2d_write_file(tdel, 1, FILE_PATH) == 1, "can't write %s", FILE_PATH );
+
+	file	= del_file_open(FILE_PATH);
+	CHECK( file != NULL, "can't open %s", FILE_PATH );
+	if( file != NULL ) {
+		ftdel	= del_file_triangles(file);
+
+		CHECK( ftdel->num_points == NUM_POINTS && memcmp(ftdel->points, points, NUM_POINTS * sizeof(del_point2d_t)) == 0, "the file points differ" );
+		CHECK( ftdel->num_triangles == tdel->num_triangles && memcmp(ftdel->tris, tdel->tris, 3 * tdel->num_triangles * sizeof(unsigned int)) == 0, "the file triangles differ" );
+		CHECK( del_file_neighbors(file) != NULL && memcmp(del_file_neighbors(file), tdel->neighbors, 3 * tdel->num_triangles * sizeof(unsigned int)) == 0, "the file neighbours differ" );
+
+		check_tris("round trip", points, NUM_POINTS, ftdel->tris, ftdel->num_triangles, 1);
+		check_neighbors("round trip", ftdel->tris, ftdel->neighbors, ftdel->num_triangles);
+
+		del_file_close(file);
+	}
+
+	tri_delaunay2d_release(tdel);
+}
+
+/*
+* a triangulation built straight into a file, from the points of a point file
+*/
+static void test_context_file( const del_point2d_t *points )
+{
+	delaunay2d_context_t	*ctx	= delaunay2d_context_create();
+	const tri_delaunay2d_t	*ftdel;
+	del_file_t		*file;
+
+	CHECK( del_file_write_points(FILE_PATH, points, NUM_POINTS) == 1, "can't write %s", FILE_PATH );
+
+	file	= del_file_open(FILE_PATH);
+	CHECK( file != NULL, "can't open the point file %s", FILE_PATH );
+	if( file != NULL ) {
+		ftdel	= del_file_triangles(file);
+		CHECK( ftdel->num_points == NUM_POINTS && ftdel->num_triangles == 0, "the point file has %u points and %u triangles", ftdel->num_points, ftdel->num_triangles );
+		del_file_close(file);
+	}
+
+	CHECK( tri_delaunay2d_context_file(ctx, points, NUM_POINTS, 1, FILE_PATH) == 1, "can't build %s", FILE_PATH );
+
+	file	= del_file_open(FILE_PATH);
+	CHECK( file != NULL, "can't open %s", FILE_PATH );
+	if( file != NULL ) {
+		ftdel	= del_file_triangles(file);
+		check_tris("context file", points, NUM_POINTS, ftdel->tris, ftdel->num_triangles, 1);
+		check_neighbors("context file", ftdel->tris, ftdel->neighbors, ftdel->num_triangles);
+		del_file_close(file);
+	}
+
+	delaunay2d_context_release(ctx);
+}
+
+/*
+* files whose indices are out of range don't open
+*/
+static void test_invalid( const del_point2d_t *points )
+{
+	tri_delaunay2d_t	*tdel	= tri_delaunay2d_neighbors_from(points, NUM_POINTS);
+	long			tris	= HEADER_SIZE + NUM_POINTS * (long)sizeof(del_point2d_t);
+	long			neighbors	= tris + 3 * (long)tdel->num_triangles * (long)sizeof(unsigned int);
+	unsigned int		c;
+	del_file_t		*file;
+
+	/* a vertex past the points */
+	tri_delaunay2d_write_file(tdel, 1, FILE_PATH);
+	file_poke(FILE_PATH, tris + 7 * sizeof(unsigned int), NUM_POINTS);
+	file	= del_file_open(FILE_PATH);
+	CHECK( file == NULL, "a file with a vertex past the points opens" );
+	if( file != NULL )
+		del_file_close(file);
+
+	/* a neighbour past the triangles */
+	tri_delaunay2d_write_file(tdel, 1, FILE_PATH);
+	file_poke(FILE_PATH, neighbors + 4 * sizeof(unsigned int), tdel->num_triangles);
+	file	= del_file_open(FILE_PATH);
+	CHECK( file == NULL, "a file with a neighbour past the triangles opens" );
+	if( file != NULL )
+		del_file_close(file);
+
+	/* a neighbour that doesn't point back: the first triangle not next to
+	   triangle 0 */
+	for( c = 3; c < 3 * tdel->num_triangles; c++ )
+		if( c % 3 == 0 && tdel->neighbors[c] != 0 && tdel->neighbors[c + 1] != 0 && tdel->neighbors[c + 2] != 0 )
+			break;
+	tri_delaunay2d_write_file(tdel, 1, FILE_PATH);
+	file_poke(FILE_PATH, neighbors, c / 3);
+	file	= del_file_open(FILE_PATH);
+	CHECK( file == NULL, "a file with a one way neighbour opens" );
+	if( file != NULL )
+		del_file_close(file);
+
+	/* a truncated file */
+	tri_delaunay2d_write_file(tdel, 1, FILE_PATH);
+	file_cut(FILE_PATH, neighbors);
+	file	= del_file_open(FILE_PATH);
+	CHECK( file == NULL, "a truncated file opens" );
+	if( file != NULL )
+		del_file_close(file);
+
+	tri_delaunay2d_release(tdel);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	test_round_trip(points);
+	test_context_file(points);
+	test_invalid(points);
+
+	remove(FILE_PATH);
+	free(points);
+
+	return check_done("file");
+}
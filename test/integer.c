@@ -0,0 +1,107 @@
+/*
+**  integer.c : check the integer predicates against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+#define GRID_SIZE	40
+
+/*
+* build the points with the integer and the filtered predicates: both are
+* exact, they give the same faces
+*/
+static void check_integer( const char *what, const del_point2d_t *points, unsigned int num_points )
+{
+	delaunay2d_context_t	*ictx	= delaunay2d_context_create();
+	delaunay2d_context_t	*fctx	= delaunay2d_context_create();
+	delaunay2d_t		*del, *filtered;
+	tri_delaunay2d_t	*tdel;
+	unsigned int		f, size;
+
+	delaunay2d_context_set_predicates(ictx, DEL_PREDICATES_INTEGER);
+	delaunay2d_context_set_predicates(fctx, DEL_PREDICATES_FILTERED);
+
+	del		= delaunay2d_context_from(ictx, (del_point2d_t*)points, num_points);
+	filtered	= delaunay2d_context_from(fctx, (del_point2d_t*)points, num_points);
+
+	for( f = 0, size = 0; f < del->num_faces; f++ )
+		size	+= del->faces[size] + 1;
+
+	CHECK( del->num_faces == filtered->num_faces, "%s: %u faces, %u with the filtered predicates", what, del->num_faces, filtered->num_faces );
+	if( del->num_faces == filtered->num_faces )
+		CHECK( memcmp(del->faces, filtered->faces, size * sizeof(unsigned int)) == 0, "%s: the faces differ from the filtered predicates ones", what );
+
+	tdel	= tri_delaunay2d_from(del);
+	check_local_delaunay(what, points, tdel->tris, tdel->num_triangles);
+	tri_delaunay2d_release(tdel);
+
+	delaunay2d_context_release(fctx);
+	delaunay2d_context_release(ictx);
+}
+
+/*
+* random integer coordinates within +/- range
+*/
+static void integer_points( del_point2d_t *points, unsigned int num_points, double range )
+{
+	unsigned int	i;
+
+	for( i = 0; i < num_points; i++ ) {
+		points[i].x	= floor((2.0 * check_random() - 1.0) * range);
+		points[i].y	= floor((2.0 * check_random() - 1.0) * range);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	(void)argc;
+	(void)argv;
+
+	/* the duplicates of a small range are left out as with any predicates */
+	integer_points(points, NUM_POINTS, ldexp(1.0, 10));
+	check_integer("small range", points, NUM_POINTS);
+
+	/* the largest coordinates the 128 bits incircle holds */
+	integer_points(points, NUM_POINTS, ldexp(1.0, 29));
+	check_integer("2^29 range", points, NUM_POINTS);
+
+	/* cocircular points: the faces are the grid squares */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= (real)(i % GRID_SIZE) * 1000.0 - 20000.0;
+		points[i].y	= (real)(i / GRID_SIZE) * 1000.0 - 20000.0;
+	}
+	check_integer("grid", points, GRID_SIZE * GRID_SIZE);
+
+	/* a point that isn't an integer, or past 2^29: the build falls back to
+	   the filtered predicates */
+	integer_points(points, NUM_POINTS, ldexp(1.0, 20));
+	points[NUM_POINTS / 2].x	+= 0.5;
+	check_integer("fraction", points, NUM_POINTS);
+
+	integer_points(points, NUM_POINTS, ldexp(1.0, 20));
+	points[NUM_POINTS / 2].y	= ldexp(1.0, 31);
+	check_integer("past 2^29", points, NUM_POINTS);
+
+	free(points);
+
+	return check_done("integer");
+}
@@ -0,0 +1,154 @@
+/*
+**  locate.c : check the point location against a brute force.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+/* past DEL_PARALLEL_CUTOFF, so the batch is split over the threads */
+#define NUM_QUERIES	40000
+
+/*
+* side of q for the triangle t: 1 when it is clearly inside, -1 when it is
+* clearly outside an edge, 0 on its edges (within the rounding error)
+*/
+static int locate_side( const tri_delaunay2d_t *tdel, unsigned int t, const del_point2d_t *q )
+{
+	const del_point2d_t	*a, *b;
+	long double		o, bound;
+	unsigned int		i;
+	int			side	= 1;
+
+	for( i = 0; i < 3; i++ )
+	{
+		a	= &tdel->points[tdel->tris[3 * t + i]];
+		b	= &tdel->points[tdel->tris[3 * t + (i + 1) % 3]];
+		o	= check_orient(a, b, q);
+		bound	= (fabsl((long double)b->x - a->x) + fabsl((long double)b->y - a->y)) *
+			  (fabsl((long double)q->x - a->x) + fabsl((long double)q->y - a->y)) * 1e-12L;
+
+		if( o < -bound )
+			return -1;
+		if( o <= bound )
+			side	= 0;
+	}
+
+	return side;
+}
+
+/*
+* test if q is clearly inside the hull: on the left of each hull edge, the
+* triangle edges without a neighbour (the hull of random points is convex)
+*/
+static int locate_in_hull( const tri_delaunay2d_t *ntdel, const del_point2d_t *q )
+{
+	const del_point2d_t	*a, *b;
+	unsigned int		c;
+
+	for( c = 0; c < 3 * ntdel->num_triangles; c++ )
+	{
+		if( ntdel->neighbors[c] != (unsigned int)-1 )
+			continue;
+
+		a	= &ntdel->points[ntdel->tris[c]];
+		b	= &ntdel->points[ntdel->tris[c - c % 3 + (c + 1) % 3]];
+		if( check_orient(a, b, q) <= 1e-6L )
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+* locate the queries: each found triangle holds its query, and the queries
+* not found are not clearly inside the hull
+*/
+static void check_locate( const char *what, const tri_delaunay2d_t *tdel, const tri_delaunay2d_t *ntdel, const del_point2d_t *queries, unsigned int num_threads )
+{
+	unsigned int			*tris	= (unsigned int*)malloc(NUM_QUERIES * sizeof(unsigned int));
+	tri_delaunay2d_locator_t	*loc;
+	unsigned int			q, num_found, num_inside = 0, wrong = 0, missed = 0;
+
+	delaunay2d_set_num_threads(num_threads);
+	loc	= tri_delaunay2d_locator_create(tdel);
+	delaunay2d_set_num_threads(1);
+
+	num_found	= tri_delaunay2d_locate(loc, queries, NUM_QUERIES, tris);
+
+	for( q = 0; q < NUM_QUERIES; q++ )
+	{
+		if( tris[q] != (unsigned int)-1 ) {
+			num_inside++;
+			if( tris[q] >= tdel->num_triangles || locate_side(tdel, tris[q], &queries[q]) < 0 )
+				wrong++;
+		} else if( locate_in_hull(ntdel, &queries[q]) )
+			missed++;
+	}
+
+	CHECK( num_found == num_inside, "%s, %u threads: %u queries found, %u triangles given", what, num_threads, num_found, num_inside );
+	CHECK( wrong == 0, "%s, %u threads: %u queries out of their triangle", what, num_threads, wrong );
+	CHECK( missed == 0, "%s, %u threads: %u queries inside the hull not found", what, num_threads, missed );
+
+	tri_delaunay2d_locator_release(loc);
+	free(tris);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t		*points		= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	del_point2d_t		*queries	= (del_point2d_t*)malloc(NUM_QUERIES * sizeof(del_point2d_t));
+	tri_delaunay2d_t	*tdel, *ntdel;
+	unsigned int		i, t;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	/* a margin around the points, so some queries are out of the hull */
+	for( i = 0; i < NUM_QUERIES; i++ ) {
+		queries[i].x	= 1200.0 * check_random() - 100.0;
+		queries[i].y	= 1200.0 * check_random() - 100.0;
+	}
+
+	tdel	= tri_delaunay2d_points_from(points, NUM_POINTS);
+	ntdel	= tri_delaunay2d_neighbors_from(points, NUM_POINTS);
+
+	/* the vertices and the edge middles are on the triangle boundaries */
+	for( i = 0; i < NUM_POINTS; i++ )
+		queries[i]	= points[i];
+	for( t = 0; t < tdel->num_triangles && i < 2 * NUM_POINTS; t++, i++ ) {
+		queries[i].x	= (points[tdel->tris[3 * t]].x + points[tdel->tris[3 * t + 1]].x) / 2.0;
+		queries[i].y	= (points[tdel->tris[3 * t]].y + points[tdel->tris[3 * t + 1]].y) / 2.0;
+	}
+
+	check_locate("own neighbours", tdel, ntdel, queries, 1);
+	check_locate("own neighbours", tdel, ntdel, queries, 4);
+	check_locate("given neighbours", ntdel, ntdel, queries, 1);
+	check_locate("given neighbours", ntdel, ntdel, queries, 4);
+
+	tri_delaunay2d_release(ntdel);
+	tri_delaunay2d_release(tdel);
+	free(queries);
+	free(points);
+
+	return check_done("locate");
+}
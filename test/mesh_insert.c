@@ -0,0 +1,163 @@
+/*
+**  mesh_insert.c : check the points inserted in a mesh against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_BASE	200
+#define NUM_INSERTS	3000
+#define CHECK_EVERY	500
+#define GRID_SIZE	24
+
+/*
+* compare the mesh with a fresh build of its points
+*/
+static void check_mesh( const char *what, delaunay2d_mesh_t *mesh, const del_point2d_t *points, unsigned int num_points, int same )
+{
+	unsigned int	num_tris, num_fresh;
+	unsigned int	*tris	= check_mesh_tris(mesh, &num_tris);
+	unsigned int	*fresh	= check_fresh(points, num_points, NULL, NULL, &num_fresh);
+
+	if( same )
+		check_same(what, tris, num_tris, fresh, num_fresh);
+	else	/* cocircular points: any of their triangulations will do */
+		CHECK( num_tris == num_fresh, "%s: %u triangles, %u in a fresh build", what, num_tris, num_fresh );
+
+	check_empty_circles(what, points, NULL, num_points, tris, num_tris);
+
+	free(fresh);
+	free(tris);
+}
+
+/*
+* random points, inside and around the hull of the first ones
+*/
+static void test_random(void)
+{
+	del_point2d_t		*points	= (del_point2d_t*)malloc((NUM_BASE + NUM_INSERTS) * sizeof(del_point2d_t));
+	delaunay2d_mesh_t	*mesh;
+	unsigned int		i, n, idx;
+
+	for( i = 0; i < NUM_BASE; i++ ) {
+		points[i].x	= 250.0 + 500.0 * check_random();
+		points[i].y	= 250.0 + 500.0 * check_random();
+	}
+
+	mesh	= delaunay2d_mesh_from(points, NUM_BASE);
+	check_mesh("random base", mesh, points, NUM_BASE, 1);
+
+	for( i = 0, n = NUM_BASE; i < NUM_INSERTS; i++ )
+	{
+		points[n].x	= 1000.0 * check_random();
+		points[n].y	= 1000.0 * check_random();
+
+		idx	= delaunay2d_mesh_insert(mesh, points[n]);
+		CHECK( idx == n, "insert %u: index %u, expected %u", i, idx, n );
+		n++;
+
+		/* a point that is already there keeps its index */
+		if( i % 97 == 0 ) {
+			idx	= delaunay2d_mesh_insert(mesh, points[i]);
+			CHECK( idx == i, "insert of point %u again: index %u", i, idx );
+		}
+
+		if( n % CHECK_EVERY == 0 )
+			check_mesh("random inserts", mesh, points, n, 1);
+	}
+
+	check_mesh("random inserts", mesh, points, n, 1);
+
+	delaunay2d_mesh_release(mesh);
+	free(points);
+}
+
+/*
+* a grid inserted one point at a time from a single triangle: many points are
+* cocircular, and a point lands on an edge at each step
+*/
+static void test_grid(void)
+{
+	del_point2d_t		points[GRID_SIZE * GRID_SIZE];
+	delaunay2d_mesh_t	*mesh;
+	unsigned int		i, n, idx;
+
+	points[0].x	= 0;	points[0].y	= 0;
+	points[1].x	= GRID_SIZE - 1;	points[1].y	= 0;
+	points[2].x	= 0;	points[2].y	= GRID_SIZE - 1;
+
+	mesh	= delaunay2d_mesh_from(points, 3);
+
+	for( i = 0, n = 3; i < GRID_SIZE * GRID_SIZE; i++ )
+	{
+		del_point2d_t	pt;
+
+		pt.x	= (real)(i % GRID_SIZE);
+		pt.y	= (real)(i / GRID_SIZE);
+
+		if( (pt.x == 0 && pt.y == 0) || (pt.x == GRID_SIZE - 1 && pt.y == 0) || (pt.x == 0 && pt.y == GRID_SIZE - 1) )
+			continue;
+
+		points[n]	= pt;
+		idx	= delaunay2d_mesh_insert(mesh, pt);
+		CHECK( idx == n, "grid insert %u: index %u, expected %u", i, idx, n );
+		n++;
+	}
+
+	check_mesh("grid inserts", mesh, points, n, 0);
+
+	delaunay2d_mesh_release(mesh);
+}
+
+/*
+* a mesh of collinear points, that gets its first triangles from the inserts
+*/
+static void test_collinear(void)
+{
+	del_point2d_t		points[64];
+	delaunay2d_mesh_t	*mesh;
+	unsigned int		i;
+
+	for( i = 0; i < 8; i++ ) {
+		points[i].x	= (real)i;
+		points[i].y	= (real)i;
+	}
+
+	mesh	= delaunay2d_mesh_from(points, 8);
+
+	for( ; i < 64; i++ ) {
+		points[i].x	= 10.0 * check_random() - 1.0;
+		points[i].y	= 10.0 * check_random() - 1.0;
+		delaunay2d_mesh_insert(mesh, points[i]);
+	}
+
+	check_mesh("collinear start", mesh, points, 64, 1);
+
+	delaunay2d_mesh_release(mesh);
+}
+
+int main(int argc, char* argv[])
+{
+	(void)argc;
+	(void)argv;
+
+	test_random();
+	test_grid();
+	test_collinear();
+
+	return check_done("mesh_insert");
+}
@@ -0,0 +1,163 @@
+/*
+**  mesh_remove.c : check the points removed from a mesh against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+#define NUM_REMOVES	1200
+#define NUM_REINSERTS	600
+#define CHECK_EVERY	300
+
+/*
+* compare the mesh with a fresh build of the points it still has, mapped back
+* to their mesh indices
+*/
+static void check_mesh( const char *what, delaunay2d_mesh_t *mesh, const del_point2d_t *points, const unsigned char *gone, unsigned int num_points )
+{
+	del_point2d_t	*live	= (del_point2d_t*)malloc(num_points * sizeof(del_point2d_t));
+	unsigned int	*map	= (unsigned int*)malloc(num_points * sizeof(unsigned int));
+	unsigned int	i, n, num_tris, num_fresh;
+	unsigned int	*tris, *fresh;
+
+	for( i = 0, n = 0; i < num_points; i++ )
+	{
+		if( gone[i] )
+			continue;
+
+		live[n]	= points[i];
+		map[n]	= i;
+		n++;
+	}
+
+	tris	= check_mesh_tris(mesh, &num_tris);
+	fresh	= check_fresh(live, n, map, points, &num_fresh);
+
+	check_same(what, tris, num_tris, fresh, num_fresh);
+	check_empty_circles(what, points, gone, num_points, tris, num_tris);
+
+	free(fresh);
+	free(tris);
+	free(map);
+	free(live);
+}
+
+/*
+* random removals (hull points included), then insertions in the freed slots
+*/
+static void test_random(void)
+{
+	del_point2d_t		*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	unsigned char		*gone	= (unsigned char*)calloc(NUM_POINTS, 1);
+	delaunay2d_mesh_t	*mesh;
+	unsigned int		i, idx, removed = 0;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	mesh	= delaunay2d_mesh_from(points, NUM_POINTS);
+
+	while( removed < NUM_REMOVES )
+	{
+		idx	= (unsigned int)(check_random() * NUM_POINTS);
+		if( gone[idx] ) {
+			/* a removed point can't be removed again */
+			CHECK( delaunay2d_mesh_remove(mesh, idx) == 0, "point %u removed twice", idx );
+			continue;
+		}
+
+		CHECK( delaunay2d_mesh_remove(mesh, idx) == 1, "point %u not removed", idx );
+		gone[idx]	= 1;
+		removed++;
+
+		if( removed % CHECK_EVERY == 0 )
+			check_mesh("random removals", mesh, points, gone, NUM_POINTS);
+	}
+
+	CHECK( delaunay2d_mesh_remove(mesh, NUM_POINTS) == 0, "point %u past the mesh removed", NUM_POINTS );
+
+	for( i = 0; i < NUM_REINSERTS; i++ )
+	{
+		del_point2d_t	pt;
+
+		pt.x	= 1200.0 * check_random() - 100.0;
+		pt.y	= 1200.0 * check_random() - 100.0;
+
+		idx	= delaunay2d_mesh_insert(mesh, pt);
+		CHECK( idx < NUM_POINTS && gone[idx], "insert %u: index %u is not a removed point", i, idx );
+		if( idx >= NUM_POINTS )
+			break;
+
+		points[idx]	= pt;
+		gone[idx]	= 0;
+
+		if( (i + 1) % CHECK_EVERY == 0 )
+			check_mesh("insertions after removals", mesh, points, gone, NUM_POINTS);
+	}
+
+	delaunay2d_mesh_release(mesh);
+	free(gone);
+	free(points);
+}
+
+/*
+* peel the hull: remove the leftmost point until 3 are left
+*/
+static void test_hull(void)
+{
+	del_point2d_t		points[256];
+	unsigned char		gone[256];
+	delaunay2d_mesh_t	*mesh;
+	unsigned int		i, left, n;
+
+	for( i = 0; i < 256; i++ ) {
+		points[i].x	= 100.0 * check_random();
+		points[i].y	= 100.0 * check_random();
+	}
+
+	memset(gone, 0, sizeof(gone));
+	mesh	= delaunay2d_mesh_from(points, 256);
+
+	for( n = 256; n > 3; n-- )
+	{
+		for( i = 0, left = 256; i < 256; i++ )
+			if( !gone[i] && (left == 256 || points[i].x < points[left].x) )
+				left	= i;
+
+		CHECK( delaunay2d_mesh_remove(mesh, left) == 1, "hull point %u not removed", left );
+		gone[left]	= 1;
+
+		if( n % 32 == 0 || n < 8 )
+			check_mesh("hull removals", mesh, points, gone, 256);
+	}
+
+	delaunay2d_mesh_release(mesh);
+}
+
+int main(int argc, char* argv[])
+{
+	(void)argc;
+	(void)argv;
+
+	test_random();
+	test_hull();
+
+	return check_done("mesh_remove");
+}
@@ -0,0 +1,153 @@
+/*
+**  nearest.c : check the nearest point queries against a brute force.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+/* past DEL_PARALLEL_CUTOFF, so the batch is split over the threads */
+#define NUM_QUERIES	20000
+
+static double nearest_dist( const del_point2d_t *a, const del_point2d_t *b )
+{
+	return (a->x - b->x) * (a->x - b->x) + (a->y - b->y) * (a->y - b->y);
+}
+
+/*
+* the nearest point of each query is at the brute force distance
+*/
+static void check_nearest( const tri_delaunay2d_t *tdel, const del_point2d_t *queries, unsigned int num_threads )
+{
+	unsigned int			*sites	= (unsigned int*)malloc(NUM_QUERIES * sizeof(unsigned int));
+	tri_delaunay2d_locator_t	*loc;
+	unsigned int			q, v, wrong = 0;
+	double				best;
+
+	delaunay2d_set_num_threads(num_threads);
+	loc	= tri_delaunay2d_locator_create(tdel);
+	delaunay2d_set_num_threads(1);
+
+	tri_delaunay2d_nearest(loc, queries, NUM_QUERIES, sites);
+
+	for( q = 0; q < NUM_QUERIES; q++ )
+	{
+		best	= nearest_dist(&tdel->points[0], &queries[q]);
+		for( v = 1; v < tdel->num_points; v++ )
+			if( nearest_dist(&tdel->points[v], &queries[q]) < best )
+				best	= nearest_dist(&tdel->points[v], &queries[q]);
+
+		if( sites[q] >= tdel->num_points || nearest_dist(&tdel->points[sites[q]], &queries[q]) != best )
+			wrong++;
+	}
+
+	CHECK( wrong == 0, "%u threads: %u queries with a farther point than the nearest", num_threads, wrong );
+
+	tri_delaunay2d_locator_release(loc);
+	free(sites);
+}
+
+/*
+* the nearest other point of each point: a duplicate gets a point of the
+* triangles at its coordinates, the others the brute force nearest point at
+* other coordinates
+*/
+static void check_all_nearest( const tri_delaunay2d_t *tdel )
+{
+	unsigned int	*nearest	= (unsigned int*)malloc(tdel->num_points * sizeof(unsigned int));
+	unsigned char	*used		= (unsigned char*)calloc(tdel->num_points, 1);
+	unsigned int	i, v, n, wrong = 0;
+	double		best, d;
+
+	for( i = 0; i < 3 * tdel->num_triangles; i++ )
+		used[tdel->tris[i]]	= 1;
+
+	tri_delaunay2d_all_nearest(tdel, nearest);
+
+	for( i = 0; i < tdel->num_points; i++ )
+	{
+		n	= nearest[i];
+		if( n >= tdel->num_points || n == i ) {
+			wrong++;
+			continue;
+		}
+
+		if( !used[i] ) {
+			if( !used[n] || nearest_dist(&tdel->points[n], &tdel->points[i]) != 0.0 )
+				wrong++;
+			continue;
+		}
+
+		best	= -1.0;
+		for( v = 0; v < tdel->num_points; v++ ) {
+			d	= nearest_dist(&tdel->points[v], &tdel->points[i]);
+			if( d > 0.0 && (best < 0.0 || d < best) )
+				best	= d;
+		}
+
+		if( nearest_dist(&tdel->points[n], &tdel->points[i]) != best )
+			wrong++;
+	}
+
+	CHECK( wrong == 0, "%u points with a wrong nearest point", wrong );
+
+	free(used);
+	free(nearest);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t		*points		= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	del_point2d_t		*queries	= (del_point2d_t*)malloc(NUM_QUERIES * sizeof(del_point2d_t));
+	tri_delaunay2d_t	*tdel;
+	unsigned int		i;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	/* a margin around the points, the nearest of the queries out of the hull
+	   is on it */
+	for( i = 0; i < NUM_QUERIES; i++ ) {
+		queries[i].x	= 1200.0 * check_random() - 100.0;
+		queries[i].y	= 1200.0 * check_random() - 100.0;
+	}
+
+	tdel	= tri_delaunay2d_points_from(points, NUM_POINTS);
+	check_nearest(tdel, queries, 1);
+	check_nearest(tdel, queries, 4);
+	check_all_nearest(tdel);
+	tri_delaunay2d_release(tdel);
+
+	/* duplicates, some of them more than twice */
+	for( i = 0; i < NUM_POINTS / 10; i++ )
+		points[(unsigned int)(check_random() * NUM_POINTS)]	= points[i];
+
+	tdel	= tri_delaunay2d_points_from(points, NUM_POINTS);
+	check_nearest(tdel, queries, 4);
+	check_all_nearest(tdel);
+	tri_delaunay2d_release(tdel);
+
+	free(queries);
+	free(points);
+
+	return check_done("nearest");
+}
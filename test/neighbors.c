@@ -0,0 +1,104 @@
+/*
+**  neighbors.c : check the triangle neighbours against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+/* past DEL_PARALLEL_CUTOFF, too many for the brute force empty circles */
+#define LARGE_POINTS	40000
+#define GRID_SIZE	30
+
+/*
+* build the triangles and their neighbours, allocated and into caller
+* buffers on some threads: the triangles of a fresh build, and neighbours
+* across each edge
+*/
+static void check_neighbors_of( const char *what, const del_point2d_t *points, unsigned int num_points, int same, unsigned int num_threads )
+{
+	delaunay2d_context_t	*ctx	= delaunay2d_context_create();
+	unsigned int		max	= 3 * tri_delaunay2d_max_triangles(num_points);
+	unsigned int		*tris	= (unsigned int*)malloc(max * sizeof(unsigned int));
+	unsigned int		*neighbors	= (unsigned int*)malloc(max * sizeof(unsigned int));
+	tri_delaunay2d_t	*tdel;
+	unsigned int		num_tris;
+
+	tdel	= tri_delaunay2d_neighbors_from(points, num_points);
+	CHECK( tdel->neighbors != NULL, "%s: no neighbours", what );
+	if( num_points <= NUM_POINTS )
+		check_tris(what, points, num_points, tdel->tris, tdel->num_triangles, same);
+	else
+		check_local_delaunay(what, points, tdel->tris, tdel->num_triangles);
+	if( tdel->neighbors != NULL )
+		check_neighbors(what, tdel->tris, tdel->neighbors, tdel->num_triangles);
+
+	delaunay2d_context_set_num_threads(ctx, num_threads);
+	num_tris	= tri_delaunay2d_context_neighbors(ctx, points, num_points, tris, neighbors);
+
+	CHECK( num_tris == tdel->num_triangles, "%s, %u threads: %u triangles in caller buffers, %u allocated", what, num_threads, num_tris, tdel->num_triangles );
+	if( num_tris == tdel->num_triangles ) {
+		CHECK( memcmp(tris, tdel->tris, 3 * num_tris * sizeof(unsigned int)) == 0, "%s, %u threads: the caller buffer triangles differ", what, num_threads );
+		check_neighbors(what, tris, neighbors, num_tris);
+	}
+
+	tri_delaunay2d_release(tdel);
+	delaunay2d_context_release(ctx);
+	free(neighbors);
+	free(tris);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(LARGE_POINTS * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	check_neighbors_of("random", points, NUM_POINTS, 1, 1);
+
+	for( i = 0; i < LARGE_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	check_neighbors_of("large", points, LARGE_POINTS, 1, 4);
+
+	/* the duplicates are in no triangle */
+	for( i = 0; i < NUM_POINTS / 10; i++ )
+		points[(unsigned int)(check_random() * NUM_POINTS)]	= points[i];
+
+	check_neighbors_of("duplicates", points, NUM_POINTS, 1, 1);
+
+	/* the square faces are fanned, the neighbours cross the diagonals too */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= (real)(i % GRID_SIZE);
+		points[i].y	= (real)(i / GRID_SIZE);
+	}
+
+	check_neighbors_of("grid", points, GRID_SIZE * GRID_SIZE, 0, 1);
+
+	free(points);
+
+	return check_done("neighbors");
+}
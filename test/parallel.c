@@ -0,0 +1,108 @@
+/*
+**  parallel.c : check the parallel divide and conquer against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+/* enough points for the halves to go past DEL_PARALLEL_CUTOFF */
+#define NUM_POINTS	100000
+#define GRID_SIZE	300
+
+/*
+* the triangles of a topology, its polygons split, as a canonical list
+*/
+static unsigned int* parallel_tris( const delaunay2d_t *del, unsigned int *num_tris )
+{
+	tri_delaunay2d_t	*tdel	= tri_delaunay2d_from((delaunay2d_t*)del);
+	unsigned int		*tris	= (unsigned int*)malloc((3 * tdel->num_triangles + 1) * sizeof(unsigned int));
+
+	memcpy(tris, tdel->tris, 3 * tdel->num_triangles * sizeof(unsigned int));
+	*num_tris	= check_canon(del->points, tris, tdel->num_triangles);
+
+	tri_delaunay2d_release(tdel);
+
+	return tris;
+}
+
+/*
+* build points on several threads, with a context and with delaunay2d_from,
+* and compare with a fresh single threaded build
+*/
+static void check_parallel( const char *what, const del_point2d_t *points, unsigned int num_points, int same )
+{
+	delaunay2d_context_t	*ctx	= delaunay2d_context_create();
+	unsigned int		num_tris, num_fresh, num_from;
+	unsigned int		*tris, *fresh, *from;
+	delaunay2d_t		*del;
+
+	fresh	= check_fresh(points, num_points, NULL, NULL, &num_fresh);
+
+	delaunay2d_context_set_num_threads(ctx, 4);
+	tris	= parallel_tris(delaunay2d_context_from(ctx, (del_point2d_t*)points, num_points), &num_tris);
+
+	delaunay2d_set_num_threads(4);
+	del	= delaunay2d_from((del_point2d_t*)points, num_points);
+	delaunay2d_set_num_threads(1);
+	from	= parallel_tris(del, &num_from);
+
+	if( same ) {
+		check_same(what, tris, num_tris, fresh, num_fresh);
+		check_same(what, from, num_from, fresh, num_fresh);
+	} else {
+		CHECK( num_tris == num_fresh, "%s: %u triangles, %u in a fresh build", what, num_tris, num_fresh );
+		CHECK( num_from == num_fresh, "%s: %u triangles, %u in a fresh build", what, num_from, num_fresh );
+	}
+
+	check_local_delaunay(what, points, tris, num_tris);
+	check_local_delaunay(what, points, from, num_from);
+
+	delaunay2d_release(del);
+	delaunay2d_context_release(ctx);
+	free(from);
+	free(tris);
+	free(fresh);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	check_parallel("random", points, NUM_POINTS, 1);
+
+	/* the halves are split in the middle of grid columns, and the cells
+	   are cocircular: only the counts match a fresh build */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= (real)(i % GRID_SIZE);
+		points[i].y	= (real)(i / GRID_SIZE);
+	}
+
+	check_parallel("grid", points, GRID_SIZE * GRID_SIZE, 0);
+
+	free(points);
+
+	return check_done("parallel");
+}
@@ -0,0 +1,159 @@
+/*
+**  predicates.c : check the filtered predicates against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+#define CIRCLE_POINTS	500
+#define GRID_SIZE	16
+
+/*
+* edges as 64 bits keys, the lowest vertex in the high bits
+*/
+static int edge_cmp( const void *a, const void *b )
+{
+	unsigned long long	ea	= *(const unsigned long long*)a;
+	unsigned long long	eb	= *(const unsigned long long*)b;
+
+	return ea < eb ? -1 : (ea > eb);
+}
+
+#ifdef __SIZEOF_INT128__
+/*
+* exact orientation of points whose coordinates are integers once multiplied
+* by scale, below 2^58
+*/
+static int exact_orient( const del_point2d_t *a, const del_point2d_t *b, const del_point2d_t *c, double scale )
+{
+	__int128	ax	= (__int128)(long long)(a->x * scale), ay	= (__int128)(long long)(a->y * scale);
+	__int128	bx	= (__int128)(long long)(b->x * scale) - ax, by	= (__int128)(long long)(b->y * scale) - ay;
+	__int128	cx	= (__int128)(long long)(c->x * scale) - ax, cy	= (__int128)(long long)(c->y * scale) - ay;
+	__int128	det	= bx * cy - by * cx;
+
+	return (det > 0) - (det < 0);
+}
+#endif
+
+/*
+* the triangles of points without duplicates cover their hull: as many as
+* Euler's formula gives from the hull edges (the edges of a single triangle),
+* and no point inside the circle of a triangle. Where the long double check
+* can't tell the orientations, scale makes the coordinates integers for an
+* exact one
+*/
+static void check_cover( const char *what, const del_point2d_t *points, unsigned int num_points, const unsigned int *tris, unsigned int num_tris, double scale )
+{
+	unsigned long long	*edges	= (unsigned long long*)malloc((3 * num_tris + 1) * sizeof(unsigned long long));
+	unsigned int		i, u, v, num_hull = 0;
+
+	for( i = 0; i < 3 * num_tris; i++ ) {
+		u	= tris[i];
+		v	= tris[i - i % 3 + (i + 1) % 3];
+		edges[i]	= u < v ? ((unsigned long long)u << 32) | v : ((unsigned long long)v << 32) | u;
+	}
+
+	qsort(edges, 3 * num_tris, sizeof(unsigned long long), edge_cmp);
+
+	for( i = 0; i < 3 * num_tris; i++ ) {
+		if( i + 1 < 3 * num_tris && edges[i] == edges[i + 1] )
+			i++;
+		else
+			num_hull++;
+	}
+
+	CHECK( num_tris + num_hull + 2 == 2 * num_points, "%s: %u triangles and %u hull edges for %u points", what, num_tris, num_hull, num_points );
+
+	if( scale == 0.0 )
+		check_empty_circles(what, points, NULL, num_points, tris, num_tris);
+#ifdef __SIZEOF_INT128__
+	else {
+		unsigned int	flipped	= 0;
+
+		for( i = 0; i < num_tris; i++ )
+			if( exact_orient(&points[tris[3 * i]], &points[tris[3 * i + 1]], &points[tris[3 * i + 2]], scale) <= 0 )
+				flipped++;
+		CHECK( flipped == 0, "%s: %u clockwise or flat triangles", what, flipped );
+	}
+#endif
+
+	free(edges);
+}
+
+/*
+* build the points with some predicates, and compare with a fresh build, or
+* when they are degenerate (the fresh build may be wrong) check the cover
+*/
+static void check_predicates( const char *what, const del_point2d_t *points, unsigned int num_points, del_predicates_t predicates, int same, double scale )
+{
+	delaunay2d_context_t	*ctx	= delaunay2d_context_create();
+	tri_delaunay2d_t	*tdel;
+
+	delaunay2d_context_set_predicates(ctx, predicates);
+	tdel	= tri_delaunay2d_context_points(ctx, points, num_points);
+
+	if( same )
+		check_tris(what, points, num_points, tdel->tris, tdel->num_triangles, 1);
+	else
+		check_cover(what, points, num_points, tdel->tris, tdel->num_triangles, scale);
+
+	delaunay2d_context_release(ctx);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	(void)argc;
+	(void)argv;
+
+	/* no 4 points are cocircular: both predicates give the same triangles */
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	check_predicates("random, long double", points, NUM_POINTS, DEL_PREDICATES_LONG_DOUBLE, 1, 0.0);
+	check_predicates("random, filtered", points, NUM_POINTS, DEL_PREDICATES_FILTERED, 1, 0.0);
+
+	/* nearly cocircular, the incircle signs are down to the last bits */
+	for( i = 0; i < CIRCLE_POINTS; i++ ) {
+		points[i].x	= 100.0 * cos(2.0 * M_PI * i / CIRCLE_POINTS);
+		points[i].y	= 100.0 * sin(2.0 * M_PI * i / CIRCLE_POINTS);
+	}
+	points[CIRCLE_POINTS].x	= 0.0;
+	points[CIRCLE_POINTS].y	= 0.0;
+
+	check_predicates("circle, filtered", points, CIRCLE_POINTS + 1, DEL_PREDICATES_FILTERED, 0, 0.0);
+
+	/* nearly collinear: a grid of the smallest steps around (0.5, 0.5), and
+	   two points on its diagonal far away */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= 0.5 + (i % GRID_SIZE) * ldexp(1.0, -53);
+		points[i].y	= 0.5 + (i / GRID_SIZE) * ldexp(1.0, -53);
+	}
+	points[i].x	= points[i].y	= 12.0;
+	points[i + 1].x	= points[i + 1].y	= 24.0;
+
+	check_predicates("near collinear, filtered", points, GRID_SIZE * GRID_SIZE + 2, DEL_PREDICATES_FILTERED, 0, ldexp(1.0, 53));
+
+	free(points);
+
+	return check_done("predicates");
+}
@@ -0,0 +1,165 @@
+/*
+**  sort.c : check the point sort and its duplicates against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+/* past DEL_PARALLEL_CUTOFF, drawn from fewer distinct points */
+#define NUM_POINTS	60000
+#define POOL_SIZE	20000
+
+static const del_point2d_t	*sort_points;
+
+/*
+* input indices by coordinate, then by index
+*/
+static int sort_cmp( const void *a, const void *b )
+{
+	unsigned int		ia	= *(const unsigned int*)a;
+	unsigned int		ib	= *(const unsigned int*)b;
+	const del_point2d_t	*pa	= &sort_points[ia];
+	const del_point2d_t	*pb	= &sort_points[ib];
+
+	if( pa->x != pb->x )
+		return pa->x < pb->x ? -1 : 1;
+	if( pa->y != pb->y )
+		return pa->y < pb->y ? -1 : 1;
+
+	return ia < ib ? -1 : (ia > ib);
+}
+
+/*
+* the representative of each point by brute force: the lowest input index at
+* its coordinate
+*/
+static unsigned int* sort_representatives( const del_point2d_t *points, unsigned int num_points )
+{
+	unsigned int	*order	= (unsigned int*)malloc(num_points * sizeof(unsigned int));
+	unsigned int	*reps	= (unsigned int*)malloc(num_points * sizeof(unsigned int));
+	unsigned int	i, first;
+
+	for( i = 0; i < num_points; i++ )
+		order[i]	= i;
+
+	sort_points	= points;
+	qsort(order, num_points, sizeof(unsigned int), sort_cmp);
+
+	for( i = 0, first = 0; i < num_points; i++ ) {
+		if( points[order[i]].x != points[order[first]].x || points[order[i]].y != points[order[first]].y )
+			first	= i;
+		reps[order[i]]	= order[first];
+	}
+
+	free(order);
+
+	return reps;
+}
+
+/*
+* build the points with a context on a number of threads, into its buffers
+* and into a caller one: the duplicates, representatives and triangles
+*/
+static void check_sort( const del_point2d_t *points, const unsigned int *reps, unsigned int num_dups, const unsigned int *fresh, unsigned int num_fresh, unsigned int num_threads )
+{
+	delaunay2d_context_t	*ctx	= delaunay2d_context_create();
+	delaunay2d_t		*del;
+	delaunay2d_t		caller;
+	const unsigned int	*creps;
+	unsigned int		num_tris, cdups;
+	unsigned int		*tris;
+
+	delaunay2d_context_set_num_threads(ctx, num_threads);
+
+	del	= delaunay2d_context_from(ctx, (del_point2d_t*)points, NUM_POINTS);
+	tris	= check_face_tris(del, &num_tris);
+
+	CHECK( del->num_duplicates == num_dups, "%u threads: %u duplicates, %u expected", num_threads, del->num_duplicates, num_dups );
+	CHECK( del->representatives != NULL && memcmp(del->representatives, reps, NUM_POINTS * sizeof(unsigned int)) == 0, "%u threads: wrong representatives", num_threads );
+	check_same("context", tris, num_tris, fresh, num_fresh);
+	free(tris);
+
+	memset(&caller, 0, sizeof(delaunay2d_t));
+	caller.points	= (del_point2d_t*)points;
+	caller.faces	= (unsigned int*)malloc(delaunay2d_faces_size(NUM_POINTS) * sizeof(unsigned int));
+	delaunay2d_context_faces(ctx, points, NUM_POINTS, caller.faces, &caller.num_faces);
+	tris	= check_face_tris(&caller, &num_tris);
+	creps	= delaunay2d_context_representatives(ctx, &cdups);
+
+	CHECK( cdups == num_dups, "%u threads: %u duplicates in a caller buffer, %u expected", num_threads, cdups, num_dups );
+	CHECK( creps != NULL && memcmp(creps, reps, NUM_POINTS * sizeof(unsigned int)) == 0, "%u threads: wrong representatives in a caller buffer", num_threads );
+	check_same("caller buffer", tris, num_tris, fresh, num_fresh);
+	check_local_delaunay("caller buffer", points, tris, num_tris);
+
+	free(tris);
+	free(caller.faces);
+	delaunay2d_context_release(ctx);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t	*pool	= (del_point2d_t*)malloc(POOL_SIZE * sizeof(del_point2d_t));
+	del_point2d_t	*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	del_point2d_t	*unique	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	unsigned int	*map	= (unsigned int*)malloc(NUM_POINTS * sizeof(unsigned int));
+	unsigned int	*reps, *fresh;
+	unsigned int	i, num_unique, num_fresh;
+
+	(void)argc;
+	(void)argv;
+
+	/* both signs, so the keys of negative coordinates are ordered too */
+	for( i = 0; i < POOL_SIZE; i++ ) {
+		pool[i].x	= 1000.0 * check_random() - 500.0;
+		pool[i].y	= 1000.0 * check_random() - 500.0;
+	}
+
+	for( i = 0; i < NUM_POINTS; i++ )
+		points[i]	= pool[(unsigned int)(check_random() * POOL_SIZE)];
+
+	/* -0 is the coordinate of +0: the representatives by brute force compare
+	   them equal */
+	points[NUM_POINTS / 3].x	= 0.0;
+	points[NUM_POINTS / 3].y	= 0.0;
+	points[NUM_POINTS / 2].x	= -0.0;
+	points[NUM_POINTS / 2].y	= 0.0;
+
+	reps	= sort_representatives(points, NUM_POINTS);
+
+	/* the fresh build has the unique points alone */
+	for( i = 0, num_unique = 0; i < NUM_POINTS; i++ ) {
+		if( reps[i] != i )
+			continue;
+		unique[num_unique]	= points[i];
+		map[num_unique]		= i;
+		num_unique++;
+	}
+
+	fresh	= check_fresh(unique, num_unique, map, points, &num_fresh);
+
+	check_sort(points, reps, NUM_POINTS - num_unique, fresh, num_fresh, 1);
+	check_sort(points, reps, NUM_POINTS - num_unique, fresh, num_fresh, 4);
+
+	free(fresh);
+	free(reps);
+	free(map);
+	free(unique);
+	free(points);
+	free(pool);
+
+	return check_done("sort");
+}
@@ -0,0 +1,200 @@
+/*
+**  stream.c : check the triangles of a point stream against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	6000
+#define GRID_SIZE	60
+#define READ_SIZE	777
+
+/*
+* the stream of a point array, and the triangles written out of it
+*/
+typedef struct
+{
+	const del_point2d_t*	points;
+	unsigned int		num_points;
+	unsigned int		offset;
+
+	unsigned int*		tris;
+	unsigned int		num_tris;
+	unsigned int		max_tris;
+	unsigned int		num_writes;
+} stream_t;
+
+static unsigned int stream_read( void *user, del_point2d_t *points, unsigned int max_points )
+{
+	stream_t	*s	= (stream_t*)user;
+	unsigned int	n	= s->num_points - s->offset;
+
+	/* short reads, that don't line up with the chunks */
+	if( n > READ_SIZE )
+		n	= READ_SIZE;
+	if( n > max_points )
+		n	= max_points;
+
+	memcpy(points, s->points + s->offset, n * sizeof(del_point2d_t));
+	s->offset	+= n;
+
+	return n;
+}
+
+static void stream_write( void *user, const unsigned int *tris, unsigned int num_triangles )
+{
+	stream_t	*s	= (stream_t*)user;
+
+	if( s->num_tris + num_triangles > s->max_tris ) {
+		while( s->num_tris + num_triangles > s->max_tris )
+			s->max_tris	= 2 * s->max_tris + 1;
+		s->tris	= (unsigned int*)realloc(s->tris, 3 * s->max_tris * sizeof(unsigned int));
+	}
+
+	memcpy(s->tris + 3 * s->num_tris, tris, 3 * num_triangles * sizeof(unsigned int));
+	s->num_tris	+= num_triangles;
+	s->num_writes++;
+}
+
+static int point_cmp( const void *a, const void *b )
+{
+	const del_point2d_t	*pa	= (const del_point2d_t*)a;
+	const del_point2d_t	*pb	= (const del_point2d_t*)b;
+
+	if( pa->x != pb->x )
+		return pa->x < pb->x ? -1 : 1;
+	if( pa->y != pb->y )
+		return pa->y < pb->y ? -1 : 1;
+	return 0;
+}
+
+/*
+* stream points (in x order) with a small budget, so they go through many
+* chunks, and compare with a fresh build
+*/
+static void check_stream( const char *what, const del_point2d_t *points, unsigned int num_points, int same )
+{
+	stream_t	s;
+	unsigned int	num_read, num_tris, num_fresh;
+	unsigned int	*fresh;
+
+	memset(&s, 0, sizeof(s));
+	s.points	= points;
+	s.num_points	= num_points;
+
+	num_read	= tri_delaunay2d_stream(stream_read, stream_write, &s, 0);
+	CHECK( num_read == num_points, "%s: %u points read out of %u", what, num_read, num_points );
+	CHECK( s.num_writes > 1, "%s: the triangles came in %u writes, not in chunks", what, s.num_writes );
+
+	num_tris	= check_canon(points, s.tris, s.num_tris);
+	fresh		= check_fresh(points, num_points, NULL, NULL, &num_fresh);
+
+	if( same )
+		check_same(what, s.tris, num_tris, fresh, num_fresh);
+	else	/* cocircular points: any of their triangulations will do */
+		CHECK( num_tris == num_fresh, "%s: %u triangles, %u in a fresh build", what, num_tris, num_fresh );
+
+	check_empty_circles(what, points, NULL, num_points, s.tris, num_tris);
+
+	free(fresh);
+	free(s.tris);
+}
+
+static void test_random(void)
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	qsort(points, NUM_POINTS, sizeof(del_point2d_t), point_cmp);
+	check_stream("random stream", points, NUM_POINTS, 1);
+
+	free(points);
+}
+
+static void test_grid(void)
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(GRID_SIZE * GRID_SIZE * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	/* column by column, the x order */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= (real)(i / GRID_SIZE);
+		points[i].y	= (real)(i % GRID_SIZE);
+	}
+
+	check_stream("grid stream", points, GRID_SIZE * GRID_SIZE, 0);
+
+	free(points);
+}
+
+static void stream_drop( void *user, const unsigned int *tris, unsigned int num_triangles )
+{
+	(void)user;
+	(void)tris;
+	(void)num_triangles;
+}
+
+/*
+* a point left of the points of a previous read stops the stream
+*/
+static void test_order(void)
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	stream_t	s;
+	unsigned int	i;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	qsort(points, NUM_POINTS, sizeof(del_point2d_t), point_cmp);
+
+	/* out of order inside a read is fine */
+	points[1]	= points[READ_SIZE - 1];
+	memset(&s, 0, sizeof(s));
+	s.points	= points;
+	s.num_points	= NUM_POINTS;
+	CHECK( tri_delaunay2d_stream(stream_read, stream_drop, &s, 0) == NUM_POINTS, "order inside a read: the stream failed" );
+
+	/* not across reads */
+	points[4 * READ_SIZE].x	= points[READ_SIZE - 2].x - 1.0;
+	memset(&s, 0, sizeof(s));
+	s.points	= points;
+	s.num_points	= NUM_POINTS;
+	CHECK( tri_delaunay2d_stream(stream_read, stream_drop, &s, 0) == (unsigned int)-1, "order across reads: the stream didn't fail" );
+	CHECK( s.offset < NUM_POINTS, "order across reads: the stream went on" );
+
+	free(points);
+}
+
+int main(int argc, char* argv[])
+{
+	(void)argc;
+	(void)argv;
+
+	test_random();
+	test_grid();
+	test_order();
+
+	return check_done("stream");
+}
@@ -0,0 +1,105 @@
+/*
+**  tris.c : check the direct triangle builds against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	3000
+/* past DEL_PARALLEL_CUTOFF */
+#define LARGE_POINTS	40000
+#define GRID_SIZE	30
+
+/*
+* build the triangles straight from the halfedges, allocated, with a context
+* and into a caller buffer on some threads: the same triangles, in the same
+* order, as tri_delaunay2d_from() of a fresh build
+*/
+static void check_direct( const char *what, const del_point2d_t *points, unsigned int num_points, unsigned int num_threads )
+{
+	delaunay2d_context_t	*ctx	= delaunay2d_context_create();
+	unsigned int		*tris	= (unsigned int*)malloc((3 * tri_delaunay2d_max_triangles(num_points) + 1) * sizeof(unsigned int));
+	delaunay2d_t		*del	= delaunay2d_from((del_point2d_t*)points, num_points);
+	tri_delaunay2d_t	*fresh	= tri_delaunay2d_from(del);
+	tri_delaunay2d_t	*tdel;
+	size_t			size	= 3 * fresh->num_triangles * sizeof(unsigned int);
+	unsigned int		num_tris;
+
+	tdel	= tri_delaunay2d_points_from(points, num_points);
+	CHECK( tdel->num_points == num_points && memcmp(tdel->points, points, num_points * sizeof(del_point2d_t)) == 0, "%s: the points differ", what );
+	CHECK( tdel->num_triangles == fresh->num_triangles && memcmp(tdel->tris, fresh->tris, size) == 0, "%s: %u triangles, %u in a fresh build, or they differ", what, tdel->num_triangles, fresh->num_triangles );
+	tri_delaunay2d_release(tdel);
+
+	delaunay2d_context_set_num_threads(ctx, num_threads);
+
+	tdel	= tri_delaunay2d_context_points(ctx, points, num_points);
+	CHECK( tdel->num_triangles == fresh->num_triangles && memcmp(tdel->tris, fresh->tris, size) == 0, "%s, %u threads: %u context triangles, %u in a fresh build, or they differ", what, num_threads, tdel->num_triangles, fresh->num_triangles );
+
+	num_tris	= tri_delaunay2d_context_tris(ctx, points, num_points, tris);
+	CHECK( num_tris == fresh->num_triangles && memcmp(tris, fresh->tris, size) == 0, "%s, %u threads: %u caller buffer triangles, %u in a fresh build, or they differ", what, num_threads, num_tris, fresh->num_triangles );
+	CHECK( num_tris <= tri_delaunay2d_max_triangles(num_points), "%s: %u triangles, past the %u of tri_delaunay2d_max_triangles", what, num_tris, tri_delaunay2d_max_triangles(num_points) );
+
+	tri_delaunay2d_release(fresh);
+	delaunay2d_release(del);
+	delaunay2d_context_release(ctx);
+	free(tris);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t	*points	= (del_point2d_t*)malloc(LARGE_POINTS * sizeof(del_point2d_t));
+	unsigned int	i;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < LARGE_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	check_direct("random", points, NUM_POINTS, 1);
+	check_direct("large", points, LARGE_POINTS, 4);
+
+	/* the triangle count of Euler's formula is for the points without
+	   their duplicates */
+	for( i = 0; i < NUM_POINTS / 10; i++ )
+		points[(unsigned int)(check_random() * NUM_POINTS)]	= points[i];
+
+	check_direct("duplicates", points, NUM_POINTS, 1);
+
+	/* the cocircular faces are fanned */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= (real)(i % GRID_SIZE);
+		points[i].y	= (real)(i / GRID_SIZE);
+	}
+
+	check_direct("grid", points, GRID_SIZE * GRID_SIZE, 1);
+
+	/* aligned points: the external face is fanned into flat triangles */
+	for( i = 0; i < 100; i++ ) {
+		points[i].x	= 3.0 * i;
+		points[i].y	= 2.0 * i + 1.0;
+	}
+
+	check_direct("aligned", points, 100, 1);
+	check_direct("3 aligned", points, 3, 1);
+
+	free(points);
+
+	return check_done("tris");
+}
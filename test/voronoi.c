@@ -0,0 +1,165 @@
+/*
+**  voronoi.c : check the Voronoi diagrams against fresh builds.
+**  Copyright (C) 2005  Wael El Oraiby <wael.eloraiby@gmail.com>
+**
+**
+**  This program is free software: you can redistribute it and/or modify
+**  it under the terms of the GNU Affero General Public License as
+**  published by the Free Software Foundation, either version 3 of the
+**  License, or (at your option) any later version.
+**
+**  This program is distributed in the hope that it will be useful,
+**  but WITHOUT ANY WARRANTY; without even the implied warranty of
+**  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**  GNU Affero General Public License for more details.
+**
+**  You should have received a copy of the GNU Affero General Public License
+**  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "check.h"
+
+#define NUM_POINTS	2000
+#define GRID_SIZE	20
+
+static long double voronoi_dist( const del_point2d_t *a, const del_point2d_t *b )
+{
+	return ((long double)a->x - b->x) * ((long double)a->x - b->x) + ((long double)a->y - b->y) * ((long double)a->y - b->y);
+}
+
+/*
+* the vertices are the circumcenters of the faces of a fresh build, the cell
+* vertices of a site are nearer to it than to any other site, the bounded cells
+* are counterclockwise, and the hull sites alone have rays
+*/
+static void check_voronoi( const char *what, const del_point2d_t *points, unsigned int num_points, const delaunay2d_voronoi_t *vor )
+{
+	delaunay2d_t		*del	= delaunay2d_from((del_point2d_t*)points, num_points);
+	unsigned char		*hull	= (unsigned char*)calloc(num_points, 1);
+	unsigned int		f, o, i, k, v, n;
+	unsigned int		far_centers = 0, far_vertices = 0, clockwise = 0, bad_rays = 0;
+	long double		r, d, area;
+	const del_point2d_t	*c, *a, *b, *ray;
+
+	CHECK( vor->num_sites == num_points, "%s: %u sites for %u points", what, vor->num_sites, num_points );
+	CHECK( vor->num_vertices == del->num_faces - 1, "%s: %u vertices for %u inner faces", what, vor->num_vertices, del->num_faces - 1 );
+
+	/* each vertex is as far from all the points of its face */
+	for( f = 0, o = 0; f < del->num_faces && vor->num_vertices == del->num_faces - 1; f++, o += del->faces[o] + 1 )
+	{
+		if( f == 0 ) {
+			for( i = 0; i < del->faces[0]; i++ )
+				hull[del->faces[1 + i]]	= 1;
+			continue;
+		}
+
+		c	= &vor->vertices[f - 1];
+		r	= voronoi_dist(c, &points[del->faces[o + 1]]);
+		for( i = 1; i < del->faces[o]; i++ )
+			if( fabsl(voronoi_dist(c, &points[del->faces[o + 1 + i]]) - r) > 1e-9L * r )
+				far_centers++;
+	}
+
+	for( i = 0; i < num_points; i++ )
+	{
+		n	= vor->offsets[i + 1] - vor->offsets[i];
+		area	= 0.0L;
+
+		for( k = 0; k < n; k++ )
+		{
+			a	= &vor->vertices[vor->cells[vor->offsets[i] + k]];
+			b	= &vor->vertices[vor->cells[vor->offsets[i] + (k + 1) % n]];
+			area	+= (long double)a->x * b->y - (long double)b->x * a->y;
+
+			/* no site is nearer to the vertex */
+			d	= voronoi_dist(a, &points[i]);
+			for( v = 0; v < num_points; v++ )
+				if( voronoi_dist(a, &points[v]) < d - 1e-9L * d ) {
+					far_vertices++;
+					break;
+				}
+		}
+
+		/* the unbounded cells are open, their vertices are a chain */
+		if( n > 2 && !hull[i] && area <= 0.0L )
+			clockwise++;
+
+		ray	= &vor->rays[2 * i];
+		if( hull[i] != (ray->x != 0.0 || ray->y != 0.0) || hull[i] != (ray[1].x != 0.0 || ray[1].y != 0.0) )
+			bad_rays++;
+	}
+
+	CHECK( far_centers == 0, "%s: %u vertices aren't the circumcenters of their faces", what, far_centers );
+	CHECK( far_vertices == 0, "%s: %u cell vertices nearer to another site", what, far_vertices );
+	CHECK( clockwise == 0, "%s: %u bounded cells aren't counterclockwise", what, clockwise );
+	CHECK( bad_rays == 0, "%s: %u sites with rays off the hull, or hull sites without", what, bad_rays );
+
+	free(hull);
+	delaunay2d_release(del);
+}
+
+/*
+* the diagram of a context is the allocated one
+*/
+static void check_context( const char *what, const del_point2d_t *points, unsigned int num_points, const delaunay2d_voronoi_t *vor )
+{
+	delaunay2d_context_t		*ctx	= delaunay2d_context_create();
+	const delaunay2d_voronoi_t	*cvor	= delaunay2d_context_voronoi(ctx, points, num_points);
+	unsigned int			n	= vor->offsets[num_points];
+
+	CHECK( cvor->num_vertices == vor->num_vertices && memcmp(cvor->vertices, vor->vertices, vor->num_vertices * sizeof(del_point2d_t)) == 0, "%s: the context vertices differ", what );
+	CHECK( memcmp(cvor->offsets, vor->offsets, (num_points + 1) * sizeof(unsigned int)) == 0 && memcmp(cvor->cells, vor->cells, n * sizeof(unsigned int)) == 0, "%s: the context cells differ", what );
+	CHECK( memcmp(cvor->rays, vor->rays, 2 * num_points * sizeof(del_point2d_t)) == 0, "%s: the context rays differ", what );
+
+	delaunay2d_context_release(ctx);
+}
+
+int main(int argc, char* argv[])
+{
+	del_point2d_t		*points	= (del_point2d_t*)malloc(NUM_POINTS * sizeof(del_point2d_t));
+	delaunay2d_voronoi_t	*vor;
+	unsigned int		i, j, empty, off;
+
+	(void)argc;
+	(void)argv;
+
+	for( i = 0; i < NUM_POINTS; i++ ) {
+		points[i].x	= 1000.0 * check_random();
+		points[i].y	= 1000.0 * check_random();
+	}
+
+	vor	= delaunay2d_voronoi_from(points, NUM_POINTS);
+	check_voronoi("random", points, NUM_POINTS, vor);
+	check_context("random", points, NUM_POINTS, vor);
+	delaunay2d_voronoi_release(vor);
+
+	/* the duplicates have empty cells */
+	for( i = 0; i < NUM_POINTS / 10; i++ )
+		points[NUM_POINTS - 1 - i]	= points[i];
+
+	vor	= delaunay2d_voronoi_from(points, NUM_POINTS);
+	check_voronoi("duplicates", points, NUM_POINTS, vor);
+	for( i = 0, empty = 0; i < NUM_POINTS / 10; i++ )
+		empty	+= vor->offsets[NUM_POINTS - i] == vor->offsets[NUM_POINTS - 1 - i];
+	CHECK( empty == NUM_POINTS / 10, "%u of the %u duplicates have empty cells", empty, NUM_POINTS / 10 );
+	delaunay2d_voronoi_release(vor);
+
+	/* the cells of a grid are squares around their site */
+	for( i = 0; i < GRID_SIZE * GRID_SIZE; i++ ) {
+		points[i].x	= (real)(i % GRID_SIZE);
+		points[i].y	= (real)(i / GRID_SIZE);
+	}
+
+	vor	= delaunay2d_voronoi_from(points, GRID_SIZE * GRID_SIZE);
+	check_voronoi("grid", points, GRID_SIZE * GRID_SIZE, vor);
+	for( i = 0, off = 0; i < GRID_SIZE * GRID_SIZE; i++ )
+		for( j = vor->offsets[i]; j < vor->offsets[i + 1]; j++ )
+			if( fabs(fabs(vor->vertices[vor->cells[j]].x - points[i].x) - 0.5) > 1e-12 || fabs(fabs(vor->vertices[vor->cells[j]].y - points[i].y) - 0.5) > 1e-12 )
+				off++;
+	CHECK( off == 0, "grid: %u cell vertices off the square corners", off );
+	delaunay2d_voronoi_release(vor);
+
+	free(points);
+
+	return check_done("voronoi");
+}